@@ -6,8 +6,12 @@
 //           https://www.boost.org/LICENSE_1_0.txt)
 
 #include <algorithm>
+#include <cstdint>
 #include <numeric>
+#include <optional>
 #include <ranges>
+#include <string_view>
+#include <utility>
 
 #include <boost/unordered/unordered_map.hpp>
 
@@ -21,8 +25,9 @@
 #include <dplx/dp/codecs/std-string.hpp>
 
 #include <dplx/dlog/argument_transmorpher_fmt.hpp>
+#include <dplx/dlog/bus/mpsc_bus.hpp>
 #include <dplx/dlog/core/file_database.hpp>
-#include <dplx/dlog/detail/file_stream.hpp>
+#include <dplx/dlog/detail/mapped_input_stream.hpp>
 #include <dplx/dlog/record_container.hpp>
 #include <dplx/dlog/tui/log_display_grid.hpp>
 #include <dplx/dlog/tui/theme.hpp>
@@ -199,8 +204,9 @@ private:
         DPLX_TRY(auto &&containerFile, mFileDb.open_record_container(meta));
         DPLX_TRY(auto const maxExtent, containerFile.maximum_extent());
 
+        // closed containers are decoded directly from the page cache
         DPLX_TRY(auto &&inStream,
-                 detail::os_input_stream::create(containerFile, maxExtent));
+                 detail::mapped_input_stream::create(containerFile, maxExtent));
 
         dp::parse_context ctx(inStream);
         dp::scoped_state attributeTypeRegistryScope(
@@ -218,6 +224,10 @@ private:
                          .register_type<dlog::detail::reified_status_code>());
         DPLX_TRY(argumentTransmorpher
                          .register_type<dlog::detail::reified_system_code>());
+        DPLX_TRY(argumentTransmorpher
+                         .register_type<dlog::detail::reified_blob>());
+        DPLX_TRY(argumentTransmorpher
+                         .register_type<dlog::detail::reified_typed_array>());
 
         dp::basic_decoder<record> decode_record{argumentTransmorpher};
         dp::basic_decoder<record_container> decode{decode_record};
@@ -286,6 +296,114 @@ public:
 
 } // namespace dplx::dlog::tui
 
+namespace dplx::dlog::cli
+{
+
+auto parse_threshold(std::string_view name) -> std::optional<std::uint8_t>
+{
+    using namespace std::string_view_literals;
+    if (name == "keep"sv)
+    {
+        return mpsc_bus_control::keep_threshold;
+    }
+    constexpr std::pair<std::string_view, severity> severities[] = {
+            { "none",  severity::none},
+            {"trace", severity::trace},
+            {"debug", severity::debug},
+            { "info",  severity::info},
+            { "warn",  severity::warn},
+            {"error", severity::error},
+            {"fatal", severity::fatal},
+    };
+    for (auto const &[severityName, value] : severities)
+    {
+        if (name == severityName)
+        {
+            return static_cast<std::uint8_t>(value);
+        }
+    }
+    return std::nullopt;
+}
+
+// deeplog verbosity [--force] <bus-file> <default|keep> [<scope>=<severity>...]
+auto set_verbosity(std::span<char *> args) -> int
+{
+    using namespace std::string_view_literals;
+    // --force takes over a control block left locked by a crashed writer
+    bool const force
+            = args.size() > 2U && std::string_view(args[2]) == "--force"sv;
+    if (force)
+    {
+        // keeps the positions of the remaining arguments
+        args = args.subspan(1U);
+    }
+    if (args.size() < 4U)
+    {
+        fmt::print(stderr, "usage: deeplog verbosity [--force] <bus-file> "
+                           "<default-threshold|keep> [<scope>=<threshold>...]\n");
+        return -3;
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
+    mpsc_bus_control next{};
+    auto const defaultThreshold = parse_threshold(args[3]);
+    if (!defaultThreshold)
+    {
+        fmt::print(stderr, "unknown threshold: {}\n", args[3]);
+        return -3;
+    }
+    next.default_threshold = *defaultThreshold;
+
+    auto const overrides = args.subspan(4U);
+    if (overrides.size() > mpsc_bus_control::max_overrides)
+    {
+        fmt::print(stderr, "at most {} scope overrides are supported\n",
+                   mpsc_bus_control::max_overrides);
+        return -3;
+    }
+    for (std::size_t i = 0U; i < overrides.size(); ++i)
+    {
+        std::string_view const arg(overrides[i]);
+        auto const separator = arg.rfind('=');
+        auto const scopeName = arg.substr(0U, separator);
+        auto const threshold = separator == std::string_view::npos
+                                       ? std::nullopt
+                                       : parse_threshold(
+                                               arg.substr(separator + 1U));
+        if (!threshold || *threshold == mpsc_bus_control::keep_threshold
+            || scopeName.size() > mpsc_bus_control::max_scope_name_size)
+        {
+            fmt::print(stderr, "invalid scope override: {}\n", arg);
+            return -3;
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        auto &entry = next.overrides[i];
+        entry.threshold = *threshold;
+        entry.scope_name_size = static_cast<std::uint8_t>(scopeName.size());
+        std::ranges::copy(scopeName, static_cast<char *>(entry.scope_name));
+    }
+    next.num_overrides = static_cast<std::uint8_t>(overrides.size());
+
+    auto busFile = llfio::mapped_file({}, llfio::path_view(args[2]),
+                                      llfio::file_handle::mode::write,
+                                      llfio::file_handle::creation::open_existing)
+                           .value();
+    if (auto updateRx = mpsc_bus_handle::update_control(busFile, next, force);
+        updateRx.has_error())
+    {
+        fmt::print(stderr, "failed to update the bus control block: {}\n",
+                   updateRx.assume_error().message().c_str());
+        if (updateRx.assume_error() == errc::dmpscb_control_busy)
+        {
+            fmt::print(stderr, "use --force if the previous writer crashed\n");
+        }
+        return -4;
+    }
+    return 0;
+}
+
+} // namespace dplx::dlog::cli
+
 auto main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) -> int
 try
 {
@@ -298,6 +416,10 @@ try
     {
         return -3;
     }
+    if (std::string_view(args[1]) == "verbosity")
+    {
+        return dlog::cli::set_verbosity(args);
+    }
 
     llfio::path_view dbPath(args[1]);
     auto db = dlog::file_database_handle::file_database({}, dbPath).value();
@@ -0,0 +1,61 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include <boost/variant2.hpp>
+
+#include <dplx/dlog/core/serialized_messages.hpp>
+#include <dplx/dlog/sinks/sink_frontend.hpp>
+
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+// counts the messages it consumes by kind
+class message_counting_sink final : public dlog::sink_frontend_base
+{
+public:
+    int numRecords{};
+    int numSpanStarts{};
+    int numSpanEnds{};
+    int numSpanCompletes{};
+
+    message_counting_sink() noexcept
+        : sink_frontend_base(dlog::severity::trace)
+    {
+    }
+
+private:
+    auto do_consume(
+            std::size_t,
+            std::span<dlog::serialized_message_info const> messages) noexcept
+            -> result<void> override
+    {
+        using boost::variant2::holds_alternative;
+        for (auto const &message : messages)
+        {
+            numRecords += holds_alternative<dlog::serialized_record_info>(
+                    message);
+            numSpanStarts
+                    += holds_alternative<dlog::serialized_span_start_info>(
+                            message);
+            numSpanEnds += holds_alternative<dlog::serialized_span_end_info>(
+                    message);
+            numSpanCompletes
+                    += holds_alternative<dlog::serialized_span_complete_info>(
+                            message);
+        }
+        return outcome::success();
+    }
+};
+
+} // namespace dlog_tests
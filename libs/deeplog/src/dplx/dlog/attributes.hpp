@@ -102,6 +102,11 @@ struct process_id
     static auto current() noexcept -> process_id;
 };
 
+// the block_codec of a compressed record container
+using container_codec = basic_attribute_ref<resource_id{257},
+                                            u8"dlog.container.codec",
+                                            unsigned>;
+
 } // namespace attr
   // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
 
@@ -0,0 +1,179 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/block_codec.hpp"
+
+#include <new>
+
+#if DPLX_DLOG_USE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace dplx::dlog
+{
+
+#if DPLX_DLOG_USE_ZSTD
+
+namespace
+{
+
+// logging is throughput sensitive, the fastest regular level already
+// achieves most of the achievable ratio on log records
+constexpr int zstd_compression_level = 1;
+
+struct zstd_dctx_deleter
+{
+    void operator()(ZSTD_DCtx *dctx) const noexcept
+    {
+        ZSTD_freeDCtx(dctx);
+    }
+};
+
+} // namespace
+
+struct block_compressor::state
+{
+    ZSTD_CCtx *cctx;
+
+    state(ZSTD_CCtx *context) noexcept
+        : cctx(context)
+    {
+    }
+    ~state() noexcept
+    {
+        ZSTD_freeCCtx(cctx);
+    }
+    state(state const &) = delete;
+    auto operator=(state const &) -> state & = delete;
+};
+
+auto is_supported(block_codec const codec) noexcept -> bool
+{
+    return codec == block_codec::none || codec == block_codec::zstd;
+}
+
+auto compress_bound(block_codec const codec,
+                    std::size_t const blockSize) noexcept -> std::size_t
+{
+    return codec == block_codec::zstd ? ZSTD_compressBound(blockSize)
+                                      : blockSize;
+}
+
+auto decompress_block(block_codec const codec,
+                      bytes const compressed,
+                      writable_bytes const out) noexcept -> result<std::size_t>
+{
+    if (codec != block_codec::zstd)
+    {
+        return system_error::errc::not_supported;
+    }
+    // the decompression context is reused by the following blocks
+    thread_local std::unique_ptr<ZSTD_DCtx, zstd_dctx_deleter> dctx;
+    if (!dctx)
+    {
+        dctx.reset(ZSTD_createDCtx());
+        if (!dctx)
+        {
+            return errc::not_enough_memory;
+        }
+    }
+    auto const decompressedSize
+            = ZSTD_decompressDCtx(dctx.get(), out.data(), out.size(),
+                                  compressed.data(), compressed.size());
+    if (ZSTD_isError(decompressedSize) != 0U)
+    {
+        return errc::invalid_record_block;
+    }
+    return decompressedSize;
+}
+
+auto block_compressor::create(block_codec const codec) noexcept
+        -> result<block_compressor>
+try
+{
+    if (codec != block_codec::zstd)
+    {
+        return system_error::errc::not_supported;
+    }
+    auto *const cctx = ZSTD_createCCtx();
+    if (cctx == nullptr)
+    {
+        return errc::not_enough_memory;
+    }
+    block_compressor self;
+    self.mState = std::make_unique<state>(cctx);
+    if (ZSTD_isError(ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel,
+                                            zstd_compression_level))
+                != 0U
+        || ZSTD_isError(ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1))
+                   != 0U)
+    {
+        return errc::bad;
+    }
+    return self;
+}
+catch (std::bad_alloc const &)
+{
+    return errc::not_enough_memory;
+}
+
+auto block_compressor::compress(bytes const block,
+                                writable_bytes const out) noexcept
+        -> result<std::size_t>
+{
+    auto const compressedSize = ZSTD_compress2(
+            mState->cctx, out.data(), out.size(), block.data(), block.size());
+    if (ZSTD_isError(compressedSize) != 0U)
+    {
+        return errc::bad;
+    }
+    return compressedSize;
+}
+
+#else
+
+struct block_compressor::state
+{
+};
+
+auto is_supported(block_codec const codec) noexcept -> bool
+{
+    return codec == block_codec::none;
+}
+
+auto compress_bound(block_codec, std::size_t const blockSize) noexcept
+        -> std::size_t
+{
+    return blockSize;
+}
+
+auto decompress_block(block_codec, bytes, writable_bytes) noexcept
+        -> result<std::size_t>
+{
+    return system_error::errc::not_supported;
+}
+
+auto block_compressor::create(block_codec) noexcept -> result<block_compressor>
+{
+    return system_error::errc::not_supported;
+}
+
+auto block_compressor::compress(bytes, writable_bytes) noexcept
+        -> result<std::size_t>
+{
+    return system_error::errc::not_supported;
+}
+
+#endif
+
+block_compressor::~block_compressor() noexcept = default;
+block_compressor::block_compressor() noexcept = default;
+block_compressor::block_compressor(block_compressor &&) noexcept = default;
+auto block_compressor::operator=(block_compressor &&) noexcept
+        -> block_compressor & = default;
+
+} // namespace dplx::dlog
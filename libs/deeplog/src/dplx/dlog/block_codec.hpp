@@ -0,0 +1,71 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <dplx/dlog/concepts.hpp>
+#include <dplx/dlog/config.hpp>
+#include <dplx/dlog/disappointment.hpp>
+
+namespace dplx::dlog
+{
+
+// the compression applied to the record blocks of a container
+enum class block_codec : std::uint8_t
+{
+    none = 0,
+    // requires a build with DPLX_DLOG_USE_ZSTD
+    zstd = 1,
+};
+
+// whether this build is able to (de)compress blocks with the given codec
+auto is_supported(block_codec codec) noexcept -> bool;
+
+// the maximum size of a compressed block with blockSize input bytes
+auto compress_bound(block_codec codec, std::size_t blockSize) noexcept
+        -> std::size_t;
+
+// decompresses a single block into out and returns the decompressed size,
+// fails with errc::invalid_record_block if the block is corrupted or doesn't
+// fit into out.
+auto decompress_block(block_codec codec,
+                      bytes compressed,
+                      writable_bytes out) noexcept -> result<std::size_t>;
+
+// Compresses independent blocks, i.e. each block can be decompressed without
+// the preceding ones. The codec state is reused across blocks.
+class block_compressor
+{
+    struct state;
+    std::unique_ptr<state> mState;
+
+public:
+    ~block_compressor() noexcept;
+    block_compressor() noexcept;
+
+    block_compressor(block_compressor &&) noexcept;
+    auto operator=(block_compressor &&) noexcept -> block_compressor &;
+
+    // fails with system_error::errc::not_supported if the codec isn't
+    // supported by this build
+    static auto create(block_codec codec) noexcept -> result<block_compressor>;
+
+    [[nodiscard]] auto is_valid() const noexcept -> bool
+    {
+        return static_cast<bool>(mState);
+    }
+
+    // out must provide at least compress_bound() bytes
+    auto compress(bytes block, writable_bytes out) noexcept
+            -> result<std::size_t>;
+};
+
+} // namespace dplx::dlog
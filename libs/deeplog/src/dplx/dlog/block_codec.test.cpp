@@ -0,0 +1,74 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/block_codec.hpp"
+
+#include <cstddef>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+TEST_CASE("block_compressor blocks can be decompressed independently")
+{
+    constexpr auto codec = dlog::block_codec::zstd;
+    if (!dlog::is_supported(codec))
+    {
+        CHECK(dlog::block_compressor::create(codec).has_error());
+        SKIP("deeplog has been built without zstd support");
+    }
+    auto createRx = dlog::block_compressor::create(codec);
+    REQUIRE(createRx);
+    auto &&compressor = std::move(createRx).assume_value();
+
+    std::vector<std::byte> first(4096U);
+    std::vector<std::byte> second(1000U);
+    for (std::size_t i = 0U; i < first.size(); ++i)
+    {
+        first[i] = static_cast<std::byte>(i % 7U);
+    }
+    for (std::size_t i = 0U; i < second.size(); ++i)
+    {
+        second[i] = static_cast<std::byte>(i % 13U);
+    }
+
+    std::vector<std::byte> firstCompressed(
+            dlog::compress_bound(codec, first.size()));
+    std::vector<std::byte> secondCompressed(
+            dlog::compress_bound(codec, second.size()));
+    auto firstRx = compressor.compress(first, firstCompressed);
+    REQUIRE(firstRx);
+    CHECK(firstRx.assume_value() < first.size());
+    firstCompressed.resize(firstRx.assume_value());
+    auto secondRx = compressor.compress(second, secondCompressed);
+    REQUIRE(secondRx);
+    secondCompressed.resize(secondRx.assume_value());
+
+    std::vector<std::byte> decompressed(first.size());
+    auto decompressRx
+            = dlog::decompress_block(codec, secondCompressed, decompressed);
+    REQUIRE(decompressRx);
+    decompressed.resize(decompressRx.assume_value());
+    CHECK(decompressed == second);
+
+    decompressed.resize(first.size());
+    decompressRx = dlog::decompress_block(codec, firstCompressed, decompressed);
+    REQUIRE(decompressRx);
+    CHECK(decompressed == first);
+
+    firstCompressed.back() ^= std::byte{0xff};
+    auto const corruptedRx
+            = dlog::decompress_block(codec, firstCompressed, decompressed);
+    REQUIRE(corruptedRx.has_error());
+    CHECK(corruptedRx.assume_error() == dlog::errc::invalid_record_block);
+}
+
+} // namespace dlog_tests
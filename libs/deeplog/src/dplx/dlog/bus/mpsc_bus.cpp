@@ -9,6 +9,9 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <cstring>
+#include <string>
 #include <thread>
 
 #include <dplx/cncr/utils.hpp>
@@ -181,6 +184,17 @@ auto mpsc_bus_handle::mpsc_bus(llfio::mapped_file_handle &&backingFile,
                                            .epoch = log_clock::epoch(),
                                    }));
 
+    // initialize the control block
+    ::new (static_cast<void *>(busMemory.subspan(control_offset).data()))
+            mpsc_bus_control{
+                    .sequence = 0U,
+                    .version = mpsc_bus_control::version_id,
+                    .default_threshold = mpsc_bus_control::keep_threshold,
+                    .num_overrides = 0U,
+                    .padding = {},
+                    .overrides = {},
+            };
+
     // initialize the regions
     busStream = dp::memory_output_stream(busMemory.subspan(head_area_size));
     while (!busStream.empty())
@@ -305,6 +319,133 @@ auto dplx::dlog::mpsc_bus_handle::create_span_context(trace_id trace,
                                           rawTraceId.values[1], ctr)};
 }
 
+auto mpsc_bus_handle::update_control(llfio::mapped_file_handle &backingFile,
+                                     mpsc_bus_control const &next,
+                                     bool const force) noexcept -> result<void>
+{
+    if (!backingFile.is_valid() || !backingFile.is_writable())
+    {
+        return errc::invalid_argument;
+    }
+    if (next.num_overrides > mpsc_bus_control::max_overrides)
+    {
+        return errc::invalid_argument;
+    }
+    for (std::uint32_t i = 0U; i < next.num_overrides; ++i)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        if (next.overrides[i].scope_name_size
+            > mpsc_bus_control::max_scope_name_size)
+        {
+            return errc::invalid_argument;
+        }
+    }
+
+    // also updates the memory mapping
+    DPLX_TRY(auto const maxExtent, backingFile.maximum_extent());
+    if (maxExtent < head_area_size)
+    {
+        return errc::missing_data;
+    }
+    std::span<std::byte> fileContent(backingFile.address(), head_area_size);
+    if (!std::ranges::equal(fileContent.first(std::size(magic)),
+                            as_bytes(std::span(magic))))
+    {
+        return errc::invalid_dmpscb_header;
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto *const ctrl = std::launder(reinterpret_cast<mpsc_bus_control *>(
+            fileContent.subspan(control_offset).data()));
+    detail::atomic_ref<std::uint32_t> const sequence(ctrl->sequence);
+
+    // acquire the seqlock, a stolen lock stays odd and is moved past the
+    // sequence number the dead writer would have published
+    auto current = sequence.load(detail::memory_order::relaxed);
+    std::uint32_t locked; // NOLINT(cppcoreguidelines-init-variables)
+    do
+    {
+        if ((current & 1U) != 0U && !force)
+        {
+            return errc::dmpscb_control_busy;
+        }
+        locked = current + ((current & 1U) != 0U ? 2U : 1U);
+    }
+    while (!sequence.compare_exchange_weak(current, locked,
+                                           detail::memory_order::acquire,
+                                           detail::memory_order::relaxed));
+    std::atomic_thread_fence(std::memory_order_release);
+
+    ctrl->version = mpsc_bus_control::version_id;
+    ctrl->default_threshold = next.default_threshold;
+    ctrl->num_overrides = next.num_overrides;
+    std::memcpy(&ctrl->overrides, &next.overrides, sizeof(next.overrides));
+
+    // the sequence number must never become zero again
+    auto const published = locked + 1U == 0U ? 2U : locked + 1U;
+    sequence.store(published, detail::memory_order::release);
+    return outcome::success();
+}
+
+auto mpsc_bus_handle::read_threshold_overrides(
+        detail::log_fabric_base::threshold_overrides &out) noexcept -> bool
+try
+{
+    auto *const ctrl = control();
+    detail::atomic_ref<std::uint32_t> const sequence(ctrl->sequence);
+
+    auto const begin = sequence.load(detail::memory_order::acquire);
+    if ((begin & 1U) != 0U)
+    {
+        // a write is in progress; we retry during the next poll
+        return false;
+    }
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
+    mpsc_bus_control snapshot;
+    std::memcpy(&snapshot, ctrl, sizeof(snapshot));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence.load(detail::memory_order::relaxed) != begin)
+    {
+        return false;
+    }
+    mControlSequence = begin;
+    if (snapshot.version != mpsc_bus_control::version_id)
+    {
+        return false;
+    }
+
+    constexpr auto max_threshold
+            = static_cast<std::uint8_t>(detail::disable_threshold);
+    detail::log_fabric_base::threshold_overrides overrides;
+    if (snapshot.default_threshold <= max_threshold)
+    {
+        overrides.default_threshold
+                = static_cast<severity>(snapshot.default_threshold);
+    }
+    auto const numOverrides = std::min<std::uint32_t>(
+            snapshot.num_overrides, mpsc_bus_control::max_overrides);
+    for (std::uint32_t i = 0U; i < numOverrides; ++i)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        auto const &entry = snapshot.overrides[i];
+        if (entry.threshold > max_threshold
+            || entry.scope_name_size > mpsc_bus_control::max_scope_name_size)
+        {
+            continue;
+        }
+        overrides.thresholds.insert_or_assign(
+                std::string(static_cast<char const *>(entry.scope_name),
+                            entry.scope_name_size),
+                static_cast<severity>(entry.threshold));
+    }
+    out = std::move(overrides);
+    return true;
+}
+catch (std::bad_alloc const &)
+{
+    return false;
+}
+
 auto mpsc_bus_handle::recover_region(record_consumer &consume,
                                      std::uint32_t regionId) noexcept
         -> result<void>
@@ -69,6 +69,7 @@ namespace dplx::dlog
 // 4KiB metadata area
 //   * magic
 //   * mpsc_bus_info
+//   * mpsc_bus_control (at offset 2KiB)
 
 struct mpsc_bus_info_v00 // NOLINT(cppcoreguidelines-pro-type-member-init)
 {
@@ -78,6 +79,35 @@ struct mpsc_bus_info_v00 // NOLINT(cppcoreguidelines-pro-type-member-init)
 };
 using mpsc_bus_info = mpsc_bus_info_v00;
 
+// The control block allows other processes to adjust the verbosity of a
+// running process by editing the mapped bus file. It is protected by a
+// seqlock: an odd sequence number denotes a write in progress and a sequence
+// number of zero denotes that the block has never been written.
+struct mpsc_bus_control_v01 // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+    static constexpr std::uint32_t version_id = 1U;
+    static constexpr std::uint32_t max_overrides = 15U;
+    static constexpr std::uint32_t max_scope_name_size = 126U;
+    // the default threshold value which retains the configured threshold
+    static constexpr std::uint8_t keep_threshold = 0xffU;
+
+    struct scope_override
+    {
+        std::uint8_t threshold;
+        std::uint8_t scope_name_size;
+        char scope_name[max_scope_name_size];
+    };
+
+    alignas(detail::atomic_ref<std::uint32_t>::required_alignment)
+            std::uint32_t sequence;
+    std::uint32_t version;
+    std::uint8_t default_threshold;
+    std::uint8_t num_overrides;
+    std::uint8_t padding[6]; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+    scope_override overrides[max_overrides];
+};
+using mpsc_bus_control = mpsc_bus_control_v01;
+
 struct mpsc_bus_region_ctrl
 {
     alignas(detail::atomic_ref<std::uint32_t>::required_alignment)
@@ -95,6 +125,7 @@ class mpsc_bus_handle
     llfio::mapped_file_handle mBackingFile;
     std::uint32_t mNumRegions;
     std::uint32_t mRegionSize;
+    std::uint32_t mControlSequence;
 
 public:
     ~mpsc_bus_handle()
@@ -109,12 +140,14 @@ public:
         : mBackingFile()
         , mNumRegions(0U)
         , mRegionSize(0U)
+        , mControlSequence(0U)
     {
     }
     mpsc_bus_handle(mpsc_bus_handle &&other) noexcept
         : mBackingFile(std::move(other.mBackingFile))
         , mNumRegions(std::exchange(other.mNumRegions, 0U))
         , mRegionSize(std::exchange(other.mRegionSize, 0U))
+        , mControlSequence(std::exchange(other.mControlSequence, 0U))
     {
     }
     auto operator=(mpsc_bus_handle &&other) noexcept -> mpsc_bus_handle &
@@ -122,6 +155,7 @@ public:
         mBackingFile = std::move(other.mBackingFile);
         mNumRegions = std::exchange(other.mNumRegions, 0U);
         mRegionSize = std::exchange(other.mRegionSize, 0U);
+        mControlSequence = std::exchange(other.mControlSequence, 0U);
         return *this;
     }
 
@@ -132,6 +166,7 @@ private:
         : mBackingFile(std::move(backingFile))
         , mNumRegions(numRegions)
         , mRegionSize(regionSize)
+        , mControlSequence(0U)
     {
     }
 
@@ -154,6 +189,17 @@ public:
                                  = llfio::lock_kind::unlocked) noexcept
             -> result<void>;
 
+    // overwrites the control block of the bus backing the given file, i.e.
+    // the file is usually owned by another process. The sequence number of
+    // `next` is ignored.
+    // A writer which died while holding the seqlock leaves the control block
+    // busy forever, `force` takes the lock over instead of failing with
+    // errc::dmpscb_control_busy. It must only be used if no other writer is
+    // alive.
+    static auto update_control(llfio::mapped_file_handle &backingFile,
+                               mpsc_bus_control const &next,
+                               bool force = false) noexcept -> result<void>;
+
     static inline constexpr llfio::file_handle::mode file_mode
             = llfio::file_handle::mode::write;
     static inline constexpr llfio::file_handle::caching file_caching
@@ -165,6 +211,7 @@ public:
     {
         mNumRegions = 0U;
         mRegionSize = 0U;
+        mControlSequence = 0U;
         return std::move(mBackingFile);
     }
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
@@ -186,6 +233,8 @@ private:
     using region_ctrl = mpsc_bus_region_ctrl;
 
     static constexpr std::uint32_t head_area_size = 4 * 1024U;
+    static constexpr std::uint32_t control_offset = 2 * 1024U;
+    static_assert(control_offset + sizeof(mpsc_bus_control) <= head_area_size);
     static constexpr std::uint32_t region_ctrl_overhead
             = static_cast<std::uint32_t>(sizeof(region_ctrl));
 
@@ -210,6 +259,21 @@ public:
                              std::string_view,
                              severity &) noexcept -> span_context;
 
+    // checks whether the control block has been changed since the last poll;
+    // a single relaxed load in the common case.
+    auto poll_threshold_overrides(
+            detail::log_fabric_base::threshold_overrides &out) noexcept
+            -> bool
+    {
+        detail::atomic_ref<std::uint32_t> const sequence(control()->sequence);
+        if (sequence.load(detail::memory_order::relaxed) == mControlSequence)
+                [[likely]]
+        {
+            return false;
+        }
+        return read_threshold_overrides(out);
+    }
+
     class output_buffer final : public record_output_buffer
     {
         friend class mpsc_bus_handle;
@@ -344,6 +408,9 @@ private:
 
     auto recover_region(record_consumer &consume,
                         std::uint32_t regionId) noexcept -> result<void>;
+    auto read_threshold_overrides(
+            detail::log_fabric_base::threshold_overrides &out) noexcept
+            -> bool;
 
 public:
     auto allocate_record_buffer_inplace(
@@ -450,6 +517,12 @@ private:
     }
 
     // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    auto control() noexcept -> mpsc_bus_control *
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return std::launder(reinterpret_cast<mpsc_bus_control *>(
+                mBackingFile.address() + control_offset));
+    }
     auto region(std::uint32_t which) noexcept -> region_ctrl *
     {
         // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
@@ -580,6 +653,7 @@ public:
     using mpsc_bus_handle::consume_batch_size;
     using mpsc_bus_handle::max_message_size;
     using mpsc_bus_handle::min_region_size;
+    using mpsc_bus_handle::output_buffer;
 
 #if __INTELLISENSE__ || __EDG__
     // EDG fails to take using-declarations into account while checking concepts
@@ -607,10 +681,18 @@ public:
                                                     newThreshold);
     }
 
+    auto poll_threshold_overrides(
+            detail::log_fabric_base::threshold_overrides &out) noexcept
+            -> bool
+    {
+        return mpsc_bus_handle::poll_threshold_overrides(out);
+    }
+
 #else  // ^^^ workaround __INTELLISENSE__ / no workaround vvv
     using mpsc_bus_handle::allocate_record_buffer_inplace;
     using mpsc_bus_handle::consume_messages;
     using mpsc_bus_handle::create_span_context;
+    using mpsc_bus_handle::poll_threshold_overrides;
 
 #endif // ^^^ no workaround ^^^
 
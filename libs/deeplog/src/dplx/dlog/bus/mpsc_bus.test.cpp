@@ -7,6 +7,10 @@
 
 #include "dplx/dlog/bus/mpsc_bus.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -22,6 +26,8 @@
 #include <dplx/dp/streams/memory_input_stream.hpp>
 
 #include <dplx/dlog/concepts.hpp>
+#include <dplx/dlog/log_fabric.hpp>
+#include <dplx/dlog/source/log_context.hpp>
 
 #include "test_dir.hpp"
 #include "test_utils.hpp"
@@ -249,6 +255,64 @@ TEST_CASE("mpsc bus can be recovered")
                     "All message ids should have been popped.")));
 }
 
+TEST_CASE("mpsc bus applies threshold overrides from its control block")
+{
+    using namespace std::string_view_literals;
+    auto backingFile = llfio::mapped_temp_inode().value();
+    auto controlFile = backingFile.reopen(0U).value();
+
+    dlog::log_fabric core{
+            dlog::mpsc_bus(std::move(backingFile), 1U,
+                           dlog::mpsc_bus_handle::min_region_size)
+                    .value(),
+            dlog::severity::warn};
+    dlog::log_context ctx{core, "dlog.tests"};
+    REQUIRE(ctx.threshold() == dlog::severity::warn);
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
+    dlog::mpsc_bus_control next{};
+    next.default_threshold = dlog::mpsc_bus_control::keep_threshold;
+    next.num_overrides = 1U;
+    auto const scopePattern = "dlog.*"sv;
+    next.overrides[0].threshold
+            = static_cast<std::uint8_t>(dlog::severity::debug);
+    next.overrides[0].scope_name_size
+            = static_cast<std::uint8_t>(scopePattern.size());
+    std::ranges::copy(scopePattern, next.overrides[0].scope_name);
+
+    REQUIRE(dlog::mpsc_bus_handle::update_control(controlFile, next));
+    REQUIRE(core.retire_log_records());
+    CHECK(ctx.threshold() == dlog::severity::debug);
+
+    next.num_overrides = 0U;
+    REQUIRE(dlog::mpsc_bus_handle::update_control(controlFile, next));
+    REQUIRE(core.retire_log_records());
+    CHECK(ctx.threshold() == dlog::severity::warn);
+
+    SECTION("the lock of a crashed writer can be taken over")
+    {
+        // the control block is located at offset 2KiB
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+        auto *const sequence = controlFile.address() + 2 * 1024U;
+        std::uint32_t lockedSequence{};
+        std::memcpy(&lockedSequence, sequence, sizeof(lockedSequence));
+        lockedSequence |= 1U;
+        std::memcpy(sequence, &lockedSequence, sizeof(lockedSequence));
+
+        next.num_overrides = 1U;
+        auto const updateRx
+                = dlog::mpsc_bus_handle::update_control(controlFile, next);
+        REQUIRE(updateRx.has_error());
+        CHECK(updateRx.assume_error() == dlog::errc::dmpscb_control_busy);
+        REQUIRE(core.retire_log_records());
+        CHECK(ctx.threshold() == dlog::severity::warn);
+
+        REQUIRE(dlog::mpsc_bus_handle::update_control(controlFile, next, true));
+        REQUIRE(core.retire_log_records());
+        CHECK(ctx.threshold() == dlog::severity::debug);
+    }
+}
+
 } // namespace dlog_tests
 
 // NOLINTEND(readability-function-cognitive-complexity)
@@ -67,6 +67,18 @@ concept raw_message_consumer
 template <typename T>
 concept sink_backend = makable<T> && std::derived_from<T, dp::output_buffer>;
 
+// a sink backend which can write a list of messages straight from the bus
+// memory, i.e. without copying them into its buffer first.
+// clang-format off
+template <typename T>
+concept gather_sink_backend
+    = sink_backend<T>
+    && requires(T instance, std::span<bytes const> const pieces)
+        {
+            { instance.write_gathered(pieces) } -> cncr::tryable;
+        };
+// clang-format on
+
 template <typename T>
 concept sink = makable<T> && std::derived_from<T, sink_frontend_base>;
 
@@ -19,6 +19,18 @@
 #define DPLX_DLOG_FLAG_OUTDATED_WORKAROUNDS 0
 #endif
 
+// log() encodes its arguments with statically typed encoders by default.
+// Enabling this routes all calls through the type erased vlog() instead which
+// trades some runtime overhead for less generated code per call site.
+#if !defined(DPLX_DLOG_USE_TYPE_ERASED_LOG)
+#define DPLX_DLOG_USE_TYPE_ERASED_LOG 0
+#endif
+
+// enables the zstd block_codec for compressed record containers
+#if !defined(DPLX_DLOG_USE_ZSTD)
+#define DPLX_DLOG_USE_ZSTD 0
+#endif
+
 #if !defined(DPLX_DLOG_USE_BOOST_ATOMIC_REF)
 #include <version>
 #if __cpp_lib_atomic_ref >= 201'806L
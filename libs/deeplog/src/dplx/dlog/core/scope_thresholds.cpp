@@ -0,0 +1,155 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/core/scope_thresholds.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <map>
+#include <optional>
+#include <utility>
+
+namespace dplx::dlog
+{
+
+namespace
+{
+
+struct rule_trie_node
+{
+    std::map<std::string_view, rule_trie_node, std::less<>> children;
+    std::optional<severity> self;
+    std::optional<severity> descendants;
+};
+
+auto build_rule_trie(std::span<scope_threshold_rule const> rules)
+        -> rule_trie_node
+{
+    using namespace std::string_view_literals;
+
+    rule_trie_node root;
+    for (auto const &rule : rules)
+    {
+        auto *current = &root;
+        std::string_view remaining = rule.scope;
+        for (;;)
+        {
+            auto const dot = remaining.find('.');
+            auto const segment = remaining.substr(0U, dot);
+            if (dot == std::string_view::npos)
+            {
+                if (segment == "*"sv)
+                {
+                    current->descendants = rule.threshold;
+                }
+                else
+                {
+                    current = &current->children[segment];
+                    current->self = rule.threshold;
+                }
+                break;
+            }
+            current = &current->children[segment];
+            remaining.remove_prefix(dot + 1U);
+        }
+    }
+    return root;
+}
+
+} // namespace
+
+scope_threshold_table::scope_threshold_table(
+        severity const defaultThreshold,
+        std::span<scope_threshold_rule const> const rules)
+    : mNodes()
+    , mSegments()
+{
+    auto const root = build_rule_trie(rules);
+
+    // flatten the trie in breadth first order which places the children of a
+    // node next to each other, sorted by their segment.
+    mNodes.push_back({
+            .segmentOffset = 0U,
+            .segmentSize = 0U,
+            .firstChild = 0U,
+            .numChildren = 0U,
+            .self = defaultThreshold,
+            .descendants = root.descendants.value_or(defaultThreshold),
+    });
+    std::deque<std::pair<rule_trie_node const *, std::uint32_t>> pending;
+    pending.emplace_back(&root, 0U);
+    while (!pending.empty())
+    {
+        auto const [trieNode, index] = pending.front();
+        pending.pop_front();
+
+        auto const inherited = mNodes[index].descendants;
+        mNodes[index].firstChild = static_cast<std::uint32_t>(mNodes.size());
+        mNodes[index].numChildren
+                = static_cast<std::uint32_t>(trieNode->children.size());
+        for (auto const &[segment, child] : trieNode->children)
+        {
+            auto const self = child.self.value_or(inherited);
+            pending.emplace_back(&child,
+                                 static_cast<std::uint32_t>(mNodes.size()));
+            mNodes.push_back({
+                    .segmentOffset
+                    = static_cast<std::uint32_t>(mSegments.size()),
+                    .segmentSize = static_cast<std::uint32_t>(segment.size()),
+                    .firstChild = 0U,
+                    .numChildren = 0U,
+                    .self = self,
+                    .descendants = child.descendants.value_or(inherited),
+            });
+            mSegments.append(segment);
+        }
+    }
+}
+
+auto scope_threshold_table::resolve(std::string_view scopeName) const noexcept
+        -> severity
+{
+    node const *current = &mNodes.front();
+    for (;;)
+    {
+        auto const dot = scopeName.find('.');
+        node const *const child
+                = find_child(*current, scopeName.substr(0U, dot));
+        if (child == nullptr)
+        {
+            return current->descendants;
+        }
+        if (dot == std::string_view::npos)
+        {
+            return child->self;
+        }
+        current = child;
+        scopeName.remove_prefix(dot + 1U);
+    }
+}
+
+auto scope_threshold_table::find_child(node const &parent,
+                                       std::string_view segment) const noexcept
+        -> node const *
+{
+    auto const children = std::span<node const>(mNodes).subspan(
+            parent.firstChild, parent.numChildren);
+    auto const segmentOf = [this](node const &n) {
+        return std::string_view(mSegments).substr(n.segmentOffset,
+                                                  n.segmentSize);
+    };
+    auto const it = std::ranges::lower_bound(children, segment, std::less<>{},
+                                             segmentOf);
+    if (it == children.end() || segmentOf(*it) != segment)
+    {
+        return nullptr;
+    }
+    return &*it;
+}
+
+} // namespace dplx::dlog
@@ -0,0 +1,69 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <dplx/dlog/core/strong_types.hpp>
+
+namespace dplx::dlog
+{
+
+struct scope_threshold_rule
+{
+    // either a scope name like `net.http.client` which only matches the scope
+    // itself or a pattern like `net.*` which matches every scope below `net`.
+    // The most specific rule wins, `*` matches every scope.
+    std::string_view scope;
+    severity threshold;
+};
+
+// An immutable prefix trie of scope threshold rules. A lookup walks the dot
+// separated segments of a scope name, i.e. it takes time proportional to the
+// scope depth and never allocates.
+class scope_threshold_table
+{
+    struct node
+    {
+        std::uint32_t segmentOffset;
+        std::uint32_t segmentSize;
+        std::uint32_t firstChild;
+        std::uint32_t numChildren;
+        // the threshold of the scope denoted by this node
+        severity self;
+        // the threshold of the scopes below this node without a rule
+        severity descendants;
+    };
+
+    std::vector<node> mNodes;
+    std::string mSegments;
+
+public:
+    // throws std::bad_alloc
+    explicit scope_threshold_table(severity defaultThreshold,
+                                   std::span<scope_threshold_rule const> rules
+                                   = {});
+
+    [[nodiscard]] auto default_threshold() const noexcept -> severity
+    {
+        return mNodes.front().self;
+    }
+    [[nodiscard]] auto resolve(std::string_view scopeName) const noexcept
+            -> severity;
+
+private:
+    [[nodiscard]] auto find_child(node const &parent,
+                                  std::string_view segment) const noexcept
+            -> node const *;
+};
+
+} // namespace dplx::dlog
@@ -0,0 +1,60 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/core/scope_thresholds.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+TEST_CASE("scope_threshold_table falls back to the default threshold")
+{
+    dlog::scope_threshold_table const table(dlog::severity::warn);
+    CHECK(table.default_threshold() == dlog::severity::warn);
+    CHECK(table.resolve("net") == dlog::severity::warn);
+    CHECK(table.resolve("net.http.client") == dlog::severity::warn);
+}
+
+TEST_CASE("scope_threshold_table resolves the most specific rule")
+{
+    dlog::scope_threshold_rule const rules[] = {
+            {            "net.*",  dlog::severity::info},
+            {  "net.http.client", dlog::severity::trace},
+            {"net.http.server.*", dlog::severity::error},
+            {               "db", dlog::severity::debug},
+    };
+    dlog::scope_threshold_table const table(dlog::severity::warn, rules);
+
+    CHECK(table.resolve("net") == dlog::severity::warn);
+    CHECK(table.resolve("net.http") == dlog::severity::info);
+    CHECK(table.resolve("net.http.client") == dlog::severity::trace);
+    CHECK(table.resolve("net.http.client.tls") == dlog::severity::info);
+    CHECK(table.resolve("net.http.server") == dlog::severity::info);
+    CHECK(table.resolve("net.http.server.h2") == dlog::severity::error);
+    CHECK(table.resolve("db") == dlog::severity::debug);
+    CHECK(table.resolve("db.pool") == dlog::severity::warn);
+    CHECK(table.resolve("dbx") == dlog::severity::warn);
+}
+
+TEST_CASE("scope_threshold_table supports a catch all rule")
+{
+    dlog::scope_threshold_rule const rules[] = {
+            {  "*", dlog::severity::error},
+            {"app", dlog::severity::debug},
+    };
+    dlog::scope_threshold_table const table(dlog::severity::warn, rules);
+
+    CHECK(table.default_threshold() == dlog::severity::warn);
+    CHECK(table.resolve("lib") == dlog::severity::error);
+    CHECK(table.resolve("app") == dlog::severity::debug);
+    CHECK(table.resolve("app.ui") == dlog::severity::error);
+}
+
+} // namespace dlog_tests
@@ -8,10 +8,12 @@
 #include "dplx/dlog/core/serialized_messages.hpp"
 
 #include <algorithm>
+#include <cstdint>
 #include <span>
 
 #include <dplx/dp/api.hpp>
 #include <dplx/dp/codecs/auto_tuple.hpp>
+#include <dplx/dp/detail/utils.hpp>
 #include <dplx/dp/items/skip_item.hpp>
 #include <dplx/dp/streams/memory_input_stream.hpp>
 
@@ -24,6 +26,75 @@ namespace dplx::dlog::detail
 namespace
 {
 
+// reads the fixed offset head of a record frame as emitted by tlog() and
+// vlog(). The tail items aren't parsed: the buses hand out frames of exactly
+// the size the producer allocated for the encoded record (and the recovery
+// path skips every message item before handing it out), i.e. the frame bound
+// is trusted. The tail contents are checked by the record_container reader.
+auto try_preparse_record_head(bytes const rawMessage,
+                              serialized_message_info &info) noexcept -> bool
+{
+    constexpr auto arrayHead = static_cast<std::byte>(
+            static_cast<unsigned>(dp::type_code::array)
+            | record_num_array_elements);
+    constexpr auto ownerHead = static_cast<unsigned>(dp::type_code::array);
+    constexpr auto ownerFlags
+            = record_owner_scope_flag | record_owner_span_flag;
+    constexpr auto textHead = static_cast<unsigned>(dp::type_code::text);
+    constexpr unsigned inlineLimit = 24U;
+    constexpr auto timestampHead = static_cast<std::byte>(
+            static_cast<unsigned>(dp::type_code::posint) | 27U);
+    constexpr std::size_t minSize
+            = record_owner_offset + 1U + record_timestamp_size;
+
+    auto const *const data = rawMessage.data();
+    auto const size = rawMessage.size();
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    if (size < minSize || data[0] != arrayHead) [[unlikely]]
+    {
+        return false;
+    }
+    auto const encodedSeverity
+            = std::to_integer<unsigned>(data[record_severity_offset]);
+    auto const owner = std::to_integer<unsigned>(data[record_owner_offset]);
+    if (encodedSeverity >= inlineLimit || (owner & ~ownerFlags) != ownerHead)
+            [[unlikely]]
+    {
+        return false;
+    }
+
+    std::size_t offset = record_owner_offset + 1U;
+    if ((owner & record_owner_scope_flag) != 0U)
+    {
+        // instrumentation scopes are short, longer ones take the slow path
+        auto const scopeHead = std::to_integer<unsigned>(data[offset]);
+        if (scopeHead < textHead || scopeHead >= textHead + inlineLimit)
+        {
+            return false;
+        }
+        offset += 1U + (scopeHead - textHead);
+    }
+    if ((owner & record_owner_span_flag) != 0U)
+    {
+        offset += record_owner_span_size;
+    }
+    if (size < offset + record_timestamp_size || data[offset] != timestampHead)
+            [[unlikely]]
+    {
+        return false;
+    }
+
+    info = serialized_record_info{
+            {rawMessage},
+            log_clock::time_point{log_clock::duration{
+                    dp::detail::load<log_clock::rep>(data + offset + 1U)}},
+            // severities are encoded with an offset of one
+            static_cast<severity>(encodedSeverity + 1U),
+    };
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    return true;
+}
+
 auto preparse_record(dp::parse_context &ctx, bytes const rawMessage) noexcept
         -> serialized_message_info
 {
@@ -86,6 +157,40 @@ auto preparse_span_end(dp::parse_context &ctx, bytes const rawMessage) noexcept
     return info;
 }
 
+auto preparse_span_complete(dp::parse_context &ctx,
+                            bytes const rawMessage) noexcept
+        -> serialized_message_info
+{
+    serialized_message_info info{serialized_span_complete_info{{rawMessage}}};
+    auto &parsed = *get_if<serialized_span_complete_info>(&info);
+    for (int i = 0; i < 8; ++i) // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+    {
+        if (dp::skip_item(ctx).has_failure()) [[unlikely]]
+        {
+            info = serialized_malformed_message_info{{rawMessage}};
+        }
+    }
+    parsed.raw_data = rawMessage.first(rawMessage.size() - ctx.in.size());
+    return info;
+}
+
+auto preparse_span_histogram(dp::parse_context &ctx,
+                             bytes const rawMessage) noexcept
+        -> serialized_message_info
+{
+    serialized_message_info info{serialized_span_histogram_info{{rawMessage}}};
+    auto &parsed = *get_if<serialized_span_histogram_info>(&info);
+    for (int i = 0; i < 5; ++i) // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+    {
+        if (dp::skip_item(ctx).has_failure()) [[unlikely]]
+        {
+            info = serialized_malformed_message_info{{rawMessage}};
+        }
+    }
+    parsed.raw_data = rawMessage.first(rawMessage.size() - ctx.in.size());
+    return info;
+}
+
 } // namespace
 
 auto preparse_messages(std::span<bytes const> const &records,
@@ -97,6 +202,11 @@ auto preparse_messages(std::span<bytes const> const &records,
     {
         binarySize += records[i].size();
         auto &info = (parses[i] = serialized_message_info{});
+        if (detail::try_preparse_record_head(records[i], info)) [[likely]]
+        {
+            continue;
+        }
+
         auto &&buffer = dp::get_input_buffer(bytes(records[i]));
         dp::parse_context ctx{buffer};
 
@@ -115,6 +225,12 @@ auto preparse_messages(std::span<bytes const> const &records,
             case 2U: // NOLINT(cppcoreguidelines-avoid-magic-numbers)
                 info = detail::preparse_span_end(ctx, records[i]);
                 break;
+            case 8U: // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+                info = detail::preparse_span_complete(ctx, records[i]);
+                break;
+            case 5U: // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+                info = detail::preparse_span_histogram(ctx, records[i]);
+                break;
 
             default:
                 info = serialized_malformed_message_info{{records[i]}};
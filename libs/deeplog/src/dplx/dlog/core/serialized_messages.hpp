@@ -41,6 +41,12 @@ struct serialized_span_start_info : serialized_info_base
 struct serialized_span_end_info : serialized_info_base
 {
 };
+struct serialized_span_complete_info : serialized_info_base
+{
+};
+struct serialized_span_histogram_info : serialized_info_base
+{
+};
 struct serialized_malformed_message_info : serialized_info_base
 {
 };
@@ -52,6 +58,8 @@ using serialized_message_info
                                    serialized_record_info,
                                    serialized_span_start_info,
                                    serialized_span_end_info,
+                                   serialized_span_complete_info,
+                                   serialized_span_histogram_info,
                                    serialized_malformed_message_info>;
 
 struct record_consumer
@@ -75,6 +83,30 @@ public:
 namespace detail
 {
 
+// record frame layout:
+// array 6
+// +  ui    severity (always an immediate posint)
+// +  arr?  owner (the array head carries the flags below)
+//    +  str    instrumentation scope
+//    +  bstr16 trace id
+//    +  bstr8  span id
+// +  ui64  timestamp (always 9 bytes)
+// +  str   message
+// +  array format args
+// +  map   attributes
+//
+// Apart from the owner the head of a record frame has a fixed layout, which
+// allows preparse_messages() to read the severity and the timestamp with a few
+// loads. Frames which deviate from it are parsed by the generic CBOR parser.
+inline constexpr std::size_t record_num_array_elements = 6U;
+inline constexpr std::size_t record_severity_offset = 1U;
+inline constexpr std::size_t record_owner_offset = 2U;
+inline constexpr unsigned record_owner_scope_flag = 1U;
+inline constexpr unsigned record_owner_span_flag = 2U;
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+inline constexpr std::size_t record_owner_span_size = 17U + 9U;
+inline constexpr std::size_t record_timestamp_size = 9U;
+
 auto preparse_messages(std::span<bytes const> const &records,
                        std::span<serialized_message_info> parses) noexcept
         -> std::size_t;
@@ -6,3 +6,180 @@
 //           https://www.boost.org/LICENSE_1_0.txt)
 
 #include "dplx/dlog/core/serialized_messages.hpp"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <dplx/dp/api.hpp>
+#include <dplx/dp/codecs/auto_tuple.hpp>
+#include <dplx/dp/items/skip_item.hpp>
+#include <dplx/dp/streams/memory_input_stream.hpp>
+
+#include <dplx/dlog/bus/buffer_bus.hpp>
+#include <dplx/dlog/log_fabric.hpp>
+#include <dplx/dlog/macros.hpp>
+#include <dplx/dlog/source/log_context.hpp>
+
+#include "test_dir.hpp"
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+namespace
+{
+
+auto collect_messages(dlog::bufferbus_handle &bus)
+        -> std::vector<std::vector<std::byte>>
+{
+    std::vector<std::vector<std::byte>> messages;
+    REQUIRE(bus.consume_messages(
+            [&messages](std::span<dlog::bytes const> msgs) {
+                for (auto const msg : msgs)
+                {
+                    messages.emplace_back(msg.begin(), msg.end());
+                }
+            }));
+    return messages;
+}
+
+} // namespace
+
+TEST_CASE("preparse_messages reads the record head at fixed offsets")
+{
+    dlog::log_fabric core{
+            dlog::bufferbus(test_dir, TEST_FILE_BB, small_buffer_bus_size)
+                    .value(),
+            dlog::severity::trace};
+    dlog::span_context const owner{{{1, 2}}, {{3}}};
+    dlog::log_context const plainCtx(core);
+    dlog::log_context const ownedCtx(core, owner);
+    dlog::log_context const scopedCtx(core, "preparse.test", owner);
+
+    DLOG_TO(plainCtx, dlog::severity::info, "plain {}", 1);
+    DLOG_TO(ownedCtx, dlog::severity::warn, "owned");
+    DLOG_TO(scopedCtx, dlog::severity::error, "scoped {} {}", "a", 2.0);
+
+    auto const messages = collect_messages(core.message_bus());
+    REQUIRE(messages.size() == 3U);
+
+    std::vector<dlog::bytes> records(messages.begin(), messages.end());
+    std::vector<dlog::serialized_message_info> parses(records.size());
+    auto const binarySize = dlog::detail::preparse_messages(records, parses);
+
+    std::size_t expectedSize = 0U;
+    for (std::size_t i = 0U; i < records.size(); ++i)
+    {
+        expectedSize += records[i].size();
+        auto const *parsed
+                = boost::variant2::get_if<dlog::serialized_record_info>(
+                        &parses[i]);
+        REQUIRE(parsed != nullptr);
+        CHECK(parsed->raw_data.size() == records[i].size());
+
+        // compare against the generic parser
+        auto &&buffer = dp::get_input_buffer(records[i]);
+        dp::parse_context ctx{buffer};
+        REQUIRE(dp::decode_tuple_head(ctx));
+        dlog::severity sev{};
+        dlog::log_clock::time_point timestamp{};
+        REQUIRE(dp::decode(ctx, sev));
+        REQUIRE(dp::skip_item(ctx));
+        REQUIRE(dp::decode(ctx, timestamp));
+        CHECK(parsed->message_severity == sev);
+        CHECK(parsed->timestamp == timestamp);
+    }
+    CHECK(binarySize == expectedSize);
+}
+
+TEST_CASE("preparse_messages falls back to the generic parser")
+{
+    // array 6, severity info, owner array with a scope whose text head
+    // carries a one byte length
+    std::vector<std::byte> scoped{
+            std::byte{0x86}, std::byte{0x08}, std::byte{0x81},
+            std::byte{0x78}, std::byte{0x01}, std::byte{'x'},
+            std::byte{0x1b}};
+    scoped.resize(scoped.size() + 8U, std::byte{0x01});
+    for (auto const tail : {std::byte{0x60}, std::byte{0x80}, std::byte{0xa0}})
+    {
+        scoped.push_back(tail);
+    }
+    std::array<dlog::bytes, 2U> const records{
+            dlog::bytes(scoped),
+            dlog::bytes(scoped).first(scoped.size() - 1U),
+    };
+    std::array<dlog::serialized_message_info, 2U> parses{};
+    (void)dlog::detail::preparse_messages(records, parses);
+
+    auto const *parsed
+            = boost::variant2::get_if<dlog::serialized_record_info>(&parses[0]);
+    REQUIRE(parsed != nullptr);
+    CHECK(parsed->message_severity == dlog::severity::info);
+    CHECK(boost::variant2::holds_alternative<
+            dlog::serialized_malformed_message_info>(parses[1]));
+}
+
+TEST_CASE("preparse_messages rejects a corrupted fixed offset head")
+{
+    dlog::log_fabric core{
+            dlog::bufferbus(test_dir, TEST_FILE_BB, small_buffer_bus_size)
+                    .value(),
+            dlog::severity::trace};
+    dlog::log_context const ctx(core);
+    DLOG_TO(ctx, dlog::severity::info, "head {}", 1);
+
+    auto const messages = collect_messages(core.message_bus());
+    REQUIRE(messages.size() == 1U);
+    auto const &intact = messages.front();
+    // a plain context has an empty owner array, i.e. the timestamp follows
+    auto corrupted = intact;
+    REQUIRE(corrupted.size() > dlog::detail::record_owner_offset + 1U);
+    corrupted[dlog::detail::record_owner_offset + 1U] = std::byte{0xff};
+
+    std::array<dlog::bytes, 2U> const records{
+            dlog::bytes(intact),
+            dlog::bytes(corrupted),
+    };
+    std::array<dlog::serialized_message_info, 2U> parses{};
+    (void)dlog::detail::preparse_messages(records, parses);
+
+    auto const *parsed
+            = boost::variant2::get_if<dlog::serialized_record_info>(&parses[0]);
+    REQUIRE(parsed != nullptr);
+    CHECK(parsed->raw_data.size() == intact.size());
+    CHECK(parsed->message_severity == dlog::severity::info);
+    // the fast path declines and the generic parser rejects the record
+    CHECK(boost::variant2::holds_alternative<
+            dlog::serialized_malformed_message_info>(parses[1]));
+}
+
+TEST_CASE("preparse_messages throughput", "[.][benchmark]")
+{
+    constexpr std::size_t batchSize = 64U;
+    constexpr auto busSize = std::size_t{1} << 16;
+    dlog::log_fabric core{
+            dlog::bufferbus(test_dir, "preparse.bench.dbb", busSize).value(),
+            dlog::severity::trace};
+    dlog::span_context const owner{{{1, 2}}, {{3}}};
+    dlog::log_context const ctx(core, owner);
+    for (std::size_t i = 0U; i < batchSize; ++i)
+    {
+        DLOG_TO(ctx, dlog::severity::info, "record {} of {}", i, batchSize);
+    }
+    auto const messages = collect_messages(core.message_bus());
+    REQUIRE(messages.size() == batchSize);
+    std::vector<dlog::bytes> const records(messages.begin(), messages.end());
+    std::vector<dlog::serialized_message_info> parses(batchSize);
+
+    BENCHMARK("64 records")
+    {
+        return dlog::detail::preparse_messages(records, parses);
+    };
+}
+
+} // namespace dlog_tests
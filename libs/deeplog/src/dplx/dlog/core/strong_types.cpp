@@ -7,25 +7,187 @@
 
 #include "dplx/dlog/core/strong_types.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
 #include <dplx/cncr/utils.hpp>
 #include <dplx/dp/api.hpp>
 #include <dplx/dp/items/emit_core.hpp>
 #include <dplx/dp/items/parse_core.hpp>
 #include <dplx/dp/items/parse_ranges.hpp>
 
+#include <dplx/predef/os.h>
+
 #include <dplx/dlog/llfio.hpp>
 #include <dplx/dlog/loggable.hpp>
 
+#if defined(DPLX_OS_UNIX_AVAILABLE) || defined(DPLX_OS_MACOS_AVAILABLE)
+#include <pthread.h>
+#endif
+
 namespace dplx::dlog
 {
 
+namespace
+{
+
+// incremented in the child process of a fork(), the generators inherited
+// from the parent compare it in order to notice that they need a new key.
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+constinit std::atomic<unsigned> fork_generation{0U};
+
+#if defined(DPLX_OS_UNIX_AVAILABLE) || defined(DPLX_OS_MACOS_AVAILABLE)
+void on_fork_child() noexcept
+{
+    fork_generation.fetch_add(1U, std::memory_order_relaxed);
+}
+#endif
+
+// the handler only needs to be registered before the first key is generated,
+// a fork before that point doesn't duplicate any state
+void register_fork_handler() noexcept
+{
+#if defined(DPLX_OS_UNIX_AVAILABLE) || defined(DPLX_OS_MACOS_AVAILABLE)
+    [[maybe_unused]] static int const registered = ::pthread_atfork(
+            nullptr, nullptr, &on_fork_child);
+#endif
+}
+
+// A per thread ChaCha12 keystream generator which is keyed from the OS random
+// device. It avoids a syscall per root span while still producing trace ids
+// which can't be predicted from previously observed ones. The key is replaced
+// after `reseed_interval` blocks in order to bound the impact of a leaked
+// state, and in the child process of a fork() which would otherwise repeat
+// the trace ids of its parent.
+class trace_id_generator
+{
+    static constexpr int num_rounds = 12;
+    static constexpr std::size_t block_words = 16U;
+    static constexpr std::size_t key_words = 8U;
+    static constexpr std::uint32_t reseed_interval = 1U << 14;
+
+    std::array<std::uint32_t, key_words> mKey{};
+    std::uint64_t mCounter{};
+    std::array<std::uint32_t, block_words> mBlock{};
+    std::size_t mNext{block_words};
+    std::uint32_t mBlocksUntilReseed{};
+    unsigned mForkGeneration{};
+
+public:
+    auto next() noexcept -> trace_id
+    {
+        static_assert(trace_id::state_size % sizeof(std::uint32_t) == 0U);
+        constexpr std::size_t idWords
+                = trace_id::state_size / sizeof(std::uint32_t);
+
+        if (auto const forkGeneration
+            = fork_generation.load(std::memory_order_relaxed);
+            forkGeneration != mForkGeneration) [[unlikely]]
+        {
+            // discard the buffered keystream, too
+            mForkGeneration = forkGeneration;
+            mBlocksUntilReseed = 0U;
+            mNext = block_words;
+        }
+
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
+        std::array<std::uint32_t, idWords> bits;
+        do
+        {
+            if (mNext + idWords > block_words)
+            {
+                refill();
+            }
+            std::copy_n(mBlock.begin() + static_cast<std::ptrdiff_t>(mNext),
+                        idWords, bits.begin());
+            mNext += idWords;
+        }
+        while (std::bit_cast<trace_id>(bits) == trace_id::invalid());
+        return std::bit_cast<trace_id>(bits);
+    }
+
+private:
+    void refill() noexcept
+    {
+        if (mBlocksUntilReseed == 0U)
+        {
+            register_fork_handler();
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            llfio::utils::random_fill(reinterpret_cast<char *>(mKey.data()),
+                                      sizeof(mKey));
+            mCounter = 0U;
+            mBlocksUntilReseed = reseed_interval;
+        }
+        mBlocksUntilReseed -= 1U;
+
+        // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+        std::array<std::uint32_t, block_words> const input{
+                0x6170'7865U,
+                0x3320'646eU,
+                0x7962'2d32U,
+                0x6b20'6574U,
+                mKey[0],
+                mKey[1],
+                mKey[2],
+                mKey[3],
+                mKey[4],
+                mKey[5],
+                mKey[6],
+                mKey[7],
+                static_cast<std::uint32_t>(mCounter),
+                static_cast<std::uint32_t>(mCounter >> 32),
+                0U,
+                0U,
+        };
+        mCounter += 1U;
+
+        auto x = input;
+        auto const quarterRound = [&x](std::size_t a, std::size_t b,
+                                       std::size_t c, std::size_t d) {
+            x[a] += x[b];
+            x[d] = std::rotl(x[d] ^ x[a], 16);
+            x[c] += x[d];
+            x[b] = std::rotl(x[b] ^ x[c], 12);
+            x[a] += x[b];
+            x[d] = std::rotl(x[d] ^ x[a], 8);
+            x[c] += x[d];
+            x[b] = std::rotl(x[b] ^ x[c], 7);
+        };
+        for (int i = 0; i < num_rounds; i += 2)
+        {
+            quarterRound(0, 4, 8, 12);
+            quarterRound(1, 5, 9, 13);
+            quarterRound(2, 6, 10, 14);
+            quarterRound(3, 7, 11, 15);
+            quarterRound(0, 5, 10, 15);
+            quarterRound(1, 6, 11, 12);
+            quarterRound(2, 7, 8, 13);
+            quarterRound(3, 4, 9, 14);
+        }
+        // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+        for (std::size_t i = 0U; i < block_words; ++i)
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+            mBlock[i] = x[i] + input[i];
+        }
+        mNext = 0U;
+    }
+};
+
+// the generator is an implementation detail of this translation unit, i.e.
+// the thread_local doesn't cross a DLL boundary.
+thread_local trace_id_generator trace_id_prng;
+
+} // namespace
+
 auto trace_id::random() noexcept -> trace_id
 {
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
-    cncr::blob<char, state_size, alignof(trace_id)> bits;
-    llfio::utils::random_fill(static_cast<char *>(bits.values),
-                              sizeof(bits.values));
-    return std::bit_cast<trace_id>(bits);
+    return trace_id_prng.next();
 }
 
 } // namespace dplx::dlog
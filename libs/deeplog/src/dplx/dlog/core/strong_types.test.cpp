@@ -7,8 +7,85 @@
 
 #include "dplx/dlog/core/strong_types.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <dplx/predef/os.h>
+
+#if defined(DPLX_OS_UNIX_AVAILABLE) || defined(DPLX_OS_MACOS_AVAILABLE)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #include "test_utils.hpp"
 
 namespace dlog_tests
 {
+
+TEST_CASE("trace_id::random() generates distinct valid ids")
+{
+    // exceeds a single keystream block and the reseed interval
+    constexpr std::size_t numIds = 70'000U;
+    std::vector<dlog::trace_id> ids;
+    ids.reserve(numIds);
+    for (std::size_t i = 0U; i < numIds; ++i)
+    {
+        ids.push_back(dlog::trace_id::random());
+    }
+
+    CHECK(std::ranges::find(ids, dlog::trace_id::invalid()) == ids.end());
+    std::ranges::sort(ids, [](dlog::trace_id lhs, dlog::trace_id rhs) {
+        return std::ranges::lexicographical_compare(lhs._state, rhs._state);
+    });
+    CHECK(std::ranges::adjacent_find(ids) == ids.end());
+}
+
+#if defined(DPLX_OS_UNIX_AVAILABLE) || defined(DPLX_OS_MACOS_AVAILABLE)
+TEST_CASE("trace_id::random() rekeys in a forked child")
+{
+    constexpr std::size_t numIds = 64U;
+    // key the generator of this thread before forking
+    (void)dlog::trace_id::random();
+
+    std::array<int, 2> fds{};
+    REQUIRE(::pipe(fds.data()) == 0);
+    auto const child = ::fork();
+    REQUIRE(child >= 0);
+    if (child == 0)
+    {
+        std::array<dlog::trace_id, numIds> childIds{};
+        for (auto &id : childIds)
+        {
+            id = dlog::trace_id::random();
+        }
+        auto const written = ::write(fds[1], childIds.data(), sizeof(childIds));
+        ::_exit(written == static_cast<::ssize_t>(sizeof(childIds)) ? 0 : 1);
+    }
+    ::close(fds[1]);
+
+    std::vector<dlog::trace_id> ids;
+    for (std::size_t i = 0U; i < numIds; ++i)
+    {
+        ids.push_back(dlog::trace_id::random());
+    }
+    std::array<dlog::trace_id, numIds> childIds{};
+    auto const read = ::read(fds[0], childIds.data(), sizeof(childIds));
+    ::close(fds[0]);
+    int status = 0;
+    REQUIRE(::waitpid(child, &status, 0) == child);
+    REQUIRE(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+    REQUIRE(read == static_cast<::ssize_t>(sizeof(childIds)));
+
+    for (auto const &id : childIds)
+    {
+        CHECK(std::ranges::find(ids, id) == ids.end());
+    }
 }
+#endif
+
+} // namespace dlog_tests
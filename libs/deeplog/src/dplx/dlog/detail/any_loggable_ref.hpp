@@ -248,6 +248,26 @@ using any_loggable_ref_storage_type_of_t =
 #include <dplx/dlog/detail/x_poly_types.inl>
 #undef DPLX_X
 
+template <any_loggable_ref_storage_id Id>
+DPLX_ATTR_FORCE_INLINE constexpr auto
+get(any_loggable_ref_storage const &storage) noexcept
+        -> any_loggable_ref_storage_type_of_t<Id> const &
+{
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+#define DPLX_X(name, type, var)                                                \
+    if constexpr (Id == any_loggable_ref_storage_id::name)                     \
+    {                                                                          \
+        return storage.var;                                                    \
+    }                                                                          \
+    else
+#include <dplx/dlog/detail/x_poly_types.inl>
+#undef DPLX_X
+    {
+        cncr::unreachable();
+    }
+    // NOLINTEND(cppcoreguidelines-pro-type-union-access)
+}
+
 #undef DPLX_X_WITH_THUNK
 
 template <typename T>
@@ -274,6 +294,17 @@ template <typename T>
 inline constexpr any_loggable_ref_storage_id any_loggable_ref_storage_tag<T>
         = any_loggable_ref_storage_id::string;
 
+template <typename T>
+    requires(effective_reification_tag_v<T> == reification_type_id::binary
+             && std::convertible_to<T const &, trivial_blob_view>)
+inline constexpr any_loggable_ref_storage_id any_loggable_ref_storage_tag<T>
+        = any_loggable_ref_storage_id::binary;
+template <typename T>
+    requires(effective_reification_tag_v<T> == reification_type_id::typed_array
+             && std::convertible_to<T const &, trivial_typed_array_view>)
+inline constexpr any_loggable_ref_storage_id any_loggable_ref_storage_tag<T>
+        = any_loggable_ref_storage_id::typed_array;
+
 template <std::derived_from<system_error::status_code<void>> T>
 inline constexpr any_loggable_ref_storage_id any_loggable_ref_storage_tag<T>
         = any_loggable_ref_storage_id::status_code;
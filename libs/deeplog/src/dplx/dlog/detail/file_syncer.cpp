@@ -0,0 +1,139 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/detail/file_syncer.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+namespace dplx::dlog::detail
+{
+
+struct file_syncer::state
+{
+    std::mutex mutex;
+    std::condition_variable wakeWorker;
+    std::condition_variable wakeWaiters;
+    llfio::file_handle file;
+    std::uint64_t numRequested{};
+    std::uint64_t numCompleted{};
+    bool stop{};
+    system_error::system_code status{};
+    std::thread worker;
+
+    void run() noexcept
+    {
+        std::unique_lock lock(mutex);
+        for (;;)
+        {
+            wakeWorker.wait(lock, [this] {
+                return stop || numRequested != numCompleted;
+            });
+            if (numRequested == numCompleted)
+            {
+                return;
+            }
+            // every request up to this point is covered by the next sync
+            auto const target = numRequested;
+            lock.unlock();
+
+            auto syncRx = file.barrier(
+                    {}, llfio::file_handle::barrier_kind::wait_data_only);
+
+            lock.lock();
+            numCompleted = target;
+            if (syncRx.has_error() && !status.failure())
+            {
+                status = std::move(syncRx).assume_error();
+            }
+            wakeWaiters.notify_all();
+        }
+    }
+};
+
+file_syncer::~file_syncer() noexcept
+{
+    if (!mState)
+    {
+        return;
+    }
+    {
+        std::lock_guard lock(mState->mutex);
+        mState->stop = true;
+    }
+    mState->wakeWorker.notify_one();
+    mState->worker.join();
+}
+file_syncer::file_syncer() noexcept = default;
+file_syncer::file_syncer(file_syncer &&) noexcept = default;
+auto file_syncer::operator=(file_syncer &&other) noexcept -> file_syncer &
+{
+    file_syncer discarded(std::move(*this));
+    mState = std::move(other.mState);
+    return *this;
+}
+
+auto file_syncer::create() noexcept -> result<file_syncer>
+try
+{
+    file_syncer self;
+    self.mState = std::make_unique<state>();
+    self.mState->worker = std::thread(&state::run, self.mState.get());
+    return self;
+}
+catch (std::bad_alloc const &)
+{
+    return errc::not_enough_memory;
+}
+catch (std::system_error const &)
+{
+    return system_error::errc::resource_unavailable_try_again;
+}
+
+auto file_syncer::attach(llfio::file_handle const &file) noexcept
+        -> result<void>
+{
+    DPLX_TRY(wait());
+    DPLX_TRY(auto &&reopened, file.reopen());
+    std::lock_guard lock(mState->mutex);
+    mState->file = std::move(reopened);
+    return outcome::success();
+}
+
+auto file_syncer::request() noexcept -> result<void>
+{
+    auto &state = *mState;
+    std::lock_guard lock(state.mutex);
+    if (state.status.failure())
+    {
+        return state.status.clone();
+    }
+    state.numRequested += 1U;
+    state.wakeWorker.notify_one();
+    return outcome::success();
+}
+
+auto file_syncer::wait() noexcept -> result<void>
+{
+    auto &state = *mState;
+    std::unique_lock lock(state.mutex);
+    state.wakeWaiters.wait(lock, [&state] {
+        return state.numRequested == state.numCompleted;
+    });
+    if (state.status.failure())
+    {
+        return state.status.clone();
+    }
+    return outcome::success();
+}
+
+} // namespace dplx::dlog::detail
@@ -0,0 +1,55 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <memory>
+
+#include <dplx/dlog/disappointment.hpp>
+#include <dplx/dlog/llfio.hpp>
+
+namespace dplx::dlog::detail
+{
+
+// Persists the data of a file (fdatasync) on a helper thread. Requests which
+// arrive while a sync is running are coalesced into a single follow-up sync,
+// i.e. the syncs are group committed. The thread operates on a handle of its
+// own, therefore the caller may close its handle at any time.
+//
+// A failed sync is sticky, i.e. every later request() and wait() reports it:
+// the pages of the failed sync may have been dropped from the page cache, so a
+// subsequent successful sync wouldn't make them durable.
+class file_syncer
+{
+    struct state;
+    std::unique_ptr<state> mState;
+
+public:
+    ~file_syncer() noexcept;
+    file_syncer() noexcept;
+
+    file_syncer(file_syncer &&) noexcept;
+    auto operator=(file_syncer &&) noexcept -> file_syncer &;
+
+    static auto create() noexcept -> result<file_syncer>;
+
+    [[nodiscard]] auto is_valid() const noexcept -> bool
+    {
+        return static_cast<bool>(mState);
+    }
+
+    // waits for the pending syncs and switches to the given file
+    auto attach(llfio::file_handle const &file) noexcept -> result<void>;
+
+    // requests a sync which covers every write completed before the call,
+    // reports the failure of a previous sync
+    auto request() noexcept -> result<void>;
+    // waits until every requested sync completed
+    auto wait() noexcept -> result<void>;
+};
+
+} // namespace dplx::dlog::detail
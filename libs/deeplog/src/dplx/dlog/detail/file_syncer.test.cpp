@@ -0,0 +1,42 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/detail/file_syncer.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_dir.hpp"
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+TEST_CASE("file_syncer syncs the attached file on its thread")
+{
+    auto createRx = dlog::detail::file_syncer::create();
+    REQUIRE(createRx);
+    auto &&syncer = std::move(createRx).assume_value();
+
+    auto fileRx = llfio::file(test_dir, make_file_name(__FILE__, "bin"),
+                              llfio::file_handle::mode::write,
+                              llfio::file_handle::creation::always_new);
+    REQUIRE(fileRx);
+    REQUIRE(syncer.attach(fileRx.assume_value()));
+
+    for (int i = 0; i < 3; ++i)
+    {
+        CHECK(syncer.request());
+    }
+    CHECK(syncer.wait());
+
+    // the syncer doesn't depend on the lifetime of the attached handle
+    REQUIRE(fileRx.assume_value().close());
+    CHECK(syncer.request());
+    CHECK(syncer.wait());
+}
+
+} // namespace dlog_tests
@@ -0,0 +1,500 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/detail/io_uring_writer.hpp"
+
+#include <new>
+#include <utility>
+
+#include <dplx/predef/os.h>
+
+#include <dplx/dlog/config.hpp>
+
+#if defined(DPLX_OS_LINUX_AVAILABLE) && __has_include(<linux/io_uring.h>)
+#define DPLX_DLOG_HAS_IO_URING 1
+#else
+#define DPLX_DLOG_HAS_IO_URING 0
+#endif
+
+#if DPLX_DLOG_HAS_IO_URING
+#include <algorithm>
+#include <cerrno>
+#include <vector>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if DPLX_DLOG_USE_BOOST_ATOMIC_REF
+#include <boost/atomic/atomic_ref.hpp>
+#else
+#include <atomic>
+#endif
+#endif
+
+#if DPLX_DLOG_HAS_IO_URING
+
+namespace dplx::dlog::detail
+{
+
+namespace
+{
+
+#if DPLX_DLOG_USE_BOOST_ATOMIC_REF
+using boost::atomic_ref;
+using boost::memory_order;
+#else
+using std::atomic_ref;
+using std::memory_order;
+#endif
+
+auto uring_setup(unsigned entries, io_uring_params *params) noexcept -> int
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+auto uring_enter(int fd,
+                 unsigned toSubmit,
+                 unsigned minComplete,
+                 unsigned flags) noexcept -> int
+{
+    int rx{};
+    do
+    {
+        rx = static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit,
+                                        minComplete, flags, nullptr, 0));
+    }
+    while (rx < 0 && errno == EINTR);
+    return rx;
+}
+auto uring_register(int fd,
+                    unsigned opcode,
+                    void const *arg,
+                    unsigned numArgs) noexcept -> int
+{
+    return static_cast<int>(
+            ::syscall(__NR_io_uring_register, fd, opcode, arg, numArgs));
+}
+
+auto map_ring(int fd, std::size_t size, std::uint64_t offset) noexcept
+        -> void *
+{
+    return ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd, static_cast<off_t>(offset));
+}
+
+// the user_data of the datasync requests, the writes use the buffer index
+constexpr std::uint64_t datasync_tag = ~std::uint64_t{};
+
+template <typename T>
+auto ring_ptr(void *ring, std::uint32_t offset) noexcept -> T *
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    return reinterpret_cast<T *>(static_cast<std::byte *>(ring) + offset);
+}
+
+} // namespace
+
+struct io_uring_writer::ring
+{
+    int fd{-1};
+    void *sqRing{MAP_FAILED};
+    std::size_t sqRingSize{};
+    void *cqRing{MAP_FAILED};
+    std::size_t cqRingSize{};
+    io_uring_sqe *sqes{static_cast<io_uring_sqe *>(MAP_FAILED)};
+    std::size_t sqesSize{};
+
+    unsigned *sqTail{};
+    unsigned *sqMask{};
+    unsigned *sqArray{};
+    unsigned *cqHead{};
+    unsigned *cqTail{};
+    unsigned *cqMask{};
+    io_uring_cqe *cqes{};
+
+    void *buffers{MAP_FAILED};
+    std::size_t bufferSize{};
+    std::vector<std::uint32_t> submittedSizes;
+    unsigned current{};
+    unsigned numPending{};
+    unsigned numPendingSyncs{};
+    bool fileAttached{};
+    // the first write failure, writes following it are still carried out
+    system_error::system_code status{};
+
+    ring() noexcept = default;
+    ~ring() noexcept
+    {
+        if (buffers != MAP_FAILED)
+        {
+            ::munmap(buffers, bufferSize * submittedSizes.size());
+        }
+        if (sqes != MAP_FAILED)
+        {
+            ::munmap(sqes, sqesSize);
+        }
+        if (cqRing != MAP_FAILED && cqRing != sqRing)
+        {
+            ::munmap(cqRing, cqRingSize);
+        }
+        if (sqRing != MAP_FAILED)
+        {
+            ::munmap(sqRing, sqRingSize);
+        }
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+    }
+    ring(ring const &) = delete;
+    auto operator=(ring const &) -> ring & = delete;
+
+    [[nodiscard]] auto buffer(unsigned const which) const noexcept
+            -> std::span<std::byte>
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return {static_cast<std::byte *>(buffers) + which * bufferSize,
+                bufferSize};
+    }
+
+    void reap() noexcept
+    {
+        auto head = atomic_ref<unsigned>(*cqHead).load(memory_order::relaxed);
+        auto const tail
+                = atomic_ref<unsigned>(*cqTail).load(memory_order::acquire);
+        for (; head != tail; ++head)
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            auto const &cqe = cqes[head & *cqMask];
+            bool const isSync = cqe.user_data == datasync_tag;
+            (isSync ? numPendingSyncs : numPending) -= 1U;
+            if (status.failure())
+            {
+                continue;
+            }
+            if (cqe.res < 0)
+            {
+                status = system_error::posix_code(-cqe.res);
+            }
+            else if (!isSync
+                     && static_cast<std::uint32_t>(cqe.res)
+                                != submittedSizes[cqe.user_data])
+            {
+                // a short write to a regular file is caused by ENOSPC/EFBIG
+                status = system_error::errc::no_space_on_device;
+            }
+        }
+        atomic_ref<unsigned>(*cqHead).store(head, memory_order::release);
+    }
+    auto wait_for_completion() noexcept -> result<void>
+    {
+        if (uring_enter(fd, 0U, 1U, IORING_ENTER_GETEVENTS) < 0)
+        {
+            return system_error::posix_code::current();
+        }
+        reap();
+        return outcome::success();
+    }
+    auto push(io_uring_sqe const &sqe) noexcept -> result<void>
+    {
+        auto const tail = *sqTail;
+        auto const index = tail & *sqMask;
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        sqes[index] = sqe;
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        sqArray[index] = index;
+        atomic_ref<unsigned>(*sqTail).store(tail + 1U, memory_order::release);
+
+        if (uring_enter(fd, 1U, 0U, 0U) < 0)
+        {
+            return system_error::posix_code::current();
+        }
+        return outcome::success();
+    }
+    [[nodiscard]] auto current_status() const noexcept -> result<void>
+    {
+        if (status.failure())
+        {
+            return status.clone();
+        }
+        return outcome::success();
+    }
+};
+
+io_uring_writer::~io_uring_writer() noexcept
+{
+    if (mRing)
+    {
+        (void)wait();
+    }
+}
+io_uring_writer::io_uring_writer() noexcept = default;
+io_uring_writer::io_uring_writer(io_uring_writer &&) noexcept = default;
+auto io_uring_writer::operator=(io_uring_writer &&other) noexcept
+        -> io_uring_writer &
+{
+    if (mRing)
+    {
+        (void)wait();
+    }
+    mRing = std::move(other.mRing);
+    return *this;
+}
+
+auto io_uring_writer::create(std::size_t bufferSize,
+                             unsigned const numBuffers) noexcept
+        -> result<io_uring_writer>
+try
+{
+    auto self = io_uring_writer();
+    self.mRing = std::make_unique<ring>();
+    auto &r = *self.mRing;
+
+    auto const pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    bufferSize = (bufferSize + pageSize - 1U) / pageSize * pageSize;
+    r.bufferSize = bufferSize;
+    r.submittedSizes.resize(numBuffers);
+
+    io_uring_params params{};
+    r.fd = uring_setup(numBuffers, &params);
+    if (r.fd < 0)
+    {
+        // ENOSYS: not compiled in, EPERM/EACCES: disabled by sysctl or
+        // seccomp, EINVAL: unsupported parameters
+        if (auto const error = errno; error == ENOSYS || error == EPERM
+                                      || error == EACCES || error == EINVAL)
+        {
+            return system_error::errc::not_supported;
+        }
+        return system_error::posix_code::current();
+    }
+
+    r.sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    r.cqRingSize = params.cq_off.cqes
+                 + params.cq_entries * sizeof(io_uring_cqe);
+    bool const singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0U;
+    if (singleMmap)
+    {
+        r.sqRingSize = r.cqRingSize = std::max(r.sqRingSize, r.cqRingSize);
+    }
+    r.sqRing = map_ring(r.fd, r.sqRingSize, IORING_OFF_SQ_RING);
+    if (r.sqRing == MAP_FAILED)
+    {
+        return system_error::posix_code::current();
+    }
+    r.cqRing = singleMmap ? r.sqRing
+                          : map_ring(r.fd, r.cqRingSize, IORING_OFF_CQ_RING);
+    if (r.cqRing == MAP_FAILED)
+    {
+        return system_error::posix_code::current();
+    }
+    r.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    r.sqes = static_cast<io_uring_sqe *>(
+            map_ring(r.fd, r.sqesSize, IORING_OFF_SQES));
+    if (r.sqes == MAP_FAILED)
+    {
+        return system_error::posix_code::current();
+    }
+
+    r.sqTail = ring_ptr<unsigned>(r.sqRing, params.sq_off.tail);
+    r.sqMask = ring_ptr<unsigned>(r.sqRing, params.sq_off.ring_mask);
+    r.sqArray = ring_ptr<unsigned>(r.sqRing, params.sq_off.array);
+    r.cqHead = ring_ptr<unsigned>(r.cqRing, params.cq_off.head);
+    r.cqTail = ring_ptr<unsigned>(r.cqRing, params.cq_off.tail);
+    r.cqMask = ring_ptr<unsigned>(r.cqRing, params.cq_off.ring_mask);
+    r.cqes = ring_ptr<io_uring_cqe>(r.cqRing, params.cq_off.cqes);
+
+    r.buffers = ::mmap(nullptr, bufferSize * numBuffers,
+                       PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                       -1, 0);
+    if (r.buffers == MAP_FAILED)
+    {
+        return system_error::posix_code::current();
+    }
+    std::vector<::iovec> iovecs(numBuffers);
+    for (unsigned i = 0U; i < numBuffers; ++i)
+    {
+        auto const buffer = r.buffer(i);
+        iovecs[i] = {buffer.data(), buffer.size()};
+    }
+    if (uring_register(r.fd, IORING_REGISTER_BUFFERS, iovecs.data(),
+                       numBuffers)
+        < 0)
+    {
+        // registered buffers count against RLIMIT_MEMLOCK
+        return system_error::posix_code::current();
+    }
+    return self;
+}
+catch (std::bad_alloc const &)
+{
+    return errc::not_enough_memory;
+}
+
+auto io_uring_writer::attach(llfio::file_handle const &file) noexcept
+        -> result<void>
+{
+    auto &r = *mRing;
+    DPLX_TRY(wait());
+    if (r.fileAttached)
+    {
+        if (uring_register(r.fd, IORING_UNREGISTER_FILES, nullptr, 0U) < 0)
+        {
+            return system_error::posix_code::current();
+        }
+        r.fileAttached = false;
+    }
+    int const fds[] = {file.native_handle().fd};
+    if (uring_register(r.fd, IORING_REGISTER_FILES, fds, 1U) < 0)
+    {
+        return system_error::posix_code::current();
+    }
+    r.fileAttached = true;
+    return outcome::success();
+}
+
+auto io_uring_writer::buffer() const noexcept -> std::span<std::byte>
+{
+    return mRing->buffer(mRing->current);
+}
+
+auto io_uring_writer::submit(std::size_t const size) noexcept -> result<void>
+{
+    auto &r = *mRing;
+    r.reap();
+    DPLX_TRY(r.current_status());
+    if (size == 0U)
+    {
+        return outcome::success();
+    }
+
+    io_uring_sqe sqe{};
+    sqe.opcode = IORING_OP_WRITE_FIXED;
+    // the file is opened in append mode, i.e. the offset is ignored and the
+    // writes must not be reordered
+    sqe.flags = IOSQE_FIXED_FILE | IOSQE_IO_DRAIN;
+    sqe.fd = 0;
+    sqe.off = 0U;
+    sqe.addr = reinterpret_cast<std::uintptr_t>(buffer().data());
+    sqe.len = static_cast<std::uint32_t>(size);
+    sqe.buf_index = static_cast<std::uint16_t>(r.current);
+    sqe.user_data = r.current;
+    DPLX_TRY(r.push(sqe));
+    r.submittedSizes[r.current] = static_cast<std::uint32_t>(size);
+    r.numPending += 1U;
+    r.current = (r.current + 1U) % r.submittedSizes.size();
+
+    // the writes complete in order, therefore the next buffer is free as soon
+    // as the oldest pending write completed
+    while (r.numPending == r.submittedSizes.size())
+    {
+        DPLX_TRY(r.wait_for_completion());
+    }
+    return r.current_status();
+}
+
+auto io_uring_writer::submit_datasync() noexcept -> result<void>
+{
+    auto &r = *mRing;
+    r.reap();
+    DPLX_TRY(r.current_status());
+    // the completion queue has room for a sync per buffer in addition to the
+    // writes
+    while (r.numPendingSyncs == r.submittedSizes.size())
+    {
+        DPLX_TRY(r.wait_for_completion());
+    }
+
+    io_uring_sqe sqe{};
+    sqe.opcode = IORING_OP_FSYNC;
+    sqe.flags = IOSQE_FIXED_FILE | IOSQE_IO_DRAIN;
+    sqe.fd = 0;
+    sqe.fsync_flags = IORING_FSYNC_DATASYNC;
+    sqe.user_data = datasync_tag;
+    DPLX_TRY(r.push(sqe));
+    r.numPendingSyncs += 1U;
+    return outcome::success();
+}
+
+auto io_uring_writer::reap() noexcept -> result<void>
+{
+    mRing->reap();
+    return mRing->current_status();
+}
+
+auto io_uring_writer::wait() noexcept -> result<void>
+{
+    auto &r = *mRing;
+    while (r.numPending + r.numPendingSyncs > 0U)
+    {
+        DPLX_TRY(r.wait_for_completion());
+    }
+    return r.current_status();
+}
+
+auto io_uring_writer::num_pending() const noexcept -> unsigned
+{
+    return mRing->numPending;
+}
+
+} // namespace dplx::dlog::detail
+
+#else // ^^^ io_uring available / no io_uring vvv
+
+namespace dplx::dlog::detail
+{
+
+struct io_uring_writer::ring
+{
+};
+
+io_uring_writer::~io_uring_writer() noexcept = default;
+io_uring_writer::io_uring_writer() noexcept = default;
+io_uring_writer::io_uring_writer(io_uring_writer &&) noexcept = default;
+auto io_uring_writer::operator=(io_uring_writer &&) noexcept
+        -> io_uring_writer & = default;
+
+auto io_uring_writer::create(std::size_t, unsigned) noexcept
+        -> result<io_uring_writer>
+{
+    return system_error::errc::not_supported;
+}
+auto io_uring_writer::attach(llfio::file_handle const &) noexcept
+        -> result<void>
+{
+    return system_error::errc::not_supported;
+}
+auto io_uring_writer::buffer() const noexcept -> std::span<std::byte>
+{
+    return {};
+}
+auto io_uring_writer::submit(std::size_t) noexcept -> result<void>
+{
+    return system_error::errc::not_supported;
+}
+auto io_uring_writer::submit_datasync() noexcept -> result<void>
+{
+    return system_error::errc::not_supported;
+}
+auto io_uring_writer::reap() noexcept -> result<void>
+{
+    return outcome::success();
+}
+auto io_uring_writer::wait() noexcept -> result<void>
+{
+    return outcome::success();
+}
+auto io_uring_writer::num_pending() const noexcept -> unsigned
+{
+    return 0U;
+}
+
+} // namespace dplx::dlog::detail
+
+#endif // ^^^ no io_uring ^^^
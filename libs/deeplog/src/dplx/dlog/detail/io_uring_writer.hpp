@@ -0,0 +1,72 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include <dplx/dlog/disappointment.hpp>
+#include <dplx/dlog/llfio.hpp>
+
+namespace dplx::dlog::detail
+{
+
+// Appends to a file via an io_uring with a fixed set of registered buffers
+// and a registered (fixed) file. The caller fills buffer() and hands it over
+// with submit() which returns immediately unless every buffer is in flight.
+// The writes are serialized by the ring, i.e. they land in submission order.
+// Completions are reaped lazily by later calls; write failures are reported
+// by the next call.
+//
+// The attached file must have been opened in append mode and must not be
+// closed before wait() returned.
+class io_uring_writer
+{
+    struct ring;
+    std::unique_ptr<ring> mRing;
+
+public:
+    ~io_uring_writer() noexcept;
+    io_uring_writer() noexcept;
+
+    io_uring_writer(io_uring_writer &&) noexcept;
+    auto operator=(io_uring_writer &&) noexcept -> io_uring_writer &;
+
+    // fails with errc::not_supported if the platform or the kernel doesn't
+    // provide io_uring (or forbids its use)
+    static auto create(std::size_t bufferSize, unsigned numBuffers) noexcept
+            -> result<io_uring_writer>;
+
+    [[nodiscard]] auto is_valid() const noexcept -> bool
+    {
+        return static_cast<bool>(mRing);
+    }
+
+    // waits for the pending writes and registers the file as the target of
+    // the following writes
+    auto attach(llfio::file_handle const &file) noexcept -> result<void>;
+
+    // the buffer to be filled by the caller, it is page aligned
+    [[nodiscard]] auto buffer() const noexcept -> std::span<std::byte>;
+
+    // submits a write of the first size bytes of buffer() and switches to the
+    // next buffer
+    auto submit(std::size_t size) noexcept -> result<void>;
+    // submits an fdatasync which is carried out after the submitted writes
+    auto submit_datasync() noexcept -> result<void>;
+    // reaps the completed writes without blocking
+    auto reap() noexcept -> result<void>;
+    // waits until every submitted write and sync completed
+    auto wait() noexcept -> result<void>;
+
+    [[nodiscard]] auto num_pending() const noexcept -> unsigned;
+};
+
+} // namespace dplx::dlog::detail
@@ -0,0 +1,67 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/detail/io_uring_writer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_dir.hpp"
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+TEST_CASE("io_uring_writer appends the submitted buffers in order")
+{
+    constexpr std::size_t bufferSize = 4096U;
+    auto createRx = dlog::detail::io_uring_writer::create(bufferSize, 2U);
+    if (createRx.has_error()
+        && createRx.assume_error() == system_error::errc::not_supported)
+    {
+        SKIP("io_uring is not available");
+    }
+    REQUIRE(createRx);
+    auto &&writer = std::move(createRx).assume_value();
+
+    auto const fileName = make_file_name(__FILE__, "bin");
+    auto fileRx = llfio::file(test_dir, fileName,
+                              llfio::file_handle::mode::append,
+                              llfio::file_handle::creation::always_new);
+    REQUIRE(fileRx);
+    auto &&file = std::move(fileRx).assume_value();
+    REQUIRE(writer.attach(file));
+
+    constexpr std::size_t writeSize = 100U;
+    constexpr int numWrites = 5;
+    for (int i = 0; i < numWrites; ++i)
+    {
+        auto const buffer = writer.buffer();
+        REQUIRE(buffer.size() >= bufferSize);
+        std::fill_n(buffer.data(), writeSize, static_cast<std::byte>(i));
+        REQUIRE(writer.submit(writeSize));
+        CHECK(writer.num_pending() < 2U);
+    }
+    REQUIRE(writer.wait());
+    CHECK(writer.num_pending() == 0U);
+    CHECK(file.maximum_extent().value() == numWrites * writeSize);
+
+    auto readerRx = llfio::file(test_dir, fileName);
+    REQUIRE(readerRx);
+    std::byte content[numWrites * writeSize] = {};
+    llfio::file_handle::buffer_type readBuffers[] = {content};
+    REQUIRE(readerRx.assume_value().read({readBuffers, 0U}));
+    for (int i = 0; i < numWrites; ++i)
+    {
+        CHECK(content[i * writeSize] == static_cast<std::byte>(i));
+        CHECK(content[(i + 1) * writeSize - 1] == static_cast<std::byte>(i));
+    }
+}
+
+} // namespace dlog_tests
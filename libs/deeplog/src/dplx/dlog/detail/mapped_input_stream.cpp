@@ -0,0 +1,158 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/detail/mapped_input_stream.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <dplx/predef/os.h>
+
+#if defined(DPLX_OS_UNIX_AVAILABLE) || defined(DPLX_OS_MACOS_AVAILABLE)
+#include <sys/mman.h>
+#endif
+
+namespace dplx::dlog::detail
+{
+
+namespace
+{
+
+#if defined(DPLX_OS_UNIX_AVAILABLE) || defined(DPLX_OS_MACOS_AVAILABLE)
+constexpr int advice_sequential = MADV_SEQUENTIAL;
+constexpr int advice_willneed = MADV_WILLNEED;
+#else
+constexpr int advice_sequential = 0;
+constexpr int advice_willneed = 0;
+#endif
+
+// the advice is only a hint, i.e. failures are ignored
+void advise(std::byte const *const mappedData,
+            std::uint64_t const mappedSize,
+            std::uint64_t offset,
+            std::uint64_t size,
+            [[maybe_unused]] int const advice) noexcept
+{
+    if (mappedData == nullptr || offset >= mappedSize)
+    {
+        return;
+    }
+    // madvise() expects a page aligned address
+    auto const pageSize = llfio::utils::page_size();
+    size = std::min(size, mappedSize - offset) + offset % pageSize;
+    offset -= offset % pageSize;
+#if defined(DPLX_OS_UNIX_AVAILABLE) || defined(DPLX_OS_MACOS_AVAILABLE)
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-const-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    (void)::madvise(const_cast<std::byte *>(mappedData + offset),
+                    static_cast<std::size_t>(size), advice);
+    // NOLINTEND(cppcoreguidelines-pro-type-const-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+#endif
+}
+
+} // namespace
+
+mapped_input_stream::mapped_input_stream(
+        llfio::mapped_file_handle &&mappedFile,
+        std::uint64_t const streamSize) noexcept
+    : input_buffer(nullptr, 0U, streamSize)
+    , mMappedFile(std::move(mappedFile))
+    , mMappedData(mMappedFile.address())
+    , mStreamSize(streamSize)
+    , mReadAreaEnd(0U)
+{
+    advise(mMappedData, mStreamSize, 0U, mStreamSize, advice_sequential);
+    seek(0U, 0U);
+}
+
+auto mapped_input_stream::create(llfio::file_handle const &file,
+                                 std::uint64_t const maxSize) noexcept
+        -> result<mapped_input_stream>
+{
+    if (!file.is_readable())
+    {
+        return errc::invalid_argument;
+    }
+    DPLX_TRY(auto const extent, file.maximum_extent());
+    auto const streamSize = std::min<std::uint64_t>(extent, maxSize);
+    if (streamSize == 0U)
+    {
+        // empty files can't be mapped
+        return mapped_input_stream();
+    }
+
+    DPLX_TRY(auto &&reopened, file.reopen());
+    llfio::mapped_file_handle mappedFile(std::move(reopened),
+                                         llfio::section_handle::flag::read, 0U);
+    if (mappedFile.address() == nullptr)
+    {
+        return errc::bad;
+    }
+    return result<mapped_input_stream>(std::in_place_type<mapped_input_stream>,
+                                       std::move(mappedFile), streamSize);
+}
+
+auto mapped_input_stream::do_require_input(size_type const requiredSize) noexcept
+        -> result<void>
+{
+    auto const position = read_position();
+    if (mStreamSize - position < requiredSize)
+    {
+        return dp::errc::end_of_stream;
+    }
+    seek(position, requiredSize);
+    return outcome::success();
+}
+
+auto mapped_input_stream::do_discard_input(size_type const amount) noexcept
+        -> result<void>
+{
+    auto const position = read_position();
+    if (mStreamSize - position < amount)
+    {
+        return dp::errc::end_of_stream;
+    }
+    seek(position + amount, 0U);
+    return outcome::success();
+}
+
+auto mapped_input_stream::do_bulk_read(std::byte *const dest,
+                                       std::size_t const destSize) noexcept
+        -> result<void>
+{
+    auto const position = read_position();
+    if (mStreamSize - position < destSize)
+    {
+        return dp::errc::end_of_stream;
+    }
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    std::memcpy(dest, mMappedData + position, destSize);
+    seek(position + destSize, 0U);
+    return outcome::success();
+}
+
+void mapped_input_stream::seek(std::uint64_t const position,
+                               std::size_t const minSize) noexcept
+{
+    auto const areaEnd = std::min<std::uint64_t>(
+            mStreamSize, position + std::max(read_area_size, minSize));
+    if (areaEnd > mReadAreaEnd)
+    {
+        advise(mMappedData, mStreamSize, position,
+               areaEnd - position + prefetch_size, advice_willneed);
+    }
+    mReadAreaEnd = areaEnd;
+    if (mMappedData == nullptr)
+    {
+        return;
+    }
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    reset(mMappedData + position, static_cast<std::size_t>(areaEnd - position),
+          mStreamSize - position);
+}
+
+} // namespace dplx::dlog::detail
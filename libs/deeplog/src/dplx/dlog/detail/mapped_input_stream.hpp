@@ -0,0 +1,77 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <dplx/dp/streams/input_buffer.hpp>
+
+#include <dplx/dlog/disappointment.hpp>
+#include <dplx/dlog/llfio.hpp>
+
+namespace dplx::dlog::detail
+{
+
+// Reads a (closed) file through a read only mapping, i.e. the decoder works
+// directly on the mapped pages without any read syscalls or copies. The
+// mapping is advised for sequential access and the pages ahead of the read
+// area are prefetched while the stream advances.
+class mapped_input_stream final : public dp::input_buffer
+{
+    llfio::mapped_file_handle mMappedFile;
+    std::byte const *mMappedData;
+    std::uint64_t mStreamSize;
+    // the stream offset of the end of the read area
+    std::uint64_t mReadAreaEnd;
+
+public:
+    // the read area is extended in steps of read_area_size, each step
+    // prefetches the new area and the following prefetch_size bytes
+    static constexpr std::size_t read_area_size = std::size_t{1} << 20;
+    static constexpr std::size_t prefetch_size = std::size_t{4} << 20;
+
+    ~mapped_input_stream() noexcept = default;
+    explicit mapped_input_stream() noexcept
+        : input_buffer(nullptr, 0U, 0U)
+        , mMappedFile()
+        , mMappedData(nullptr)
+        , mStreamSize(0U)
+        , mReadAreaEnd(0U)
+    {
+    }
+
+    mapped_input_stream(mapped_input_stream &&) noexcept = default;
+    auto operator=(mapped_input_stream &&) noexcept
+            -> mapped_input_stream & = default;
+
+    explicit mapped_input_stream(llfio::mapped_file_handle &&mappedFile,
+                                 std::uint64_t streamSize) noexcept;
+
+    // maps the first maxSize bytes of the file, the given handle isn't
+    // retained and may be closed afterwards.
+    static auto create(llfio::file_handle const &file,
+                       std::uint64_t maxSize) noexcept
+            -> result<mapped_input_stream>;
+
+private:
+    auto do_require_input(size_type requiredSize) noexcept
+            -> result<void> override;
+    auto do_discard_input(size_type amount) noexcept -> result<void> override;
+    auto do_bulk_read(std::byte *dest, std::size_t destSize) noexcept
+            -> result<void> override;
+
+    [[nodiscard]] auto read_position() const noexcept -> std::uint64_t
+    {
+        return mReadAreaEnd - size();
+    }
+    // moves the read area to the given position
+    void seek(std::uint64_t position, std::size_t minSize) noexcept;
+};
+
+} // namespace dplx::dlog::detail
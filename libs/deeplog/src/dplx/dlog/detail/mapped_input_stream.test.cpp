@@ -0,0 +1,80 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/detail/mapped_input_stream.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_dir.hpp"
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+using dlog::detail::mapped_input_stream;
+
+TEST_CASE("mapped_input_stream reads across its read areas")
+{
+    constexpr std::size_t fileSize
+            = 3U * mapped_input_stream::read_area_size + 123U;
+    std::vector<std::byte> content(fileSize);
+    for (std::size_t i = 0U; i < content.size(); ++i)
+    {
+        content[i] = static_cast<std::byte>(i % 251U);
+    }
+    auto fileRx = llfio::file(test_dir, make_file_name(__FILE__, "bin"),
+                              llfio::file_handle::mode::write,
+                              llfio::file_handle::creation::always_new);
+    REQUIRE(fileRx);
+    auto &&file = fileRx.assume_value();
+    llfio::file_handle::const_buffer_type writeBuffers[] = {
+            {content.data(), content.size()}
+    };
+    REQUIRE(file.write({writeBuffers, 0U}));
+
+    auto createRx = mapped_input_stream::create(file, fileSize);
+    REQUIRE(createRx);
+    auto &&stream = createRx.assume_value();
+    CHECK(stream.input_size() == fileSize);
+
+    constexpr std::size_t straddling = 16U;
+    stream.discard_buffered(stream.size() - straddling / 2U);
+    REQUIRE(stream.require_input(straddling));
+    auto const offset = mapped_input_stream::read_area_size - straddling / 2U;
+    CHECK(std::equal(stream.data(), stream.data() + straddling,
+                     content.data() + offset));
+
+    std::vector<std::byte> bulk(mapped_input_stream::read_area_size + 7U);
+    REQUIRE(stream.bulk_read(bulk.data(), bulk.size()));
+    CHECK(std::equal(bulk.begin(), bulk.end(), content.data() + offset));
+
+    REQUIRE(stream.discard_input(stream.input_size() - 3U));
+    REQUIRE(stream.require_input(3U));
+    CHECK(std::equal(stream.data(), stream.data() + 3U,
+                     content.data() + fileSize - 3U));
+    CHECK(stream.require_input(4U).has_error());
+}
+
+TEST_CASE("mapped_input_stream handles empty files")
+{
+    auto fileRx = llfio::file(test_dir, make_file_name(__FILE__, "bin"),
+                              llfio::file_handle::mode::write,
+                              llfio::file_handle::creation::always_new);
+    REQUIRE(fileRx);
+
+    auto createRx = mapped_input_stream::create(
+            fileRx.assume_value(), mapped_input_stream::read_area_size);
+    REQUIRE(createRx);
+    CHECK(createRx.assume_value().input_size() == 0U);
+    CHECK(createRx.assume_value().require_input(1U).has_error());
+}
+
+} // namespace dlog_tests
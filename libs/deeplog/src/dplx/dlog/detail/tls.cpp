@@ -7,6 +7,7 @@
 
 #include "dplx/dlog/detail/tls.hpp"
 
+#include <cstdint>
 #include <type_traits>
 
 #include <dplx/dlog/core/strong_types.hpp>
@@ -29,10 +30,14 @@ static_assert(std::is_layout_compatible_v<log_context_, log_context>);
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
 thread_local constinit log_context_ active_context_{
-        disable_threshold,
+        // generation 0, see log_context::pack_threshold()
+        static_cast<std::uint32_t>(disable_threshold),
+        severity::none,
         nullptr,
         {},
         {},
+        nullptr,
+        nullptr,
 };
 
 auto active_context() noexcept -> log_context &
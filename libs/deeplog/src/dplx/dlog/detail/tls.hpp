@@ -7,7 +7,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <type_traits>
 
 #include <dplx/predef/os/windows.h>
@@ -33,10 +35,13 @@ struct most_trivial_string_view
 };
 struct log_context_
 {
-    severity mThresholdCache;
+    std::atomic<std::uint64_t> mThresholdState;
+    severity mThresholdOverride;
     log_record_port *mTargetPort;
     most_trivial_string_view mInstrumentationScope;
     span_context mCurrentSpan;
+    context_attributes const *mAttributes;
+    span_scope *mDeferredSpan;
 };
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
@@ -0,0 +1,232 @@
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+#include <dplx/cncr/utils.hpp>
+#include <dplx/dp/fwd.hpp>
+
+#include <dplx/dlog/detail/hex.hpp>
+#include <dplx/dlog/fwd.hpp>
+
+namespace dplx::dlog::detail
+{
+
+// the element types which can be logged as RFC 8746 typed arrays
+template <typename T>
+concept typed_array_element
+        = std::same_as<T, std::uint8_t> || std::same_as<T, std::uint16_t>
+          || std::same_as<T, std::uint32_t> || std::same_as<T, std::uint64_t>
+          || std::same_as<T, std::int8_t> || std::same_as<T, std::int16_t>
+          || std::same_as<T, std::int32_t> || std::same_as<T, std::int64_t>
+          || (std::same_as<T, float> && sizeof(float) == 4U
+              && std::numeric_limits<float>::is_iec559)
+          || (std::same_as<T, double> && sizeof(double) == 8U
+              && std::numeric_limits<double>::is_iec559);
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+// RFC 8746 section 2.1: 0b010_f_s_e_ll
+inline constexpr std::uint8_t typed_array_tag_base = 64U;
+inline constexpr std::uint8_t typed_array_tag_float_bit = 16U;
+inline constexpr std::uint8_t typed_array_tag_signed_bit = 8U;
+inline constexpr std::uint8_t typed_array_tag_little_endian_bit = 4U;
+
+template <typed_array_element T>
+consteval auto typed_array_tag_of() noexcept -> std::uint8_t
+{
+    constexpr bool littleEndian = std::endian::native == std::endian::little;
+    if constexpr (std::floating_point<T>)
+    {
+        return static_cast<std::uint8_t>(
+                typed_array_tag_base | typed_array_tag_float_bit
+                | (littleEndian ? typed_array_tag_little_endian_bit : 0U)
+                | (sizeof(T) == 4U ? 1U : 2U));
+    }
+    else if constexpr (sizeof(T) == 1U)
+    {
+        // the endianness bit of the single byte variants is either reserved
+        // or denotes clamped arithmetic
+        return static_cast<std::uint8_t>(
+                typed_array_tag_base
+                | (std::is_signed_v<T> ? typed_array_tag_signed_bit : 0U));
+    }
+    else
+    {
+        return static_cast<std::uint8_t>(
+                typed_array_tag_base
+                | (std::is_signed_v<T> ? typed_array_tag_signed_bit : 0U)
+                | (littleEndian ? typed_array_tag_little_endian_bit : 0U)
+                | static_cast<unsigned>(std::countr_zero(sizeof(T))));
+    }
+}
+
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+// returns the element size of the typed array tag or 0 if the tag isn't
+// supported
+auto typed_array_element_size(std::uint64_t tag) noexcept -> std::size_t;
+
+struct trivial_blob_view
+{
+    std::byte const *data;
+    std::size_t size;
+
+    trivial_blob_view() noexcept = default;
+
+    template <std::size_t Extent>
+    DPLX_ATTR_FORCE_INLINE
+    trivial_blob_view(std::span<std::byte const, Extent> blob) noexcept
+        : data(blob.data())
+        , size(blob.size())
+    {
+    }
+    template <std::size_t Extent>
+    DPLX_ATTR_FORCE_INLINE
+    trivial_blob_view(std::span<std::byte, Extent> blob) noexcept
+        : data(blob.data())
+        , size(blob.size())
+    {
+    }
+};
+struct reified_blob
+{
+    std::pmr::vector<std::byte> mBytes;
+
+    reified_blob() noexcept = default;
+};
+
+struct trivial_typed_array_view
+{
+    std::byte const *data;
+    std::size_t size;
+    std::uint8_t tag;
+
+    trivial_typed_array_view() noexcept = default;
+
+    template <typename T, std::size_t Extent>
+        requires typed_array_element<std::remove_const_t<T>>
+    DPLX_ATTR_FORCE_INLINE
+    trivial_typed_array_view(std::span<T, Extent> values) noexcept
+        : data(reinterpret_cast<std::byte const *>( // NOLINT
+                values.data()))
+        , size(values.size_bytes())
+        , tag(detail::typed_array_tag_of<std::remove_const_t<T>>())
+    {
+    }
+};
+struct reified_typed_array
+{
+    std::uint64_t mTag{};
+    std::pmr::vector<std::byte> mBytes;
+
+    reified_typed_array() noexcept = default;
+};
+
+auto format_typed_array(fmt::format_context::iterator out,
+                        reified_typed_array const &array)
+        -> fmt::format_context::iterator;
+
+} // namespace dplx::dlog::detail
+
+template <>
+struct fmt::formatter<dplx::dlog::detail::reified_blob>
+{
+    static constexpr auto parse(format_parse_context &ctx)
+            -> decltype(ctx.begin())
+    {
+        auto &&it = ctx.begin();
+        if (it != ctx.end() && *it != '}')
+        {
+            dplx::dlog::detail::throw_fmt_format_error("invalid format");
+        }
+        return it;
+    }
+
+    template <typename FormatContext>
+    static auto format(dplx::dlog::detail::reified_blob const &blob,
+                       FormatContext &ctx) -> decltype(ctx.out())
+    {
+        return dplx::dlog::detail::hex_encode(blob.mBytes.begin(),
+                                              blob.mBytes.end(), ctx.out())
+                .out;
+    }
+};
+template <>
+struct fmt::formatter<dplx::dlog::detail::reified_typed_array>
+{
+    static constexpr auto parse(format_parse_context &ctx)
+            -> decltype(ctx.begin())
+    {
+        auto &&it = ctx.begin();
+        if (it != ctx.end() && *it != '}')
+        {
+            dplx::dlog::detail::throw_fmt_format_error("invalid format");
+        }
+        return it;
+    }
+
+    static auto format(dplx::dlog::detail::reified_typed_array const &array,
+                       format_context &ctx) -> decltype(ctx.out())
+    {
+        return dplx::dlog::detail::format_typed_array(ctx.out(), array);
+    }
+};
+
+template <>
+class dplx::dp::codec<dplx::dlog::detail::reified_blob>
+{
+public:
+    static auto decode(dp::parse_context &ctx,
+                       dlog::detail::reified_blob &blob) noexcept
+            -> result<void>;
+};
+template <>
+class dplx::dp::codec<dplx::dlog::detail::trivial_blob_view>
+{
+public:
+    static auto size_of(dp::emit_context &ctx,
+                        dlog::detail::trivial_blob_view blob) noexcept
+            -> std::uint64_t;
+    static auto encode(dp::emit_context &ctx,
+                       dlog::detail::trivial_blob_view blob) noexcept
+            -> result<void>;
+};
+
+template <>
+class dplx::dp::codec<dplx::dlog::detail::reified_typed_array>
+{
+public:
+    static auto decode(dp::parse_context &ctx,
+                       dlog::detail::reified_typed_array &array) noexcept
+            -> result<void>;
+};
+template <>
+class dplx::dp::codec<dplx::dlog::detail::trivial_typed_array_view>
+{
+public:
+    static auto size_of(dp::emit_context &ctx,
+                        dlog::detail::trivial_typed_array_view array) noexcept
+            -> std::uint64_t;
+    static auto encode(dp::emit_context &ctx,
+                       dlog::detail::trivial_typed_array_view array) noexcept
+            -> result<void>;
+};
@@ -11,6 +11,8 @@ DPLX_X(string, DPLX_X_STRING, string)
 DPLX_X(system_code, dlog::detail::trivial_system_code_view, system_code)
 DPLX_X(status_code, dlog::detail::trivial_status_code_view, status_code)
 #endif
+DPLX_X(binary, dlog::detail::trivial_blob_view, binary)
+DPLX_X(typed_array, dlog::detail::trivial_typed_array_view, typed_array)
 #if DPLX_X_WITH_THUNK
 DPLX_X(thunk, erased_loggable_ref, thunk)
 #endif
@@ -28,6 +28,7 @@ enum class [[nodiscard]] errc
     missing_data,
     invalid_file_database_header,
     invalid_record_container_header,
+    invalid_record_block,
     container_unlink_failed,
     container_could_not_be_locked,
     message_bus_unlink_failed,
@@ -39,6 +40,7 @@ enum class [[nodiscard]] errc
     invalid_dmpscb_header,
     invalid_dmpscb_parameters,
     invalid_dmpscb_file_size,
+    dmpscb_control_busy,
 
     LIMIT,
 };
@@ -73,6 +75,8 @@ struct dplx::cncr::status_enum_definition<::dplx::dlog::errc>
             "The .drot file doesn't start with a valid header" },
         { code::invalid_record_container_header, generic_errc::unknown,
             "The .dlog file doesn't start with a valid header" },
+        { code::invalid_record_block, generic_errc::unknown,
+            "A compressed .dlog record block is corrupted" },
         { code::container_unlink_failed, generic_errc::unknown,
             "Failed to unlink one or more of the referenced record container(s)" },
         { code::container_could_not_be_locked, generic_errc::timed_out,
@@ -95,6 +99,8 @@ struct dplx::cncr::status_enum_definition<::dplx::dlog::errc>
             "The encoded dmpsc bus header contained invalid parameters." },
         { code::invalid_dmpscb_file_size, generic_errc::unknown,
             "The dmpbsc bus file doesn't match its header description." },
+        { code::dmpscb_control_busy, generic_errc::resource_unavailable_try_again,
+            "The dmpsc bus control block is being updated by another process." },
             // clang-format on
     };
 };
@@ -18,9 +18,12 @@ struct trace_id;
 struct span_context;
 
 class span_scope;
+class async_span_scope;
 
 class log_context;
+class context_carrier;
 class log_record_port;
+class context_attributes;
 
 namespace detail
 {
@@ -8,6 +8,7 @@
 #include "dplx/dlog/log_fabric.hpp"
 
 #include <algorithm>
+#include <mutex>
 
 namespace dplx::dlog::detail
 {
@@ -16,6 +17,32 @@ void log_fabric_base::sync_sinks() noexcept
 {
     std::partition(mSinks.begin(), mSinks.end(),
                    [](auto &sink) { return sink->try_sync(); });
+    // a failing sink becomes inactive
+    update_sink_threshold();
+}
+
+void log_fabric_base::update_sink_threshold() noexcept
+{
+    // records may also be recovered from a bus without any (active) sinks
+    // being attached in process, therefore we don't filter in this case.
+    severity next = disable_threshold;
+    bool anyActive = false;
+    for (auto const &sink : mSinks)
+    {
+        if (sink->is_active())
+        {
+            next = std::min(next, sink->threshold());
+            anyActive = true;
+        }
+    }
+    if (!anyActive)
+    {
+        next = severity::none;
+    }
+    if (mSinkThreshold.exchange(next, std::memory_order_relaxed) != next)
+    {
+        invalidate_threshold_caches();
+    }
 }
 
 auto log_fabric_base::attach_sink(std::unique_ptr<sink_frontend_base> &&sinkPtr)
@@ -23,6 +50,8 @@ auto log_fabric_base::attach_sink(std::unique_ptr<sink_frontend_base> &&sinkPtr)
 {
     auto *const ptr = sinkPtr.get();
     mSinks.push_back(std::move(sinkPtr));
+    ptr->mOwner = this;
+    update_sink_threshold();
     return ptr;
 }
 
@@ -33,6 +62,8 @@ try
 {
     auto *const ptr = sinkPtr.get();
     mSinks.push_back(std::move(sinkPtr));
+    ptr->mOwner = this;
+    update_sink_threshold();
     return ptr;
 }
 catch (std::bad_alloc const &)
@@ -54,6 +85,7 @@ auto log_fabric_base::destroy_sink(sink_frontend_base *which) noexcept
         return errc::sink_finalization_failed;
     }
     mSinks.erase(it);
+    update_sink_threshold();
     return outcome::success();
 }
 
@@ -62,6 +94,7 @@ void log_fabric_base::remove_sink(sink_frontend_base *const which) noexcept
     std::erase_if(mSinks, [which](sink_owner const &ptr) {
         return which == ptr.get();
     });
+    update_sink_threshold();
 }
 
 auto log_fabric_base::release_sink(sink_frontend_base *const which) noexcept
@@ -73,31 +106,162 @@ auto log_fabric_base::release_sink(sink_frontend_base *const which) noexcept
     {
         (void)it->release(); // returns `which`
         mSinks.erase(it);
+        which->mOwner = nullptr;
+        update_sink_threshold();
     }
     return which;
 }
 
+void log_fabric_base::adopt_sinks() noexcept
+{
+    for (auto const &sink : mSinks)
+    {
+        sink->mOwner = this;
+    }
+}
+
 void log_fabric_base::clear_sinks() noexcept
 {
     mSinks.clear();
+    update_sink_threshold();
+}
+
+log_fabric_base::log_fabric_base(severity const defaultThreshold,
+                                 scope_threshold_map thresholds)
+    : mSinks()
+    , mReconfigurationMutex()
+    , mDefaultThreshold(defaultThreshold)
+    , mThresholdRules(std::move(thresholds))
+    , mThresholdOverrides()
+    , mThresholdTables()
+    , mThresholds(nullptr)
+    , mThresholdLookups(0U)
+    , mTraceSampler()
+    , mUnsampledThreshold(detail::disable_threshold)
+    , mSinkThreshold(severity::none)
+    , mSpanHistograms()
+{
+    publish_thresholds(install_thresholds(mDefaultThreshold, mThresholdRules,
+                                          mThresholdOverrides));
+}
+
+auto log_fabric_base::reconfigure_thresholds(
+        severity const defaultThreshold,
+        scope_threshold_map thresholds) noexcept -> result<void>
+try
+{
+    std::lock_guard const lock(mReconfigurationMutex);
+    publish_thresholds(install_thresholds(defaultThreshold, thresholds,
+                                          mThresholdOverrides));
+    mDefaultThreshold = defaultThreshold;
+    swap(mThresholdRules, thresholds);
+    invalidate_threshold_caches();
+    return outcome::success();
+}
+catch (std::bad_alloc const &)
+{
+    return system_error2::errc::not_enough_memory;
+}
+
+auto log_fabric_base::reconfigure_default_threshold(
+        severity const defaultThreshold) noexcept -> result<void>
+try
+{
+    std::lock_guard const lock(mReconfigurationMutex);
+    publish_thresholds(install_thresholds(defaultThreshold, mThresholdRules,
+                                          mThresholdOverrides));
+    mDefaultThreshold = defaultThreshold;
+    invalidate_threshold_caches();
+    return outcome::success();
+}
+catch (std::bad_alloc const &)
+{
+    return system_error2::errc::not_enough_memory;
+}
+
+auto log_fabric_base::override_thresholds(
+        threshold_overrides overrides) noexcept -> result<void>
+try
+{
+    std::lock_guard const lock(mReconfigurationMutex);
+    publish_thresholds(install_thresholds(mDefaultThreshold, mThresholdRules,
+                                          overrides));
+    std::swap(mThresholdOverrides, overrides);
+    invalidate_threshold_caches();
+    return outcome::success();
+}
+catch (std::bad_alloc const &)
+{
+    return system_error2::errc::not_enough_memory;
+}
+
+auto log_fabric_base::install_thresholds(severity const defaultThreshold,
+                                         scope_threshold_map const &thresholds,
+                                         threshold_overrides const &overrides)
+        -> scope_threshold_table const *
+{
+    std::vector<scope_threshold_rule> rules;
+    rules.reserve(thresholds.size() + overrides.thresholds.size());
+    for (auto const &[scopeName, threshold] : overrides.thresholds)
+    {
+        rules.push_back({scopeName, threshold});
+    }
+    for (auto const &[scopeName, threshold] : thresholds)
+    {
+        if (!overrides.thresholds.contains(scopeName))
+        {
+            rules.push_back({scopeName, threshold});
+        }
+    }
+    mThresholdTables.reserve(mThresholdTables.size() + 1U);
+    return mThresholdTables
+            .emplace_back(std::make_unique<scope_threshold_table const>(
+                    overrides.default_threshold.value_or(defaultThreshold),
+                    rules))
+            .get();
+}
+
+void log_fabric_base::publish_thresholds(
+        scope_threshold_table const *const table) noexcept
+{
+    // both the publication and the check of the lookup counter are
+    // sequentially consistent, i.e. a lookup which hasn't been counted yet
+    // will load the new table.
+    mThresholds.store(table, std::memory_order_seq_cst);
+    if (mThresholdLookups.load(std::memory_order_seq_cst) == 0U)
+    {
+        mThresholdTables.erase(mThresholdTables.begin(),
+                               mThresholdTables.end() - 1);
+    }
 }
 
 auto log_fabric_base::do_default_threshold() const noexcept -> severity
 {
-    return mDefaultThreshold;
+    mThresholdLookups.fetch_add(1U, std::memory_order_seq_cst);
+    auto const *const table = mThresholds.load(std::memory_order_seq_cst);
+    auto const threshold
+            = table != nullptr
+                      ? std::max(table->default_threshold(),
+                                 mSinkThreshold.load(std::memory_order_relaxed))
+                      : detail::disable_threshold;
+    mThresholdLookups.fetch_sub(1U, std::memory_order_release);
+    return threshold;
 }
 
 auto log_fabric_base::do_threshold(
         char const *const scopeName,
         std::size_t const scopeNameSize) const noexcept -> severity
 {
-    if (auto const it
-        = mThresholds.find(std::string_view{scopeName, scopeNameSize});
-        it != mThresholds.end())
-    {
-        return it->second;
-    }
-    return mDefaultThreshold;
+    mThresholdLookups.fetch_add(1U, std::memory_order_seq_cst);
+    auto const *const table = mThresholds.load(std::memory_order_seq_cst);
+    auto const threshold
+            = table != nullptr
+                      ? std::max(table->resolve(std::string_view{
+                                         scopeName, scopeNameSize}),
+                                 mSinkThreshold.load(std::memory_order_relaxed))
+                      : detail::disable_threshold;
+    mThresholdLookups.fetch_sub(1U, std::memory_order_release);
+    return threshold;
 }
 
 } // namespace dplx::dlog::detail
@@ -7,8 +7,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <concepts>
 #include <cstddef>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <type_traits>
 #include <vector>
 
@@ -18,10 +23,13 @@
 
 #include <dplx/dlog/concepts.hpp>
 #include <dplx/dlog/core/log_clock.hpp>
+#include <dplx/dlog/core/scope_thresholds.hpp>
 #include <dplx/dlog/core/serialized_messages.hpp>
 #include <dplx/dlog/core/strong_types.hpp>
 #include <dplx/dlog/sinks/sink_frontend.hpp>
 #include <dplx/dlog/source/log_record_port.hpp>
+#include <dplx/dlog/source/span_histogram.hpp>
+#include <dplx/dlog/source/trace_sampler.hpp>
 
 namespace dplx::dlog::detail
 {
@@ -39,6 +47,8 @@ struct transparent_string_hash : private boost::hash<std::string_view>
 
 class log_fabric_base : public log_record_port
 {
+    friend class dlog::sink_frontend_base;
+
 public:
     using scope_threshold_map
             = boost::unordered_flat_map<std::string,
@@ -46,24 +56,44 @@ public:
                                         transparent_string_hash,
                                         std::equal_to<void>>;
 
+    // thresholds which take precedence over the configured ones, e.g. set by
+    // an operator in order to temporarily increase the verbosity
+    struct threshold_overrides
+    {
+        std::optional<severity> default_threshold;
+        scope_threshold_map thresholds;
+    };
+
 protected:
     using sink_owner = std::unique_ptr<sink_frontend_base>;
 
 private:
     std::vector<sink_owner> mSinks;
-    scope_threshold_map mThresholds;
+    // the threshold rules are compiled into an immutable table which is
+    // swapped atomically. Replaced tables are retained while lookups are in
+    // flight and released by the next reconfiguration which doesn't overlap
+    // with a lookup, i.e. at most one table per reconfiguration which races
+    // a lookup is retained.
+    std::mutex mReconfigurationMutex;
     severity mDefaultThreshold;
+    scope_threshold_map mThresholdRules;
+    threshold_overrides mThresholdOverrides;
+    std::vector<std::unique_ptr<scope_threshold_table const>> mThresholdTables;
+    std::atomic<scope_threshold_table const *> mThresholds;
+    mutable std::atomic<unsigned> mThresholdLookups;
+    std::unique_ptr<trace_sampler> mTraceSampler;
+    severity mUnsampledThreshold;
+    // the minimum threshold of the active sinks; records below it would be
+    // dropped by every sink anyway, so log_contexts never get a lower one.
+    std::atomic<severity> mSinkThreshold;
+    span_histogram_registry mSpanHistograms;
 
 protected:
     ~log_fabric_base() = default;
+    // throws std::bad_alloc
     explicit log_fabric_base(severity defaultThreshold
                              = dlog::default_threshold,
-                             scope_threshold_map thresholds = {}) noexcept
-        : mSinks()
-        , mThresholds(std::move(thresholds))
-        , mDefaultThreshold(defaultThreshold)
-    {
-    }
+                             scope_threshold_map thresholds = {});
 
 public:
     log_fabric_base(log_fabric_base const &) noexcept = delete;
@@ -73,10 +103,23 @@ protected:
     log_fabric_base(log_fabric_base &&other) noexcept
         : log_record_port(static_cast<log_record_port &&>(other))
         , mSinks(std::move(other.mSinks))
-        , mThresholds(std::move(other.mThresholds))
+        , mReconfigurationMutex()
         , mDefaultThreshold(std::exchange(other.mDefaultThreshold,
                                           dlog::default_threshold))
+        , mThresholdRules(std::move(other.mThresholdRules))
+        , mThresholdOverrides(std::move(other.mThresholdOverrides))
+        , mThresholdTables(std::move(other.mThresholdTables))
+        , mThresholds(other.mThresholds.exchange(nullptr,
+                                                 std::memory_order_relaxed))
+        , mThresholdLookups(0U)
+        , mTraceSampler(std::move(other.mTraceSampler))
+        , mUnsampledThreshold(std::exchange(other.mUnsampledThreshold,
+                                            detail::disable_threshold))
+        , mSinkThreshold(other.mSinkThreshold.exchange(
+                  severity::none, std::memory_order_relaxed))
+        , mSpanHistograms(std::move(other.mSpanHistograms))
     {
+        adopt_sinks();
     }
     auto operator=(log_fabric_base &&other) noexcept -> log_fabric_base &
     {
@@ -88,9 +131,22 @@ protected:
         // the above move slices
         // NOLINTBEGIN(bugprone-use-after-move)
         mSinks = std::move(other.mSinks);
-        mThresholds = std::move(other.mThresholds);
         mDefaultThreshold = std::exchange(other.mDefaultThreshold,
                                           dlog::default_threshold);
+        mThresholdRules = std::move(other.mThresholdRules);
+        mThresholdOverrides = std::move(other.mThresholdOverrides);
+        mThresholdTables = std::move(other.mThresholdTables);
+        mThresholds.store(
+                other.mThresholds.exchange(nullptr, std::memory_order_relaxed),
+                std::memory_order_relaxed);
+        mTraceSampler = std::move(other.mTraceSampler);
+        mUnsampledThreshold = std::exchange(other.mUnsampledThreshold,
+                                            detail::disable_threshold);
+        mSinkThreshold.store(other.mSinkThreshold.exchange(
+                                     severity::none, std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+        mSpanHistograms = std::move(other.mSpanHistograms);
+        adopt_sinks();
         // NOLINTEND(bugprone-use-after-move)
         return *this;
     }
@@ -101,6 +157,18 @@ protected:
     }
     void sync_sinks() noexcept;
 
+    // applies the trace sampler to a newly created trace
+    void sample_trace(trace_id id,
+                      std::string_view rootSpanName,
+                      severity &thresholdInOut) noexcept
+    {
+        if (mTraceSampler != nullptr
+            && !mTraceSampler->should_sample(id, rootSpanName))
+        {
+            thresholdInOut = std::max(thresholdInOut, mUnsampledThreshold);
+        }
+    }
+
 public:
     auto attach_sink(std::unique_ptr<sink_frontend_base> &&sinkPtr)
             -> sink_frontend_base *;
@@ -117,12 +185,59 @@ public:
         sync_sinks();
     }
 
+    // replaces the threshold configuration; existing log_contexts pick up the
+    // change the next time they check their threshold. The scope names may
+    // end with `.*` which applies the threshold to every scope below, see
+    // scope_threshold_rule.
+    auto reconfigure_thresholds(severity defaultThreshold,
+                                scope_threshold_map thresholds) noexcept
+            -> result<void>;
+    auto reconfigure_default_threshold(severity defaultThreshold) noexcept
+            -> result<void>;
+    // replaces the threshold overrides; an empty set of overrides restores
+    // the configured thresholds.
+    auto override_thresholds(threshold_overrides overrides) noexcept
+            -> result<void>;
+
+    // the sampler decides whether a new trace is recorded and needs to be
+    // attached before any span is created. The threshold of the spans of
+    // unsampled traces is raised to `unsampledThreshold`; by default neither
+    // their records nor the spans themselves are recorded.
+    void attach_trace_sampler(std::unique_ptr<trace_sampler> sampler,
+                              severity unsampledThreshold
+                              = detail::disable_threshold) noexcept
+    {
+        mTraceSampler = std::move(sampler);
+        mUnsampledThreshold = unsampledThreshold;
+    }
+
+    // the span duration histograms are written to the bus as summary
+    // messages every `interval`, see span_duration_scope.
+    auto span_histograms() noexcept -> span_histogram_registry &
+    {
+        return mSpanHistograms;
+    }
+    void span_histogram_interval(log_clock::duration interval) noexcept
+    {
+        mSpanHistograms.interval(interval);
+    }
+
 private:
     [[nodiscard]] auto do_default_threshold() const noexcept
             -> severity override;
     [[nodiscard]] auto do_threshold(char const *scopeName,
                                     std::size_t scopeNameSize) const noexcept
             -> severity override;
+    void update_sink_threshold() noexcept;
+    // points the sinks back to this fabric after a move
+    void adopt_sinks() noexcept;
+    auto install_thresholds(severity defaultThreshold,
+                            scope_threshold_map const &thresholds,
+                            threshold_overrides const &overrides)
+            -> scope_threshold_table const *;
+    // publishes the table and releases the replaced tables if no lookup is in
+    // flight; requires the reconfiguration mutex to be held.
+    void publish_thresholds(scope_threshold_table const *table) noexcept;
 };
 
 } // namespace dplx::dlog::detail
@@ -155,6 +270,21 @@ public:
 
         DPLX_TRY(mMessageBus.consume_messages(drain));
         sync_sinks();
+        if constexpr (requires(threshold_overrides &overrides) {
+                          {
+                              mMessageBus.poll_threshold_overrides(overrides)
+                          } noexcept -> std::same_as<bool>;
+                      })
+        {
+            if (threshold_overrides overrides;
+                mMessageBus.poll_threshold_overrides(overrides))
+            {
+                (void)override_thresholds(std::move(overrides));
+            }
+        }
+        // the summaries are consumed by the next call, the counts of a summary
+        // which couldn't be enqueued are retried with the next interval
+        DPLX_TRY(span_histograms().emit_due_summaries(*this));
         return outcome::success();
     }
     template <sink Sink>
@@ -187,7 +317,14 @@ private:
                                 severity &thresholdInOut) noexcept
             -> span_context override
     {
-        return mMessageBus.create_span_context(id, name, thresholdInOut);
+        bool const startsTrace = id == trace_id::invalid();
+        auto const spanContext
+                = mMessageBus.create_span_context(id, name, thresholdInOut);
+        if (startsTrace)
+        {
+            sample_trace(spanContext.traceId, name, thresholdInOut);
+        }
+        return spanContext;
     }
 };
 
@@ -7,8 +7,18 @@
 
 #include "dplx/dlog/log_fabric.hpp"
 
+#include <cstddef>
+#include <memory>
+#include <span>
+
+#include <catch2/catch_test_macros.hpp>
+
 #include <dplx/dlog/bus/mpsc_bus.hpp>
+#include <dplx/dlog/source/log_context.hpp>
+#include <dplx/dlog/source/span_scope.hpp>
+#include <dplx/dlog/source/trace_sampler.hpp>
 
+#include "test_dir.hpp"
 #include "test_utils.hpp"
 
 namespace dlog_tests
@@ -16,4 +26,168 @@ namespace dlog_tests
 
 static_assert(makable<dlog::log_fabric<dlog::mpsc_bus_handle>>);
 
+namespace
+{
+
+class null_sink final : public dlog::sink_frontend_base
+{
+public:
+    explicit null_sink(dlog::severity threshold) noexcept
+        : sink_frontend_base(threshold)
+    {
+    }
+
+private:
+    auto do_consume(std::size_t,
+                    std::span<dlog::serialized_message_info const>) noexcept
+            -> result<void> override
+    {
+        return outcome::success();
+    }
+};
+
+class failing_sink final : public dlog::sink_frontend_base
+{
+public:
+    bool failing{true};
+
+    explicit failing_sink(dlog::severity threshold) noexcept
+        : sink_frontend_base(threshold)
+    {
+    }
+
+private:
+    auto do_consume(std::size_t,
+                    std::span<dlog::serialized_message_info const>) noexcept
+            -> result<void> override
+    {
+        return outcome::success();
+    }
+    auto do_sync() noexcept -> result<void> override
+    {
+        if (failing)
+        {
+            return dlog::errc::bad;
+        }
+        return outcome::success();
+    }
+};
+
+} // namespace
+
+TEST_CASE("log_contexts pick up threshold reconfigurations")
+{
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "log_fabric.dmsb", 4U, regionSize)
+                    .value(),
+            dlog::severity::info};
+    dlog::log_context ctx{core, "dlog.tests"};
+    dlog::log_context defaultCtx{core};
+    REQUIRE(ctx.threshold() == dlog::severity::info);
+
+    decltype(core)::scope_threshold_map thresholds;
+    thresholds.emplace("dlog.tests", dlog::severity::debug);
+    REQUIRE(core.reconfigure_thresholds(dlog::severity::warn,
+                                        std::move(thresholds)));
+    CHECK(ctx.threshold() == dlog::severity::debug);
+    CHECK(defaultCtx.threshold() == dlog::severity::warn);
+
+    REQUIRE(core.reconfigure_default_threshold(dlog::severity::error));
+    CHECK(ctx.threshold() == dlog::severity::debug);
+    CHECK(defaultCtx.threshold() == dlog::severity::error);
+}
+
+TEST_CASE("span threshold overrides survive threshold reconfigurations")
+{
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "log_fabric4.dmsb", 4U, regionSize)
+                    .value(),
+            dlog::severity::info};
+    core.attach_trace_sampler(std::make_unique<dlog::ratio_sampler>(0.0),
+                              dlog::severity::error);
+    dlog::log_context ctx{core};
+
+    {
+        auto span = dlog::span_scope::open(ctx, "span");
+        REQUIRE(ctx.threshold() == dlog::severity::error);
+
+        REQUIRE(core.reconfigure_default_threshold(dlog::severity::debug));
+        CHECK(ctx.threshold() == dlog::severity::error);
+
+        REQUIRE(core.reconfigure_default_threshold(dlog::severity::fatal));
+        CHECK(ctx.threshold() == dlog::severity::fatal);
+
+        REQUIRE(core.reconfigure_default_threshold(dlog::severity::debug));
+    }
+    CHECK(ctx.threshold() == dlog::severity::debug);
+}
+
+TEST_CASE("log_contexts resolve wildcard scope thresholds")
+{
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric<dlog::mpsc_bus_handle>::scope_threshold_map thresholds;
+    thresholds.emplace("dlog.*", dlog::severity::debug);
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "log_fabric2.dmsb", 4U, regionSize)
+                    .value(),
+            dlog::severity::warn, std::move(thresholds)};
+
+    dlog::log_context ctx{core, "dlog.tests"};
+    dlog::log_context otherCtx{core, "dlogx"};
+    CHECK(ctx.threshold() == dlog::severity::debug);
+    CHECK(otherCtx.threshold() == dlog::severity::warn);
+}
+
+TEST_CASE("log_contexts are clamped to the minimum sink threshold")
+{
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "log_fabric3.dmsb", 4U, regionSize)
+                    .value(),
+            dlog::severity::debug};
+    dlog::log_context ctx{core};
+    CHECK(ctx.threshold() == dlog::severity::debug);
+
+    auto *const errorSink
+            = core.attach_sink(std::make_unique<null_sink>(dlog::severity::error));
+    CHECK(ctx.threshold() == dlog::severity::error);
+
+    auto *const infoSink
+            = core.attach_sink(std::make_unique<null_sink>(dlog::severity::info));
+    CHECK(ctx.threshold() == dlog::severity::info);
+
+    core.remove_sink(infoSink);
+    CHECK(ctx.threshold() == dlog::severity::error);
+
+    core.remove_sink(errorSink);
+    CHECK(ctx.threshold() == dlog::severity::debug);
+}
+
+TEST_CASE("failed sinks don't clamp the log_context thresholds")
+{
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "log_fabric5.dmsb", 4U, regionSize)
+                    .value(),
+            dlog::severity::debug};
+    dlog::log_context ctx{core};
+
+    auto sinkOwner = std::make_unique<failing_sink>(dlog::severity::error);
+    auto *const sink = sinkOwner.get();
+    (void)core.attach_sink(std::move(sinkOwner));
+    CHECK(ctx.threshold() == dlog::severity::error);
+
+    // the sync fails which deactivates the sink
+    REQUIRE(core.retire_log_records());
+    REQUIRE(!sink->is_active());
+    CHECK(ctx.threshold() == dlog::severity::debug);
+
+    sink->failing = false;
+    sink->clear_last_status();
+    CHECK(sink->is_active());
+    CHECK(ctx.threshold() == dlog::severity::error);
 }
+
+} // namespace dlog_tests
@@ -7,7 +7,9 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <string_view>
 #include <type_traits>
 
@@ -20,6 +22,7 @@
 #include <dplx/dp/fwd.hpp>
 
 #include <dplx/dlog/detail/system_error2_fmt.hpp>
+#include <dplx/dlog/detail/typed_array_fmt.hpp>
 
 namespace dplx::dlog
 {
@@ -125,6 +128,16 @@ struct reification_tag<detail::reified_system_code>
     : reification_type_constant<reification_type_id::system_code>
 {
 };
+template <>
+struct reification_tag<detail::reified_blob>
+    : reification_type_constant<reification_type_id::binary>
+{
+};
+template <>
+struct reification_tag<detail::reified_typed_array>
+    : reification_type_constant<reification_type_id::typed_array>
+{
+};
 
 } // namespace dplx::dlog
 
@@ -182,6 +195,23 @@ struct remap_c_string<T>
     using type = detail::trivial_status_code_view;
 };
 
+template <std::size_t Extent>
+struct remap_c_string<std::span<std::byte, Extent>>
+{
+    using type = detail::trivial_blob_view;
+};
+template <std::size_t Extent>
+struct remap_c_string<std::span<std::byte const, Extent>>
+{
+    using type = detail::trivial_blob_view;
+};
+template <typename T, std::size_t Extent>
+    requires typed_array_element<std::remove_const_t<T>>
+struct remap_c_string<std::span<T, Extent>>
+{
+    using type = detail::trivial_typed_array_view;
+};
+
 template <typename T>
 using remap_c_string_t = typename remap_c_string<T>::type;
 
@@ -229,6 +259,23 @@ struct reification_type_of<T>
 {
     using type = detail::reified_status_code;
 };
+
+template <std::size_t Extent>
+struct reification_type_of<std::span<std::byte, Extent>>
+{
+    using type = detail::reified_blob;
+};
+template <std::size_t Extent>
+struct reification_type_of<std::span<std::byte const, Extent>>
+{
+    using type = detail::reified_blob;
+};
+template <typename T, std::size_t Extent>
+    requires detail::typed_array_element<std::remove_const_t<T>>
+struct reification_type_of<std::span<T, Extent>>
+{
+    using type = detail::reified_typed_array;
+};
 template <>
 struct reification_type_of<system_error::system_code>
 {
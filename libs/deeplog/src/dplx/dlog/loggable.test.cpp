@@ -7,8 +7,14 @@
 
 #include "dplx/dlog/loggable.hpp"
 
+#include <bit>
+#include <cstring>
+#include <span>
+
 #include <catch2/catch_test_macros.hpp>
 
+#include <fmt/format.h>
+
 #include <dplx/dp/api.hpp>
 #include <dplx/dp/codecs/core.hpp>
 
@@ -30,8 +36,59 @@ static_assert(dlog::detail::effective_reification_tag_v<std::int64_t>
 static_assert(dlog::detail::effective_reification_tag_v<int>
               == dlog::reification_type_id::int64);
 
+static_assert(dlog::loggable<std::span<std::byte const>>);
+static_assert(dlog::loggable<std::span<float const>>);
+static_assert(dlog::loggable<std::span<std::uint16_t, 4>>);
+static_assert(dlog::detail::effective_reification_tag_v<std::span<std::byte>>
+              == dlog::reification_type_id::binary);
+static_assert(
+        dlog::detail::effective_reification_tag_v<std::span<double const>>
+        == dlog::reification_type_id::typed_array);
+
 static_assert(dlog::reifiable<std::int64_t>);
 static_assert(!dlog::reifiable<int>);
 static_assert(!dlog::reifiable<system_error::status_code_domain::string_ref>);
+static_assert(dlog::reifiable<dlog::detail::reified_blob>);
+static_assert(dlog::reifiable<dlog::detail::reified_typed_array>);
+
+static_assert(dlog::detail::typed_array_tag_of<std::uint8_t>() == 64U);
+static_assert(dlog::detail::typed_array_tag_of<std::int8_t>() == 72U);
+static_assert(std::endian::native != std::endian::little
+              || (dlog::detail::typed_array_tag_of<std::uint16_t>() == 69U
+                  && dlog::detail::typed_array_tag_of<std::int64_t>() == 79U
+                  && dlog::detail::typed_array_tag_of<float>() == 85U
+                  && dlog::detail::typed_array_tag_of<double>() == 86U));
+
+TEST_CASE("typed_array_element_size decodes RFC 8746 tags")
+{
+    CHECK(dlog::detail::typed_array_element_size(63U) == 0U);
+    CHECK(dlog::detail::typed_array_element_size(64U) == 1U);
+    CHECK(dlog::detail::typed_array_element_size(69U) == 2U);
+    CHECK(dlog::detail::typed_array_element_size(76U) == 0U);
+    CHECK(dlog::detail::typed_array_element_size(79U) == 8U);
+    CHECK(dlog::detail::typed_array_element_size(80U) == 0U);
+    CHECK(dlog::detail::typed_array_element_size(85U) == 4U);
+    CHECK(dlog::detail::typed_array_element_size(86U) == 8U);
+    CHECK(dlog::detail::typed_array_element_size(88U) == 0U);
+}
+
+TEST_CASE("reified typed arrays are formatted as lists")
+{
+    std::uint16_t const values[] = {1U, 2U, 0xffffU};
+    dlog::detail::reified_typed_array array;
+    array.mTag = dlog::detail::typed_array_tag_of<std::uint16_t>();
+    array.mBytes.resize(sizeof(values));
+    std::memcpy(array.mBytes.data(), &values, sizeof(values));
+
+    CHECK(fmt::format("{}", array) == "[1, 2, 65535]");
+}
+
+TEST_CASE("reified blobs are formatted as hex")
+{
+    dlog::detail::reified_blob blob;
+    blob.mBytes = {std::byte{0xde}, std::byte{0xad}, std::byte{0x01}};
+
+    CHECK(fmt::format("{}", blob) == "dead01");
+}
 
 } // namespace dlog_tests
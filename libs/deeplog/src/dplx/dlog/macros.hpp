@@ -13,6 +13,7 @@
 #include <dplx/dlog/config.hpp>
 #include <dplx/dlog/source/log.hpp>
 #include <dplx/dlog/source/log_context.hpp>
+#include <dplx/dlog/source/rate_limiter.hpp>
 
 // NOLINTBEGIN(cppcoreguidelines-macro-usage)
 
@@ -52,6 +53,62 @@
             (::dplx::dlog::severity::severityName), message, __VA_ARGS__)
 #endif
 
+#define DLOG_LIMITED_TO(ctx, limiter, severity, message, ...)                  \
+    do                                                                         \
+    {                                                                          \
+        if (auto &&_dlog_materialized_temporary_ = (ctx);                      \
+            (severity) >= _dlog_materialized_temporary_.threshold())           \
+        {                                                                      \
+            if (auto const _dlog_admission_ = (limiter).try_acquire();         \
+                _dlog_admission_.allowed)                                      \
+            {                                                                  \
+                if (_dlog_admission_.suppressed != 0U) [[unlikely]]            \
+                    (void)::dplx::dlog::detail::log_suppressed(                \
+                            _dlog_materialized_temporary_, (severity),         \
+                            DPLX_DLOG_LOCATION, _dlog_admission_.suppressed);  \
+                (void)::dplx::dlog::log(_dlog_materialized_temporary_,         \
+                                        (severity), (message),                 \
+                                        DPLX_DLOG_LOCATION, __VA_ARGS__);      \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+    while (0)
+
+#define DLOG_RATE_LIMITED_TO(ctx, maxBurst, refillPeriod, severity, message,   \
+                             ...)                                              \
+    do                                                                         \
+    {                                                                          \
+        static_assert(::dplx::dlog::token_bucket_limiter::valid_configuration( \
+                              (maxBurst), (refillPeriod)),                     \
+                      "the refill period must span at least maxBurst ticks");  \
+        static ::dplx::dlog::token_bucket_limiter _dlog_call_site_limiter_{    \
+                (maxBurst), (refillPeriod)};                                   \
+        DLOG_LIMITED_TO(ctx, _dlog_call_site_limiter_, severity, message,      \
+                        __VA_ARGS__);                                          \
+    }                                                                          \
+    while (0)
+
+#define DLOG_SAMPLED_TO(ctx, oneIn, severity, message, ...)                    \
+    do                                                                         \
+    {                                                                          \
+        static ::dplx::dlog::sampling_limiter _dlog_call_site_limiter_{        \
+                (oneIn)};                                                      \
+        DLOG_LIMITED_TO(ctx, _dlog_call_site_limiter_, severity, message,      \
+                        __VA_ARGS__);                                          \
+    }                                                                          \
+    while (0)
+
+#if !DPLX_DLOG_DISABLE_IMPLICIT_CONTEXT
+#define DLOG_RATE_LIMITED_(maxBurst, refillPeriod, severityName, message, ...) \
+    DLOG_RATE_LIMITED_TO(::dplx::dlog::detail::active_context(), maxBurst,     \
+                         refillPeriod, (::dplx::dlog::severity::severityName), \
+                         message, __VA_ARGS__)
+#define DLOG_SAMPLED_(oneIn, severityName, message, ...)                       \
+    DLOG_SAMPLED_TO(::dplx::dlog::detail::active_context(), oneIn,             \
+                    (::dplx::dlog::severity::severityName), message,           \
+                    __VA_ARGS__)
+#endif
+
 #else // _MSVC_TRADITIONAL
 
 #define DLOG_TO(ctx, severity, message, ...)                                   \
@@ -72,6 +129,62 @@
             message __VA_OPT__(, __VA_ARGS__))
 #endif
 
+#define DLOG_LIMITED_TO(ctx, limiter, severity, message, ...)                  \
+    do                                                                         \
+    {                                                                          \
+        if (auto &&_dlog_materialized_temporary_ = (ctx);                      \
+            (severity) >= _dlog_materialized_temporary_.threshold())           \
+        {                                                                      \
+            if (auto const _dlog_admission_ = (limiter).try_acquire();         \
+                _dlog_admission_.allowed)                                      \
+            {                                                                  \
+                if (_dlog_admission_.suppressed != 0U) [[unlikely]]            \
+                    (void)::dplx::dlog::detail::log_suppressed(                \
+                            _dlog_materialized_temporary_, (severity),         \
+                            DPLX_DLOG_LOCATION, _dlog_admission_.suppressed);  \
+                (void)::dplx::dlog::log(                                       \
+                        _dlog_materialized_temporary_, (severity), (message),  \
+                        DPLX_DLOG_LOCATION __VA_OPT__(, __VA_ARGS__));         \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+    while (0)
+
+#define DLOG_RATE_LIMITED_TO(ctx, maxBurst, refillPeriod, severity, message,   \
+                             ...)                                              \
+    do                                                                         \
+    { /* each expansion gets its own limiter */                                \
+        static_assert(::dplx::dlog::token_bucket_limiter::valid_configuration( \
+                              (maxBurst), (refillPeriod)),                     \
+                      "the refill period must span at least maxBurst ticks");  \
+        static ::dplx::dlog::token_bucket_limiter _dlog_call_site_limiter_{    \
+                (maxBurst), (refillPeriod)};                                   \
+        DLOG_LIMITED_TO(ctx, _dlog_call_site_limiter_, severity,               \
+                        message __VA_OPT__(, __VA_ARGS__));                    \
+    }                                                                          \
+    while (0)
+
+#define DLOG_SAMPLED_TO(ctx, oneIn, severity, message, ...)                    \
+    do                                                                         \
+    { /* each expansion gets its own limiter */                                \
+        static ::dplx::dlog::sampling_limiter _dlog_call_site_limiter_{        \
+                (oneIn)};                                                      \
+        DLOG_LIMITED_TO(ctx, _dlog_call_site_limiter_, severity,               \
+                        message __VA_OPT__(, __VA_ARGS__));                    \
+    }                                                                          \
+    while (0)
+
+#if !DPLX_DLOG_DISABLE_IMPLICIT_CONTEXT
+#define DLOG_RATE_LIMITED_(maxBurst, refillPeriod, severityName, message, ...) \
+    DLOG_RATE_LIMITED_TO(::dplx::dlog::detail::active_context(), maxBurst,     \
+                         refillPeriod, (::dplx::dlog::severity::severityName), \
+                         message __VA_OPT__(, __VA_ARGS__))
+#define DLOG_SAMPLED_(oneIn, severityName, message, ...)                       \
+    DLOG_SAMPLED_TO(::dplx::dlog::detail::active_context(), oneIn,             \
+                    (::dplx::dlog::severity::severityName),                    \
+                    message __VA_OPT__(, __VA_ARGS__))
+#endif
+
 #endif // _MSVC_TRADITIONAL
 
 // NOLINTEND(cppcoreguidelines-macro-usage)
@@ -7,6 +7,13 @@
 
 #include "dplx/dlog/record_container.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+
 #include <dplx/dp.hpp>
 #include <dplx/dp/codecs/auto_object.hpp>
 #include <dplx/dp/codecs/core.hpp>
@@ -14,3 +21,251 @@
 #include <dplx/dlog/detail/utils.hpp>
 
 DPLX_DLOG_DEFINE_AUTO_OBJECT_CODEC(::dplx::dlog::record_resource)
+
+namespace dplx::dlog
+{
+
+namespace
+{
+
+auto read_exactly(llfio::file_handle &file,
+                  std::uint64_t offset,
+                  writable_bytes out) noexcept -> result<void>
+{
+    while (!out.empty())
+    {
+        llfio::file_handle::buffer_type ioBuffers[] = {
+                {out.data(), out.size()}
+        };
+        DPLX_TRY(auto const readBuffers, file.read({ioBuffers, offset}));
+        std::size_t numRead = 0U;
+        for (auto const buffer : readBuffers)
+        {
+            auto const dest = out.subspan(numRead);
+            if (buffer.data() != dest.data())
+            {
+                std::memmove(dest.data(), buffer.data(), buffer.size());
+            }
+            numRead += buffer.size();
+        }
+        if (numRead == 0U)
+        {
+            return errc::missing_data;
+        }
+        out = out.subspan(numRead);
+        offset += numRead;
+    }
+    return outcome::success();
+}
+
+} // namespace
+
+auto read_record_block_index(llfio::file_handle &container) noexcept
+        -> result<std::vector<record_block_info>>
+try
+{
+    constexpr auto trailerSize = file_sink_backend::block_index_trailer_size;
+    std::vector<record_block_info> index;
+
+    DPLX_TRY(auto const containerSize, container.maximum_extent());
+    if (containerSize < std::size(file_sink_backend::magic) + trailerSize)
+    {
+        return index;
+    }
+    std::array<std::byte, trailerSize> trailer{};
+    DPLX_TRY(read_exactly(container, containerSize - trailerSize, trailer));
+    if (trailer[0] != std::byte{0x1b})
+    {
+        return index;
+    }
+    std::uint64_t indexOffset = 0U;
+    for (std::size_t i = 1U; i < trailer.size(); ++i)
+    {
+        indexOffset = (indexOffset << 8U) | std::to_integer<unsigned>(trailer[i]);
+    }
+    if (indexOffset < std::size(file_sink_backend::magic)
+        || indexOffset >= containerSize - trailerSize)
+    {
+        return index;
+    }
+
+    std::vector<std::byte> encodedIndex(
+            static_cast<std::size_t>(containerSize - trailerSize - indexOffset));
+    DPLX_TRY(read_exactly(container, indexOffset, encodedIndex));
+    dp::memory_input_stream indexStream(encodedIndex);
+    dp::parse_context ctx{indexStream};
+
+    // a container without an index which happens to end like a trailer
+    // doesn't point to the tagged index
+    if (auto tagRx = dp::parse_item_head(ctx);
+        tagRx.has_error() || tagRx.assume_value().type != dp::type_code::tag
+        || tagRx.assume_value().value != file_sink_backend::block_index_tag)
+    {
+        return index;
+    }
+    DPLX_TRY(dp::item_head const indexHead, dp::parse_item_head(ctx));
+    if (indexHead.type != dp::type_code::array || indexHead.indefinite()
+        || indexHead.value > ctx.in.input_size()
+                                     / detail::min_encoded_record_block_info_size)
+    {
+        return errc::invalid_record_block;
+    }
+    index.reserve(static_cast<std::size_t>(indexHead.value));
+    for (std::uint64_t i = 0U; i < indexHead.value; ++i)
+    {
+        DPLX_TRY(auto const block, detail::decode_record_block_info(ctx));
+        index.push_back(block);
+    }
+    prepare_record_block_index(index);
+    return index;
+}
+catch (std::bad_alloc const &)
+{
+    return errc::not_enough_memory;
+}
+
+void prepare_record_block_index(
+        std::span<record_block_info> const index) noexcept
+{
+    // a stable sort keeps the empty blocks after their predecessors
+    std::ranges::stable_sort(index, std::ranges::less{},
+                             &record_block_info::first_timestamp);
+    log_clock::time_point latest = log_clock::time_point::min();
+    for (auto &block : index)
+    {
+        latest = std::max(latest, block.last_timestamp);
+        block.latest_timestamp = latest;
+    }
+}
+
+auto find_record_blocks(std::span<record_block_info const> const index,
+                        log_clock::time_point const from,
+                        log_clock::time_point const to) noexcept
+        -> std::span<record_block_info const>
+{
+    // every block before `first` ends before `from` and every block after
+    // `last` starts after `to`
+    auto first = std::ranges::partition_point(
+            index,
+            [from](log_clock::time_point const latest) {
+                return latest < from;
+            },
+            &record_block_info::latest_timestamp);
+    auto last = std::ranges::partition_point(
+            first, index.end(),
+            [to](log_clock::time_point const firstTimestamp) {
+                return firstTimestamp <= to;
+            },
+            &record_block_info::first_timestamp);
+
+    // empty blocks only inherit a timestamp
+    auto const overlaps = [from, to](record_block_info const &block) {
+        return block.num_records > 0U && block.first_timestamp <= to
+               && from <= block.last_timestamp;
+    };
+    while (first != last && !overlaps(*first))
+    {
+        ++first;
+    }
+    while (first != last && !overlaps(*std::prev(last)))
+    {
+        --last;
+    }
+    return {first, last};
+}
+
+auto read_record_block(llfio::file_handle &container,
+                       record_block_info const &block) noexcept
+        -> result<std::vector<std::byte>>
+try
+{
+    DPLX_TRY(auto const containerSize, container.maximum_extent());
+    if (block.offset > containerSize || block.size > containerSize - block.offset
+        || block.raw_size > detail::max_record_block_raw_size)
+    {
+        return errc::invalid_record_block;
+    }
+    std::vector<std::byte> frame(static_cast<std::size_t>(block.size));
+    DPLX_TRY(read_exactly(container, block.offset, frame));
+
+    constexpr unsigned majorTypeMask = 0b111'00000U;
+    if (frame.empty()
+        || (std::to_integer<unsigned>(frame.front()) & majorTypeMask)
+                   != static_cast<unsigned>(dp::type_code::tag))
+    {
+        // the records of an uncompressed block are stored as is
+        return frame;
+    }
+    dp::memory_input_stream frameStream(frame);
+    dp::parse_context ctx{frameStream};
+    DPLX_TRY(dp::item_head const tagHead, dp::parse_item_head(ctx));
+    if (tagHead.type != dp::type_code::tag
+        || tagHead.value != file_sink_backend::block_frame_tag)
+    {
+        return errc::invalid_record_block;
+    }
+    return detail::decode_record_block(ctx, block.raw_size);
+}
+catch (std::bad_alloc const &)
+{
+    return errc::not_enough_memory;
+}
+
+} // namespace dplx::dlog
+
+namespace dplx::dlog::detail
+{
+
+auto decode_record_block_info(dp::parse_context &ctx) noexcept
+        -> result<record_block_info>
+{
+    using timestamp_rep = log_clock::rep;
+    DPLX_TRY(dp::expect_item_head(ctx, dp::type_code::array, 6U));
+    DPLX_TRY(auto const offset, dp::decode(dp::as_value<std::uint64_t>, ctx));
+    DPLX_TRY(auto const size, dp::decode(dp::as_value<std::uint64_t>, ctx));
+    DPLX_TRY(auto const rawSize, dp::decode(dp::as_value<std::uint64_t>, ctx));
+    DPLX_TRY(auto const first, dp::decode(dp::as_value<timestamp_rep>, ctx));
+    DPLX_TRY(auto const last, dp::decode(dp::as_value<timestamp_rep>, ctx));
+    DPLX_TRY(auto const numRecords,
+             dp::decode(dp::as_value<std::uint64_t>, ctx));
+    return record_block_info{
+            .offset = offset,
+            .size = size,
+            .raw_size = rawSize,
+            .first_timestamp = log_clock::time_point(log_clock::duration(first)),
+            .last_timestamp = log_clock::time_point(log_clock::duration(last)),
+            .num_records = numRecords,
+    };
+}
+
+auto decode_record_block(dp::parse_context &ctx,
+                         std::uint64_t const maxRawSize) noexcept
+        -> result<std::vector<std::byte>>
+try
+{
+    DPLX_TRY(dp::expect_item_head(ctx, dp::type_code::array, 3U));
+    DPLX_TRY(auto const codec, dp::decode(dp::as_value<std::uint8_t>, ctx));
+    DPLX_TRY(auto const rawSize, dp::decode(dp::as_value<std::uint64_t>, ctx));
+    if (rawSize > maxRawSize)
+    {
+        return errc::invalid_record_block;
+    }
+    std::vector<std::byte> compressed;
+    DPLX_TRY(dp::parse_binary(ctx, compressed));
+
+    std::vector<std::byte> block(static_cast<std::size_t>(rawSize));
+    DPLX_TRY(auto const decompressedSize,
+             decompress_block(static_cast<block_codec>(codec), compressed,
+                              block));
+    if (decompressedSize != block.size())
+    {
+        return errc::invalid_record_block;
+    }
+    return block;
+}
+catch (std::bad_alloc const &)
+{
+    return errc::not_enough_memory;
+}
+
+} // namespace dplx::dlog::detail
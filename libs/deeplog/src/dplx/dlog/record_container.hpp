@@ -7,10 +7,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <memory_resource>
+#include <span>
 #include <string_view>
+#include <vector>
 
 #include <fmt/core.h>
 #include <fmt/format.h>
@@ -22,15 +25,19 @@
 #include <dplx/dp/codecs/core.hpp>
 #include <dplx/dp/codecs/std-string.hpp>
 #include <dplx/dp/items/parse_core.hpp>
+#include <dplx/dp/items/parse_ranges.hpp>
 #include <dplx/dp/items/skip_item.hpp>
 #include <dplx/dp/macros.hpp>
+#include <dplx/dp/streams/memory_input_stream.hpp>
 
 #include <dplx/dlog/argument_transmorpher_fmt.hpp>
 #include <dplx/dlog/attribute_transmorpher.hpp>
 #include <dplx/dlog/attributes.hpp>
+#include <dplx/dlog/block_codec.hpp>
 #include <dplx/dlog/core/log_clock.hpp>
 #include <dplx/dlog/core/strong_types.hpp>
 #include <dplx/dlog/sinks/file_sink.hpp>
+#include <dplx/dlog/source/span_histogram.hpp>
 
 namespace dplx::dlog
 {
@@ -72,11 +79,16 @@ public:
         // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
         // TODO: refactor record layout description into compile time constants
         if (tupleHead.indefinite()
-            || (tupleHead.value != 2 && tupleHead.value != 6
-                && tupleHead.value != 7))
+            || (tupleHead.value != 2 && tupleHead.value != 5
+                && tupleHead.value != 6 && tupleHead.value != 7
+                && tupleHead.value != 8))
         {
             return dp::errc::tuple_size_mismatch;
         }
+        if (tupleHead.value == 5)
+        {
+            return decode_span_histogram(ctx, value);
+        }
 
         if (tupleHead.value != 6)
         {
@@ -113,6 +125,36 @@ public:
     }
 
 private:
+    // span histogram summaries are displayed as an info record
+    static auto decode_span_histogram(parse_context &ctx, dlog::record &value)
+            -> result<void>
+    {
+        dlog::span_histogram_summary summary;
+        DPLX_TRY(dlog::detail::decode_span_histogram_properties(ctx, summary));
+
+        // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+        auto const toMicroseconds = [](dlog::log_clock::duration d) {
+            return static_cast<double>(d.count()) / 1000.0;
+        };
+        auto const count = summary.count();
+        auto const mean
+                = count == 0U ? 0.0
+                              : static_cast<double>(summary.sum)
+                                        / static_cast<double>(count) / 1000.0;
+        value.severity = dlog::severity::info;
+        value.instrumentationScope = "span_histogram";
+        value.timestamp = summary.end.time_since_epoch().count();
+        value.message = fmt::format(
+                "{}: n={} mean={:.1f}us p50={:.1f}us p90={:.1f}us "
+                "p99={:.1f}us p100={:.1f}us",
+                summary.name, count, mean,
+                toMicroseconds(summary.quantile(0.5)),
+                toMicroseconds(summary.quantile(0.9)),
+                toMicroseconds(summary.quantile(0.99)),
+                toMicroseconds(summary.quantile(1.0)));
+        // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+        return outcome::success();
+    }
 };
 
 } // namespace dplx::dp
@@ -140,6 +182,58 @@ public:
     std::pmr::vector<record> records;
 };
 
+// reads and prepares the block index from the footer of a record container,
+// the index of a container which hasn't been finalized (or predates the index)
+// is empty.
+auto read_record_block_index(llfio::file_handle &container) noexcept
+        -> result<std::vector<record_block_info>>;
+
+// sorts the index by first_timestamp and fills in the latest_timestamp
+// running maximum, read_record_block_index() returns a prepared index. The
+// blocks are roughly sorted by time, but records may be handed over out of
+// order (e.g. by recovered message buses).
+void prepare_record_block_index(std::span<record_block_info> index) noexcept;
+
+// returns the smallest range of blocks which contains every block with
+// records logged within [from, to] by bisecting a prepared index, the range
+// can contain blocks which don't overlap if blocks are out of order.
+auto find_record_blocks(std::span<record_block_info const> index,
+                        log_clock::time_point from,
+                        log_clock::time_point to) noexcept
+        -> std::span<record_block_info const>;
+
+// reads (and decompresses) a single block of a record container, i.e. the
+// blocks can be processed independently of each other. The result is a
+// sequence of serialized records which can be decoded with
+// basic_decoder<record_container>::decode_block().
+auto read_record_block(llfio::file_handle &container,
+                       record_block_info const &block) noexcept
+        -> result<std::vector<std::byte>>;
+
+namespace detail
+{
+
+// the smallest encoding of a record_block_info, i.e. an array head and six
+// single byte integers
+inline constexpr std::size_t min_encoded_record_block_info_size = 7U;
+// blocks which claim a larger raw size are considered to be corrupt
+inline constexpr std::uint64_t max_record_block_raw_size = std::uint64_t{1}
+                                                           << 30;
+
+// parses an encoded record_block_info
+auto decode_record_block_info(dp::parse_context &ctx) noexcept
+        -> result<record_block_info>;
+
+// parses a [codec, raw size, compressed records] block frame (sans tag) and
+// returns the decompressed records. Fails with errc::invalid_record_block if
+// the raw size exceeds maxRawSize.
+auto decode_record_block(dp::parse_context &ctx,
+                         std::uint64_t maxRawSize
+                         = max_record_block_raw_size) noexcept
+        -> result<std::vector<std::byte>>;
+
+} // namespace detail
+
 } // namespace dplx::dlog
 
 DPLX_DP_DECLARE_CODEC_SIMPLE(::dplx::dlog::record_resource);
@@ -173,6 +267,14 @@ public:
             ctx.in.discard_buffered(magic.size());
         }
 
+        if (auto *attributeTypeRegistry
+            = ctx.states.try_access(dlog::attribute_type_registry_state);
+            attributeTypeRegistry != nullptr)
+        {
+            // compressed containers announce their codec as an attribute
+            DPLX_TRY(attributeTypeRegistry
+                             ->insert<dlog::attr::container_codec>());
+        }
         DPLX_TRY(dp::decode(ctx, value.info));
 
         DPLX_TRY(dp::parse_array(ctx, value.records,
@@ -187,8 +289,67 @@ public:
         return outcome::success();
     }
 
+    // decodes the records of a single block as returned by
+    // read_record_block(), i.e. decoding can start in the middle of a
+    // container. The registry must know the attributes of the container.
+    auto decode_block(dlog::bytes const block,
+                      dlog::attribute_type_registry const *registry,
+                      container &records) -> result<void>
+    {
+        dp::memory_input_stream blockStream(block);
+        dp::parse_context blockCtx{blockStream};
+        dp::scoped_state attributeTypeRegistryScope(
+                blockCtx.states, dlog::attribute_type_registry_state);
+        if (registry != nullptr)
+        {
+            *attributeTypeRegistryScope.get() = *registry;
+        }
+        auto const numPreviousRecords
+                = static_cast<std::ptrdiff_t>(records.size());
+        while (!blockStream.empty())
+        {
+            DPLX_TRY(parse_record(blockCtx, records));
+        }
+        records.erase(std::remove_if(records.begin() + numPreviousRecords,
+                                     records.end(),
+                                     [](dlog::record const &r) {
+                                         return r.severity
+                                                == dlog::severity::none;
+                                     }),
+                      records.end());
+        return outcome::success();
+    }
+
 private:
     auto parse_item(parse_context &ctx, container &records) -> result<void>
+    {
+        constexpr unsigned majorTypeMask = 0b111'00000U;
+        DPLX_TRY(ctx.in.require_input(1U));
+        if ((std::to_integer<unsigned>(*ctx.in.data()) & majorTypeMask)
+            != static_cast<unsigned>(type_code::tag))
+        {
+            return parse_record(ctx, records);
+        }
+        DPLX_TRY(dp::item_head const tagHead, dp::parse_item_head(ctx));
+        if (tagHead.value == dlog::file_sink_backend::block_frame_tag)
+        {
+            return parse_block(ctx, records);
+        }
+        // sync markers are only relevant for seeking readers
+        return dp::skip_item(ctx);
+    }
+
+    // the records of a compressed container are grouped into blocks
+    auto parse_block(parse_context &ctx, container &records) -> result<void>
+    {
+        DPLX_TRY(auto const block, dlog::detail::decode_record_block(ctx));
+        return decode_block(
+                block,
+                ctx.states.try_access(dlog::attribute_type_registry_state),
+                records);
+    }
+
+    auto parse_record(parse_context &ctx, container &records) -> result<void>
     {
         auto &record = records.emplace_back(
                 dlog::record{.severity = dlog::severity::none,
@@ -6,3 +6,298 @@
 //           https://www.boost.org/LICENSE_1_0.txt)
 
 #include "dplx/dlog/record_container.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <dplx/dp/streams/memory_input_stream.hpp>
+
+#include <dplx/dlog/bus/mpsc_bus.hpp>
+#include <dplx/dlog/detail/file_stream.hpp>
+#include <dplx/dlog/detail/mapped_input_stream.hpp>
+#include <dplx/dlog/log_fabric.hpp>
+#include <dplx/dlog/macros.hpp>
+
+#include "test_dir.hpp"
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+namespace
+{
+
+constexpr int num_test_records = 1000;
+
+auto write_test_container(dlog::block_codec codec,
+                          int numRecords = num_test_records) -> std::string
+{
+    auto fileName = make_file_name(__FILE__, "dlog");
+    constexpr auto regionSize = 1 << 16;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, make_file_name(__FILE__, "dmpscb"), 4U,
+                           regionSize)
+                    .value()};
+    auto createSinkRx = core.create_sink<dlog::file_sink>({
+            .threshold = dlog::severity::info,
+            .backend = {
+                .base = test_dir,
+                .path = fileName,
+                // a few blocks
+                .target_buffer_size = 4096U,
+                .attributes = {},
+                .codec = codec,
+            },
+    });
+    REQUIRE(createSinkRx);
+
+    dlog::log_context ctx(core);
+    for (int i = 0; i < numRecords; ++i)
+    {
+        DLOG_TO(ctx, dlog::severity::warn, "record number {}", i);
+        if (i % 100 == 99)
+        {
+            REQUIRE(core.retire_log_records());
+        }
+    }
+    REQUIRE(core.retire_log_records());
+    REQUIRE(core.destroy_sink(createSinkRx.assume_value()));
+    return fileName;
+}
+
+template <typename InputStream = dlog::detail::os_input_stream>
+auto read_test_container(llfio::file_handle &file)
+        -> result<dlog::record_container>
+{
+    DPLX_TRY(auto const maxExtent, file.maximum_extent());
+    DPLX_TRY(auto &&inStream, InputStream::create(file, maxExtent));
+
+    dp::parse_context ctx(inStream);
+    dp::scoped_state attributeTypeRegistryScope(
+            ctx.states, dlog::attribute_type_registry_state);
+    {
+        auto *attributeTypeRegistry = attributeTypeRegistryScope.get();
+        (void)attributeTypeRegistry->insert<dlog::attr::file>();
+        (void)attributeTypeRegistry->insert<dlog::attr::line>();
+        (void)attributeTypeRegistry->insert<dlog::attr::function>();
+    }
+
+    dlog::argument_transmorpher argumentTransmorpher;
+    dp::basic_decoder<dlog::record> decodeRecord{argumentTransmorpher};
+    dp::basic_decoder<dlog::record_container> decode{decodeRecord};
+
+    dlog::record_container value;
+    DPLX_TRY(decode(ctx, value));
+    return value;
+}
+
+// checks that the index covers every record and that the blocks found by a
+// time based search can be decoded on their own
+void check_block_index(llfio::file_handle &file,
+                       std::vector<dlog::record_block_info> const &index)
+{
+    REQUIRE(index.size() > 1U);
+    std::uint64_t numRecords = 0U;
+    for (auto const &block : index)
+    {
+        CHECK(block.first_timestamp <= block.last_timestamp);
+        numRecords += block.num_records;
+    }
+    CHECK(numRecords == num_test_records);
+
+    auto const &middle = index[index.size() / 2U];
+    auto const found = dlog::find_record_blocks(index, middle.first_timestamp,
+                                                middle.last_timestamp);
+    REQUIRE(!found.empty());
+    CHECK(found.front().first_timestamp <= middle.first_timestamp);
+    CHECK(found.back().last_timestamp >= middle.last_timestamp);
+
+    dlog::attribute_type_registry registry;
+    (void)registry.insert<dlog::attr::file>();
+    (void)registry.insert<dlog::attr::line>();
+    (void)registry.insert<dlog::attr::function>();
+    dlog::argument_transmorpher argumentTransmorpher;
+    dp::basic_decoder<dlog::record> decodeRecord{argumentTransmorpher};
+    dp::basic_decoder<dlog::record_container> decode{decodeRecord};
+
+    auto const blockRx = dlog::read_record_block(file, middle);
+    REQUIRE(blockRx);
+    CHECK(blockRx.assume_value().size() == middle.raw_size);
+    std::pmr::vector<dlog::record> records;
+    REQUIRE(decode.decode_block(blockRx.assume_value(), &registry, records));
+    REQUIRE(records.size() == middle.num_records);
+    for (auto const &record : records)
+    {
+        CHECK(record.message == "record number {}");
+        CHECK(record.timestamp
+              >= middle.first_timestamp.time_since_epoch().count());
+        CHECK(record.timestamp
+              <= middle.last_timestamp.time_since_epoch().count());
+    }
+}
+
+} // namespace
+
+TEST_CASE("record containers can be read back in both formats")
+{
+    auto const plainName = write_test_container(dlog::block_codec::none);
+    auto plainRx = llfio::file(test_dir, plainName);
+    REQUIRE(plainRx);
+    auto &&plainFile = plainRx.assume_value();
+
+    auto const plainContainer = read_test_container(plainFile);
+    REQUIRE(plainContainer);
+    REQUIRE(plainContainer.assume_value().records.size() == num_test_records);
+    CHECK(plainContainer.assume_value().records.back().message
+          == "record number {}");
+    auto const plainIndex = dlog::read_record_block_index(plainFile);
+    REQUIRE(plainIndex);
+    check_block_index(plainFile, plainIndex.assume_value());
+
+    if (!dlog::is_supported(dlog::block_codec::zstd))
+    {
+        SKIP("deeplog has been built without zstd support");
+    }
+    auto const compressedName = write_test_container(dlog::block_codec::zstd);
+    auto compressedRx = llfio::file(test_dir, compressedName);
+    REQUIRE(compressedRx);
+    auto &&compressedFile = compressedRx.assume_value();
+    CHECK(compressedFile.maximum_extent().value()
+          < plainFile.maximum_extent().value());
+
+    auto const compressedContainer = read_test_container(compressedFile);
+    REQUIRE(compressedContainer);
+    auto const &records = compressedContainer.assume_value().records;
+    REQUIRE(records.size() == num_test_records);
+    for (std::size_t i = 0U; i < records.size(); ++i)
+    {
+        CHECK(records[i].message
+              == plainContainer.assume_value().records[i].message);
+    }
+
+    auto const indexRx = dlog::read_record_block_index(compressedFile);
+    REQUIRE(indexRx);
+    auto const &index = indexRx.assume_value();
+    check_block_index(compressedFile, index);
+    std::uint64_t totalRawSize = 0U;
+    // the blocks can be decompressed in any order
+    for (auto it = index.rbegin(); it != index.rend(); ++it)
+    {
+        auto const blockRx = dlog::read_record_block(compressedFile, *it);
+        REQUIRE(blockRx);
+        CHECK(blockRx.assume_value().size() == it->raw_size);
+        totalRawSize += it->raw_size;
+    }
+    CHECK(totalRawSize < plainFile.maximum_extent().value());
+}
+
+TEST_CASE("record containers can be read through a mapping")
+{
+    auto const fileName = write_test_container(dlog::block_codec::none);
+    auto fileRx = llfio::file(test_dir, fileName);
+    REQUIRE(fileRx);
+
+    auto const container
+            = read_test_container<dlog::detail::mapped_input_stream>(
+                    fileRx.assume_value());
+    REQUIRE(container);
+    CHECK(container.assume_value().records.size() == num_test_records);
+}
+
+TEST_CASE("find_record_blocks finds out of order blocks")
+{
+    auto const block = [](int first, int last) {
+        return dlog::record_block_info{
+                .offset = 0U,
+                .size = 0U,
+                .raw_size = 0U,
+                .first_timestamp = dlog::log_clock::time_point(
+                        dlog::log_clock::duration(first)),
+                .last_timestamp = dlog::log_clock::time_point(
+                        dlog::log_clock::duration(last)),
+                .num_records = 1U,
+        };
+    };
+    auto const at = [](int t) {
+        return dlog::log_clock::time_point(dlog::log_clock::duration(t));
+    };
+    // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+    // the second batch has been handed over late
+    std::array<dlog::record_block_info, 4U> index{
+            block(10, 20),
+            block(5, 8),
+            block(21, 30),
+            block(31, 40),
+    };
+    dlog::prepare_record_block_index(index);
+    REQUIRE(index[0].first_timestamp == at(5));
+    CHECK(index[0].latest_timestamp == at(8));
+    CHECK(index[1].latest_timestamp == at(20));
+
+    auto const straggler = dlog::find_record_blocks(index, at(6), at(7));
+    REQUIRE(straggler.size() == 1U);
+    CHECK(straggler.data() == &index[0]);
+
+    auto const spanning = dlog::find_record_blocks(index, at(7), at(22));
+    CHECK(spanning.data() == &index[0]);
+    CHECK(spanning.size() == 3U);
+
+    auto const inner = dlog::find_record_blocks(index, at(12), at(25));
+    CHECK(inner.data() == &index[1]);
+    CHECK(inner.size() == 2U);
+
+    CHECK(dlog::find_record_blocks(index, at(41), at(50)).empty());
+    // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+}
+
+TEST_CASE("record blocks with an implausible raw size are rejected")
+{
+    // [zstd, 2^64 - 1, h'']
+    std::array<std::byte, 12U> frame{};
+    frame[0] = std::byte{0x83};
+    frame[1] = std::byte{0x01};
+    frame[2] = std::byte{0x1b};
+    std::fill(frame.begin() + 3, frame.end() - 1, std::byte{0xff});
+    frame.back() = std::byte{0x40};
+
+    dp::memory_input_stream frameStream(frame);
+    dp::parse_context ctx{frameStream};
+    auto const decodeRx = dlog::detail::decode_record_block(ctx);
+    REQUIRE(decodeRx.has_error());
+    CHECK(decodeRx.assume_error() == dlog::errc::invalid_record_block);
+}
+
+TEST_CASE("record container decode throughput per input stream",
+          "[.][benchmark]")
+{
+    // tens of MiB, i.e. larger than the caches, but small enough for CI disks
+    constexpr int numRecords = 200'000;
+    auto const fileName
+            = write_test_container(dlog::block_codec::none, numRecords);
+    auto fileRx = llfio::file(test_dir, fileName);
+    REQUIRE(fileRx);
+    auto &&file = fileRx.assume_value();
+
+    BENCHMARK("os_input_stream")
+    {
+        return read_test_container<dlog::detail::os_input_stream>(file)
+                .value()
+                .records.size();
+    };
+    BENCHMARK("mapped_input_stream")
+    {
+        return read_test_container<dlog::detail::mapped_input_stream>(file)
+                .value()
+                .records.size();
+    };
+}
+
+} // namespace dlog_tests
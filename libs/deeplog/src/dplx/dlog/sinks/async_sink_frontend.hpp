@@ -0,0 +1,423 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <span>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <dplx/make.hpp>
+
+#include <dplx/dlog/concepts.hpp>
+#include <dplx/dlog/core/serialized_messages.hpp>
+#include <dplx/dlog/core/strong_types.hpp>
+#include <dplx/dlog/disappointment.hpp>
+#include <dplx/dlog/sinks/sink_frontend.hpp>
+
+namespace dplx::dlog
+{
+
+// what an async_sink_frontend does with a batch which doesn't fit into its
+// queue
+enum class sink_overflow_policy : unsigned char
+{
+    // wait for the worker, i.e. the sink applies back pressure to the bus
+    block,
+    // drop the batch and count it, see async_sink_frontend::num_discarded()
+    discard,
+};
+
+template <sink_backend Backend>
+class async_sink_frontend;
+
+} // namespace dplx::dlog
+
+template <dplx::dlog::sink_backend Backend>
+struct dplx::make<dplx::dlog::async_sink_frontend<Backend>>
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    static constexpr std::size_t default_max_queued_bytes = 4U << 20;
+
+    dlog::severity threshold;
+    make<Backend> backend;
+    std::size_t max_queued_bytes = default_max_queued_bytes;
+    dlog::sink_overflow_policy overflow_policy
+            = dlog::sink_overflow_policy::block;
+
+    auto operator()() const noexcept
+            -> result<dlog::async_sink_frontend<Backend>>;
+};
+
+namespace dplx::dlog
+{
+
+// A sink frontend which hands the messages over to a worker thread of its own
+// which writes them to the backend. Therefore a slow backend only stalls the
+// draining thread if its queue overflows with the block policy.
+//
+// The messages are filtered and copied into the queue as they reference the
+// memory of the message bus. try_sync() requests the worker to sync the
+// backend after the queued batches have been written and reports failures of
+// previous writes or syncs; use drain() to wait for the worker.
+// try_finalize() drains the queue, stops the worker and finalizes the
+// backend on the calling thread. A failed write or sync is sticky, i.e. the
+// frontend stays inactive afterwards.
+template <sink_backend Backend>
+class async_sink_frontend : public sink_frontend_base
+{
+    struct queued_batch
+    {
+        std::vector<std::byte> bytes;
+        detail::message_batch_info info;
+    };
+
+    struct shared_state
+    {
+        std::mutex mutex;
+        std::condition_variable wakeWorker;
+        std::condition_variable wakeProducer;
+        std::deque<queued_batch> queue;
+        std::vector<std::vector<std::byte>> spareBatches;
+        std::size_t queuedBytes;
+        std::uint64_t numDiscarded;
+        bool syncRequested;
+        bool busy;
+        bool stop;
+        system_error2::system_code workerStatus;
+        Backend backend;
+        std::thread worker;
+
+        explicit shared_state(Backend &&which)
+            : mutex()
+            , wakeWorker()
+            , wakeProducer()
+            , queue()
+            , spareBatches()
+            , queuedBytes(0U)
+            , numDiscarded(0U)
+            , syncRequested(false)
+            , busy(false)
+            , stop(false)
+            , workerStatus()
+            , backend(std::move(which))
+            , worker()
+        {
+        }
+    };
+
+    std::unique_ptr<shared_state> mState;
+    std::size_t mMaxQueuedBytes;
+    sink_overflow_policy mOverflowPolicy;
+
+public:
+    using backend_type = Backend;
+
+    ~async_sink_frontend() noexcept override
+    {
+        shutdown();
+    }
+
+    async_sink_frontend(async_sink_frontend const &) = delete;
+    auto operator=(async_sink_frontend const &)
+            -> async_sink_frontend & = delete;
+
+    // the worker only refers to the shared state, i.e. moving the frontend
+    // doesn't interfere with it.
+    async_sink_frontend(async_sink_frontend &&) noexcept = default;
+    auto operator=(async_sink_frontend &&other) noexcept
+            -> async_sink_frontend &
+    {
+        shutdown();
+        sink_frontend_base::operator=(std::move(other));
+        mState = std::move(other.mState);
+        mMaxQueuedBytes = other.mMaxQueuedBytes;
+        mOverflowPolicy = other.mOverflowPolicy;
+        return *this;
+    }
+
+    // throws std::bad_alloc
+    async_sink_frontend(severity threshold,
+                        backend_type backend,
+                        std::size_t maxQueuedBytes,
+                        sink_overflow_policy overflowPolicy)
+        : sink_frontend_base(threshold)
+        , mState(std::make_unique<shared_state>(std::move(backend)))
+        , mMaxQueuedBytes(maxQueuedBytes)
+        , mOverflowPolicy(overflowPolicy)
+    {
+    }
+
+    // must not be accessed while the worker is running, i.e. between the
+    // first consumed batch and a completed drain().
+    auto backend() noexcept -> backend_type &
+    {
+        return mState->backend;
+    }
+    auto backend() const noexcept -> backend_type const &
+    {
+        return mState->backend;
+    }
+
+    // the number of batches which have been dropped due to the
+    // sink_overflow_policy::discard policy
+    [[nodiscard]] auto num_discarded() const noexcept -> std::uint64_t
+    {
+        std::lock_guard lock(mState->mutex);
+        return mState->numDiscarded;
+    }
+
+    // waits until the worker has processed every queued batch and sync
+    // request.
+    void drain() noexcept
+    {
+        auto &state = *mState;
+        std::unique_lock lock(state.mutex);
+        state.wakeProducer.wait(lock, [&state] {
+            return state.queue.empty() && !state.syncRequested && !state.busy;
+        });
+    }
+
+private:
+    auto do_consume(std::size_t const binarySize,
+                    std::span<serialized_message_info const> const
+                            messages) noexcept -> result<void> override
+    try
+    {
+        auto &state = *mState;
+        std::unique_lock lock(state.mutex);
+        if (state.workerStatus.failure())
+        {
+            return state.workerStatus.clone();
+        }
+        if (!state.worker.joinable())
+        {
+            state.worker = std::thread(&async_sink_frontend::run, &state);
+        }
+
+        std::vector<std::byte> batch;
+        if (!state.spareBatches.empty())
+        {
+            batch = std::move(state.spareBatches.back());
+            state.spareBatches.pop_back();
+        }
+        lock.unlock();
+
+        batch.reserve(binarySize);
+        for (auto const &message : messages)
+        {
+            auto const *const record
+                    = get_if<serialized_record_info>(&message);
+            if (record != nullptr && record->message_severity < mThreshold)
+            {
+                continue;
+            }
+            auto const rawData = visit(
+                    [](serialized_info_base const &info) {
+                        return info.raw_data;
+                    },
+                    message);
+            batch.insert(batch.end(), rawData.begin(), rawData.end());
+        }
+        auto const info = detail::summarize_messages(messages, mThreshold);
+
+        lock.lock();
+        if (batch.empty())
+        {
+            state.spareBatches.push_back(std::move(batch));
+            return outcome::success();
+        }
+        if (state.queuedBytes + batch.size() > mMaxQueuedBytes
+            && !state.queue.empty())
+        {
+            if (mOverflowPolicy == sink_overflow_policy::discard)
+            {
+                state.numDiscarded += 1U;
+                batch.clear();
+                state.spareBatches.push_back(std::move(batch));
+                return outcome::success();
+            }
+            // a batch exceeding the limit on its own is admitted into an
+            // empty queue
+            state.wakeProducer.wait(lock, [&] {
+                return state.queue.empty()
+                       || state.queuedBytes + batch.size() <= mMaxQueuedBytes;
+            });
+        }
+        state.queuedBytes += batch.size();
+        state.queue.push_back(queued_batch{std::move(batch), info});
+        state.wakeWorker.notify_one();
+        return outcome::success();
+    }
+    catch (std::bad_alloc const &)
+    {
+        return errc::not_enough_memory;
+    }
+    catch (std::system_error const &)
+    {
+        return system_error::errc::resource_unavailable_try_again;
+    }
+
+    auto do_sync() noexcept -> result<void> override
+    {
+        auto &state = *mState;
+        std::lock_guard lock(state.mutex);
+        if (state.workerStatus.failure())
+        {
+            return state.workerStatus.clone();
+        }
+        if (state.worker.joinable())
+        {
+            state.syncRequested = true;
+            state.wakeWorker.notify_one();
+            return outcome::success();
+        }
+        DPLX_TRY(state.backend.sync_output());
+        return outcome::success();
+    }
+
+    auto do_finalize() noexcept -> result<void> override
+    {
+        shutdown();
+        auto &state = *mState;
+        if (state.workerStatus.failure())
+        {
+            return state.workerStatus.clone();
+        }
+        if constexpr (requires {
+                          { state.backend.finalize() } -> cncr::tryable;
+                      })
+        {
+            DPLX_TRY(state.backend.finalize());
+        }
+        return outcome::success();
+    }
+
+    // writes every queued batch and joins the worker
+    void shutdown() noexcept
+    {
+        if (!mState || !mState->worker.joinable())
+        {
+            return;
+        }
+        {
+            std::lock_guard lock(mState->mutex);
+            mState->stop = true;
+        }
+        mState->wakeWorker.notify_one();
+        mState->worker.join();
+        mState->stop = false;
+    }
+
+    // mirrors basic_sink_frontend::do_consume()
+    static auto write_batch(Backend &backend,
+                            std::vector<std::byte> const &batch,
+                            detail::message_batch_info const &info) noexcept
+            -> result<void>
+    {
+        DPLX_TRY(backend.bulk_write(batch.data(), batch.size()));
+        if constexpr (detail::batch_observing_backend<Backend>)
+        {
+            DPLX_TRY(backend.observe_batch(info));
+        }
+        return outcome::success();
+    }
+
+    static void run(shared_state *const statePtr) noexcept
+    {
+        auto &state = *statePtr;
+        std::unique_lock lock(state.mutex);
+        for (;;)
+        {
+            state.wakeWorker.wait(lock, [&state] {
+                return state.stop || state.syncRequested
+                       || !state.queue.empty();
+            });
+
+            if (!state.queue.empty())
+            {
+                auto [batch, info] = std::move(state.queue.front());
+                state.queue.pop_front();
+                state.busy = true;
+                // the batches following a failed write are dropped
+                bool const failed = state.workerStatus.failure();
+                lock.unlock();
+
+                result<void> writeRx = outcome::success();
+                if (!failed)
+                {
+                    writeRx = write_batch(state.backend, batch, info);
+                }
+
+                lock.lock();
+                state.busy = false;
+                state.queuedBytes -= batch.size();
+                if (writeRx.has_failure() && !state.workerStatus.failure())
+                {
+                    state.workerStatus = std::move(writeRx).assume_error();
+                }
+                batch.clear();
+                state.spareBatches.push_back(std::move(batch));
+                state.wakeProducer.notify_all();
+            }
+            else if (state.syncRequested)
+            {
+                state.busy = true;
+                bool const failed = state.workerStatus.failure();
+                lock.unlock();
+
+                result<void> syncRx = outcome::success();
+                if (!failed)
+                {
+                    syncRx = state.backend.sync_output();
+                }
+
+                lock.lock();
+                state.busy = false;
+                state.syncRequested = false;
+                if (syncRx.has_failure() && !state.workerStatus.failure())
+                {
+                    state.workerStatus = std::move(syncRx).assume_error();
+                }
+                state.wakeProducer.notify_all();
+            }
+            else
+            {
+                // stop requested and nothing left to do
+                return;
+            }
+        }
+    }
+};
+
+} // namespace dplx::dlog
+
+template <dplx::dlog::sink_backend Backend>
+auto dplx::make<dplx::dlog::async_sink_frontend<Backend>>::operator()()
+        const noexcept -> result<dlog::async_sink_frontend<Backend>>
+try
+{
+    using namespace dplx::dlog;
+
+    DPLX_TRY(auto &&backend_, backend());
+    return result<async_sink_frontend<Backend>>(
+            std::in_place_type<async_sink_frontend<Backend>>, threshold,
+            std::move(backend_), max_queued_bytes, overflow_policy);
+}
+catch (std::bad_alloc const &)
+{
+    return dlog::errc::not_enough_memory;
+}
@@ -0,0 +1,188 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/sinks/async_sink_frontend.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <dplx/dp/streams/output_buffer.hpp>
+
+#include <dplx/dlog/bus/mpsc_bus.hpp>
+#include <dplx/dlog/log_fabric.hpp>
+#include <dplx/dlog/macros.hpp>
+
+#include "test_dir.hpp"
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+namespace
+{
+
+// an unbuffered backend which records everything written to it, writes can
+// be held back by closing its gate or be failed.
+class recording_sink_backend final : public dp::output_buffer
+{
+public:
+    std::vector<std::byte> written;
+    int numSyncs{};
+    std::size_t numObservedRecords{};
+    std::shared_ptr<std::atomic<bool>> gate;
+    std::shared_ptr<std::atomic<bool>> failing;
+
+    recording_sink_backend() noexcept
+        : output_buffer()
+        , written()
+        , gate(std::make_shared<std::atomic<bool>>(true))
+        , failing(std::make_shared<std::atomic<bool>>(false))
+    {
+    }
+
+    auto observe_batch(dlog::detail::message_batch_info const &batch) noexcept
+            -> result<void>
+    {
+        numObservedRecords += batch.num_records;
+        return outcome::success();
+    }
+
+private:
+    auto do_grow(size_type) noexcept -> result<void> override
+    {
+        return outcome::success();
+    }
+    auto do_bulk_write(std::byte const *src, std::size_t srcSize) noexcept
+            -> result<void> override
+    {
+        while (!gate->load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+        if (failing->load(std::memory_order_acquire))
+        {
+            return dlog::errc::bad;
+        }
+        written.insert(written.end(), src, src + srcSize);
+        return outcome::success();
+    }
+    auto do_sync_output() noexcept -> result<void> override
+    {
+        numSyncs += 1;
+        return outcome::success();
+    }
+};
+
+} // namespace
+
+} // namespace dlog_tests
+
+template <>
+struct dplx::make<dlog_tests::recording_sink_backend>
+{
+    auto operator()() const noexcept
+            -> result<dlog_tests::recording_sink_backend>
+    {
+        return dlog_tests::recording_sink_backend();
+    }
+};
+
+namespace dlog_tests
+{
+
+using async_recording_sink
+        = dlog::async_sink_frontend<recording_sink_backend>;
+
+TEST_CASE("an async sink writes the records on its worker thread")
+{
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "async_sink.dmsb", 4U, regionSize)
+                    .value(),
+            dlog::severity::trace};
+    auto createSinkRx = core.create_sink<async_recording_sink>({
+            .threshold = dlog::severity::info,
+            .backend = {},
+    });
+    REQUIRE(createSinkRx);
+    auto *const sink = createSinkRx.assume_value();
+
+    dlog::log_context ctx(core);
+    DLOG_TO(ctx, dlog::severity::debug, "filtered");
+    REQUIRE(core.retire_log_records());
+    sink->drain();
+    CHECK(sink->backend().written.empty());
+
+    DLOG_TO(ctx, dlog::severity::warn, "written {}", 1);
+    REQUIRE(core.retire_log_records());
+    sink->drain();
+    CHECK(!sink->backend().written.empty());
+    CHECK(sink->backend().numObservedRecords == 1U);
+    CHECK(sink->backend().numSyncs == 2);
+
+    REQUIRE(core.destroy_sink(sink));
+}
+
+TEST_CASE("an async sink discards batches which overflow its queue")
+{
+    async_recording_sink sink(dlog::severity::trace, recording_sink_backend(),
+                              1U, dlog::sink_overflow_policy::discard);
+    auto const gate = sink.backend().gate;
+    gate->store(false, std::memory_order_release);
+
+    std::array<std::byte, 4U> const payload{};
+    std::array<dlog::serialized_message_info, 1U> const messages{
+            dlog::serialized_unknown_message_info{{payload}},
+    };
+
+    // the first batch blocks the worker, depending on whether the worker has
+    // picked it up already the second batch is either queued or discarded,
+    // but the third one doesn't fit in any case.
+    CHECK(sink.try_consume(payload.size(), messages));
+    CHECK(sink.try_consume(payload.size(), messages));
+    CHECK(sink.try_consume(payload.size(), messages));
+
+    gate->store(true, std::memory_order_release);
+    sink.drain();
+    CHECK(sink.num_discarded() >= 1U);
+    CHECK(sink.backend().written.size()
+          == (3U - sink.num_discarded()) * payload.size());
+    CHECK(sink.try_finalize());
+}
+
+TEST_CASE("an async sink stays inactive after a failed write")
+{
+    constexpr std::size_t maxQueuedBytes = 1U << 10;
+    async_recording_sink sink(dlog::severity::trace, recording_sink_backend(),
+                              maxQueuedBytes,
+                              dlog::sink_overflow_policy::block);
+    sink.backend().failing->store(true, std::memory_order_release);
+
+    std::array<std::byte, 4U> const payload{};
+    std::array<dlog::serialized_message_info, 1U> const messages{
+            dlog::serialized_unknown_message_info{{payload}},
+    };
+    CHECK(sink.try_consume(payload.size(), messages));
+    sink.drain();
+
+    CHECK(!sink.try_sync());
+    CHECK(!sink.is_active());
+
+    // the worker keeps the failure, i.e. it is reported again
+    sink.clear_last_status();
+    CHECK(!sink.try_consume(payload.size(), messages));
+    CHECK(!sink.is_active());
+    CHECK(sink.backend().written.empty());
+}
+
+} // namespace dlog_tests
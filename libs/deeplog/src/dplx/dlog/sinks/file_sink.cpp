@@ -7,6 +7,12 @@
 
 #include "dplx/dlog/sinks/file_sink.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iterator>
 #include <type_traits>
 
 #include <fmt/format.h>
@@ -14,6 +20,7 @@
 #include <dplx/dp.hpp>
 #include <dplx/dp/codecs/auto_object.hpp>
 #include <dplx/dp/codecs/core.hpp>
+#include <dplx/dp/streams/memory_input_stream.hpp>
 #include <dplx/dp/streams/memory_output_stream.hpp>
 #include <dplx/scope_guard.hpp>
 
@@ -22,6 +29,29 @@
 namespace dplx::dlog
 {
 
+namespace
+{
+
+// a tagged block info: tag, array head and six uint64 items
+constexpr std::size_t max_sync_marker_size = 5U + 1U + 6U * 9U;
+
+auto emit_block_info(dp::emit_context const &ctx,
+                     record_block_info const &block) noexcept -> result<void>
+{
+    DPLX_TRY(dp::emit_array(ctx, 6U));
+    DPLX_TRY(dp::emit_integer(ctx, block.offset));
+    DPLX_TRY(dp::emit_integer(ctx, block.size));
+    DPLX_TRY(dp::emit_integer(ctx, block.raw_size));
+    DPLX_TRY(dp::emit_integer(
+            ctx, block.first_timestamp.time_since_epoch().count()));
+    DPLX_TRY(dp::emit_integer(
+            ctx, block.last_timestamp.time_since_epoch().count()));
+    DPLX_TRY(dp::emit_integer(ctx, block.num_records));
+    return outcome::success();
+}
+
+} // namespace
+
 auto cbor_attribute_map::insert_attributes(
         detail::attribute_args const &attrRefs) noexcept -> result<void>
 {
@@ -38,6 +68,45 @@ auto cbor_attribute_map::insert_attributes(
     return dp::encode(ostream, attrRefs);
 }
 
+auto cbor_attribute_map::append_attributes(
+        detail::attribute_args const &attrRefs) noexcept -> result<void>
+{
+    if (mSerialized.empty())
+    {
+        return insert_attributes(attrRefs);
+    }
+    dp::memory_input_stream serializedStream(mSerialized);
+    dp::parse_context parseCtx{serializedStream};
+    DPLX_TRY(auto const mapHead, dp::parse_item_head(parseCtx));
+    auto const serializedContent
+            = std::span(mSerialized).last(serializedStream.size());
+    auto const numAttributes = mapHead.value + attrRefs.num_attributes;
+
+    auto const encodedSize
+            = dp::encoded_item_head_size<dp::type_code::map>(numAttributes)
+              + serializedContent.size()
+              + (dp::encoded_size_of(attrRefs)
+                 - dp::encoded_item_head_size<dp::type_code::map>(
+                         attrRefs.num_attributes));
+    std::vector<std::byte> merged;
+    try
+    {
+        merged.resize(encodedSize);
+    }
+    catch (std::bad_alloc const &)
+    {
+        return system_error::errc::not_enough_memory;
+    }
+    dp::memory_output_stream ostream(merged);
+    dp::emit_context emitCtx{ostream};
+    DPLX_TRY(dp::emit_map(emitCtx, numAttributes));
+    DPLX_TRY(ostream.bulk_write(serializedContent.data(),
+                                serializedContent.size()));
+    DPLX_TRY(detail::encode_attributes(emitCtx, attrRefs));
+    mSerialized.swap(merged);
+    return outcome::success();
+}
+
 } // namespace dplx::dlog
 
 auto dplx::make<dplx::dlog::file_sink_backend>::operator()() const noexcept
@@ -50,11 +119,11 @@ try
     constexpr unsigned defaultBufferSize = 64U * 1024;
     file_sink_backend self{target_buffer_size > 0U ? target_buffer_size
                                                    : defaultBufferSize,
-                           attributes};
+                           attributes, io_mode, durability, codec};
     DPLX_TRY(self.mBackingFile,
-             llfio::file(base, path, file_sink_backend::file_mode,
+             llfio::file(base, path, file_sink_backend::file_mode_for(io_mode),
                          file_creation::only_if_not_exist,
-                         file_sink_backend::file_caching,
+                         file_sink_backend::file_caching_for(io_mode),
                          file_sink_backend::file_flags));
 
     llfio::unique_file_lock fileLock(self.mBackingFile,
@@ -88,37 +157,182 @@ auto file_sink_backend::operator=(file_sink_backend &&other)
     mBufferAllocation = std::move(other.mBufferAllocation);
     mTargetBufferSize = std::exchange(other.mTargetBufferSize, 0U);
     mContainerInfo = std::exchange(other.mContainerInfo, {});
+    mIoMode = other.mIoMode;
+    mAsyncWriter = std::move(other.mAsyncWriter);
+    mWriteOffset = std::exchange(other.mWriteOffset, 0U);
+    mWrittenTailSize = std::exchange(other.mWrittenTailSize, 0U);
+    mDurability = other.mDurability;
+    mSyncer = std::move(other.mSyncer);
+    mUnsyncedBytes = std::exchange(other.mUnsyncedBytes, 0U);
+    mUnsyncedSeverity = std::exchange(other.mUnsyncedSeverity, severity::none);
+    mLastDurableSync = other.mLastDurableSync;
+    mCodec = other.mCodec;
+    mCompressing = std::exchange(other.mCompressing, false);
+    mCompressor = std::move(other.mCompressor);
+    mCompressedBlock = std::move(other.mCompressedBlock);
+    mBlockFrame = std::move(other.mBlockFrame);
+    mBlockIndex = std::move(other.mBlockIndex);
+    mCurrentBlock = other.mCurrentBlock;
     return *this;
 }
 
 file_sink_backend::file_sink_backend(
         std::size_t targetBufferSize,
-        dlog::cbor_attribute_map attributes) noexcept
+        dlog::cbor_attribute_map attributes,
+        file_sink_io_mode ioMode,
+        file_sink_durability durability,
+        block_codec codec) noexcept
     : mBackingFile{}
     , mBufferAllocation{}
     , mTargetBufferSize{targetBufferSize}
     , mContainerInfo{std::move(attributes)}
+    , mIoMode{ioMode}
+    , mAsyncWriter{}
+    , mWriteOffset{}
+    , mWrittenTailSize{}
+    , mDurability{durability}
+    , mSyncer{}
+    , mUnsyncedBytes{}
+    , mUnsyncedSeverity{severity::none}
+    , mLastDurableSync{}
+    , mCodec{codec}
+    , mCompressing{}
+    , mCompressor{}
+    , mCompressedBlock{}
+    , mBlockFrame{}
+    , mBlockIndex{}
+    , mCurrentBlock{}
 {
 }
 
 auto file_sink_backend::initialize() noexcept -> result<void>
 {
-    DPLX_TRY(resize(mTargetBufferSize));
+    if (mCodec != block_codec::none)
+    {
+        if (mIoMode != file_sink_io_mode::sync)
+        {
+            return errc::invalid_argument;
+        }
+        DPLX_TRY(mCompressor, block_compressor::create(mCodec));
+        DPLX_TRY(mContainerInfo.append(
+                attr::container_codec{static_cast<unsigned>(mCodec)}));
+    }
+    if (mIoMode == file_sink_io_mode::io_uring)
+    {
+        // any failure to set up the ring (e.g. an exhausted RLIMIT_MEMLOCK)
+        // leaves us with the synchronous writes
+        if (auto createRx = detail::io_uring_writer::create(
+                    mTargetBufferSize, num_io_uring_buffers);
+            createRx.has_value())
+        {
+            mAsyncWriter = std::move(createRx).assume_value();
+        }
+    }
+    if (mIoMode == file_sink_io_mode::direct)
+    {
+        // the buffer must be able to hold the tail page and a write request
+        auto const pageSize = llfio::utils::page_size();
+        mTargetBufferSize = std::max((mTargetBufferSize + pageSize - 1U)
+                                             / pageSize * pageSize,
+                                     2U * pageSize);
+    }
+    if (!mAsyncWriter.is_valid())
+    {
+        DPLX_TRY(resize(mTargetBufferSize));
+        if (mDurability.mode != durability_mode::none && mDurability.background)
+        {
+            DPLX_TRY(mSyncer, detail::file_syncer::create());
+        }
+    }
     DPLX_TRY(rotate());
     return outcome::success();
 }
 
+auto file_sink_backend::complete_writes() noexcept -> result<void>
+{
+    bool const persist = mDurability.mode != durability_mode::none;
+    if (mAsyncWriter.is_valid())
+    {
+        if (persist)
+        {
+            DPLX_TRY(mAsyncWriter.submit_datasync());
+        }
+        DPLX_TRY(mAsyncWriter.wait());
+    }
+    else if (mBackingFile.is_valid())
+    {
+        if (mIoMode == file_sink_io_mode::direct)
+        {
+            DPLX_TRY(mBackingFile.truncate(logical_size()));
+        }
+        if (persist)
+        {
+            if (mSyncer.is_valid())
+            {
+                DPLX_TRY(mSyncer.wait());
+            }
+            DPLX_TRY(mBackingFile.barrier(
+                    {}, llfio::file_handle::barrier_kind::wait_data_only));
+        }
+    }
+    mUnsyncedBytes = 0U;
+    mUnsyncedSeverity = severity::none;
+    mLastDurableSync = std::chrono::steady_clock::now();
+    return outcome::success();
+}
+
+auto file_sink_backend::persist_if_due() noexcept -> result<void>
+{
+    auto const now = std::chrono::steady_clock::now();
+    bool due = false;
+    switch (mDurability.mode)
+    {
+    case durability_mode::none:
+        break;
+    case durability_mode::periodic:
+        due = mUnsyncedBytes > 0U
+              && ((mDurability.byte_interval != 0U
+                   && mUnsyncedBytes >= mDurability.byte_interval)
+                  || (mDurability.interval.count() != 0
+                      && now - mLastDurableSync >= mDurability.interval));
+        break;
+    case durability_mode::on_severity:
+        due = mUnsyncedSeverity >= mDurability.min_severity;
+        break;
+    case durability_mode::per_batch:
+        due = mUnsyncedBytes > 0U;
+        break;
+    }
+    if (!due)
+    {
+        return outcome::success();
+    }
+
+    mUnsyncedBytes = 0U;
+    mUnsyncedSeverity = severity::none;
+    mLastDurableSync = now;
+    if (mAsyncWriter.is_valid())
+    {
+        // ordered after the pending writes by the ring
+        return mAsyncWriter.submit_datasync();
+    }
+    if (mSyncer.is_valid())
+    {
+        return mSyncer.request();
+    }
+    DPLX_TRY(mBackingFile.barrier(
+            {}, llfio::file_handle::barrier_kind::wait_data_only));
+    return outcome::success();
+}
+
 auto file_sink_backend::finalize() noexcept -> result<std::uint32_t>
 {
     if (!mBackingFile.is_valid())
     {
         return 0U;
     }
-    {
-        dp::emit_context ctx{*this};
-        DPLX_TRY(dp::emit_break(ctx));
-    }
-    DPLX_TRY(sync_output());
+    DPLX_TRY(write_trailer());
+    DPLX_TRY(complete_writes());
     DPLX_TRY(auto const finalFileSize, mBackingFile.maximum_extent());
     mBackingFile.unlock_file();
     DPLX_TRY(mBackingFile.close());
@@ -137,6 +351,116 @@ auto file_sink_backend::clone_backing_file_handle() const noexcept
     return cloned;
 }
 
+auto file_sink_backend::write_trailer() noexcept -> result<void>
+{
+    // the remaining records form the last block
+    DPLX_TRY(close_block());
+    mCompressing = false;
+
+    dp::emit_context ctx{*this};
+    DPLX_TRY(dp::emit_break(ctx));
+
+    auto const indexOffset = logical_size();
+    DPLX_TRY(dp::emit_tag(ctx, block_index_tag));
+    DPLX_TRY(dp::emit_array(ctx, mBlockIndex.size()));
+    for (auto const &block : mBlockIndex)
+    {
+        DPLX_TRY(emit_block_info(ctx, block));
+    }
+
+    // a CBOR uint64 head followed by the big endian offset
+    std::array<std::byte, block_index_trailer_size> trailer{std::byte{0x1b}};
+    for (std::size_t i = 1U; i < trailer.size(); ++i)
+    {
+        trailer[i] = static_cast<std::byte>(
+                indexOffset >> (8U * (trailer.size() - 1U - i)));
+    }
+    DPLX_TRY(bulk_write(trailer));
+    return write_buffer();
+}
+
+auto file_sink_backend::observe_batch(
+        detail::message_batch_info const &batch) noexcept -> result<void>
+{
+    observe_severity(batch.max_severity);
+    if (batch.num_records != 0U)
+    {
+        mCurrentBlock.num_records += batch.num_records;
+        mCurrentBlock.first_timestamp
+                = std::min(mCurrentBlock.first_timestamp, batch.first_timestamp);
+        mCurrentBlock.last_timestamp
+                = std::max(mCurrentBlock.last_timestamp, batch.last_timestamp);
+    }
+    if (logical_size() - mCurrentBlock.offset < mTargetBufferSize)
+    {
+        return outcome::success();
+    }
+    return close_block();
+}
+
+auto file_sink_backend::write_gathered(
+        std::span<bytes const> pieces) noexcept -> result<void>
+{
+    if (writes_through_buffer())
+    {
+        for (auto const piece : pieces)
+        {
+            DPLX_TRY(bulk_write(piece));
+        }
+        return outcome::success();
+    }
+
+    std::size_t totalSize = 0U;
+    for (auto const piece : pieces)
+    {
+        totalSize += piece.size();
+    }
+    // small batches are cheaper to copy, same heuristic as do_bulk_write()
+    if (totalSize <= size() && totalSize < mBufferAllocation.size() / 2)
+    {
+        for (auto const piece : pieces)
+        {
+            std::memcpy(data(), piece.data(), piece.size());
+            commit_written(piece.size());
+        }
+        return outcome::success();
+    }
+
+    // only the sync mode gets here which opens the file for appending, i.e.
+    // the writes ignore their offset. mWriteOffset can't be used instead,
+    // because it doesn't account for the content of a reopened file.
+    assert(mBackingFile.is_append_only());
+    auto const buffer = mBufferAllocation.as_span();
+    llfio::file_handle::const_buffer_type
+            writeBuffers[detail::max_gather_pieces + 1U];
+    std::size_t numBuffers = 0U;
+    if (size() != buffer.size())
+    {
+        writeBuffers[numBuffers++] = {buffer.data(), buffer.size() - size()};
+    }
+    do
+    {
+        auto const chunk = pieces.first(
+                std::min(pieces.size(), std::size(writeBuffers) - numBuffers));
+        for (auto const piece : chunk)
+        {
+            writeBuffers[numBuffers++] = {piece.data(), piece.size()};
+        }
+        pieces = pieces.subspan(chunk.size());
+
+        DPLX_TRY(mBackingFile.write(
+                {std::span(writeBuffers).first(numBuffers), 0U}));
+        for (auto const &written : std::span(writeBuffers).first(numBuffers))
+        {
+            mWriteOffset += written.size();
+            mUnsyncedBytes += written.size();
+        }
+        numBuffers = 0U;
+    } while (!pieces.empty());
+    reset(buffer);
+    return outcome::success();
+}
+
 auto file_sink_backend::rotate() noexcept -> result<void>
 {
     DPLX_TRY(auto const needsInit, do_rotate(mBackingFile));
@@ -144,7 +468,19 @@ auto file_sink_backend::rotate() noexcept -> result<void>
     {
         return outcome::success();
     }
-    reset(mBufferAllocation.as_span());
+    if (mAsyncWriter.is_valid())
+    {
+        DPLX_TRY(mAsyncWriter.attach(mBackingFile));
+    }
+    if (mSyncer.is_valid())
+    {
+        DPLX_TRY(mSyncer.attach(mBackingFile));
+    }
+    mWriteOffset = 0U;
+    mWrittenTailSize = 0U;
+    mCompressing = false;
+    mBlockIndex.clear();
+    reset(active_buffer());
     dp::emit_context emitCtx{*this};
 
     DPLX_TRY(bulk_write(as_bytes(std::span(magic))));
@@ -174,15 +510,235 @@ auto file_sink_backend::rotate() noexcept -> result<void>
     }
 
     DPLX_TRY(dp::emit_array_indefinite(emitCtx));
-    llfio::file_handle::const_buffer_type writeBuffers[]
-            = {mBufferAllocation.as_span().first(mBufferAllocation.size()
-                                                 - size())};
+    DPLX_TRY(write_buffer());
+    mCompressing = mCodec != block_codec::none;
+    begin_block();
+    // do_rotate() inspects the file extent, i.e. the header must have landed
+    return complete_writes();
+}
+
+auto file_sink_backend::active_buffer() noexcept -> std::span<std::byte>
+{
+    return mAsyncWriter.is_valid() ? mAsyncWriter.buffer()
+                                   : mBufferAllocation.as_span();
+}
+
+auto file_sink_backend::logical_size() noexcept -> std::uint64_t
+{
+    return mWriteOffset + (active_buffer().size() - size());
+}
+
+auto file_sink_backend::write_buffer() noexcept -> result<void>
+{
+    if (mCompressing)
+    {
+        return write_block();
+    }
+    auto const buffer = active_buffer();
+    auto const bufferedSize = buffer.size() - size();
+    mUnsyncedBytes += bufferedSize - mWrittenTailSize;
+    if (mAsyncWriter.is_valid())
+    {
+        DPLX_TRY(mAsyncWriter.submit(bufferedSize));
+    }
+    else if (mIoMode == file_sink_io_mode::direct)
+    {
+        return write_pages(buffer, bufferedSize);
+    }
+    else if (bufferedSize != 0U)
+    {
+        assert(mBackingFile.is_append_only());
+        llfio::file_handle::const_buffer_type writeBuffers[]
+                = {buffer.first(bufferedSize)};
+
+        DPLX_TRY(mBackingFile.write({writeBuffers, 0U}));
+    }
+    mWriteOffset += bufferedSize;
+    reset(active_buffer());
+    return outcome::success();
+}
+
+void file_sink_backend::begin_block() noexcept
+{
+    mCurrentBlock = {
+            .offset = logical_size(),
+            .size = 0U,
+            .raw_size = 0U,
+            .first_timestamp = log_clock::time_point::max(),
+            .last_timestamp = log_clock::time_point::min(),
+            .num_records = 0U,
+    };
+}
+
+auto file_sink_backend::seal_block(std::uint64_t const offset,
+                                   std::uint64_t const size,
+                                   std::uint64_t const rawSize) const noexcept
+        -> record_block_info
+{
+    auto block = mCurrentBlock;
+    block.offset = offset;
+    block.size = size;
+    block.raw_size = rawSize;
+    if (block.num_records == 0U)
+    {
+        // an empty block inherits the last timestamp of its predecessor
+        // instead of an empty time range; find_record_blocks() skips it
+        block.first_timestamp = block.last_timestamp
+                = mBlockIndex.empty() ? log_clock::time_point{}
+                                      : mBlockIndex.back().last_timestamp;
+    }
+    return block;
+}
 
+auto file_sink_backend::close_block() noexcept -> result<void>
+try
+{
+    if (mCompressing)
+    {
+        return write_block();
+    }
+    auto const blockEnd = logical_size();
+    if (blockEnd == mCurrentBlock.offset)
+    {
+        return outcome::success();
+    }
+    auto const blockSize = blockEnd - mCurrentBlock.offset;
+    auto const block = seal_block(mCurrentBlock.offset, blockSize, blockSize);
+
+    dp::emit_context ctx{*this};
+    DPLX_TRY(dp::emit_tag(ctx, block_sync_tag));
+    DPLX_TRY(emit_block_info(ctx, block));
+    mBlockIndex.push_back(block);
+    begin_block();
+    return outcome::success();
+}
+catch (std::bad_alloc const &)
+{
+    return errc::not_enough_memory;
+}
+
+auto file_sink_backend::write_block() noexcept -> result<void>
+try
+{
+    auto const buffer = mBufferAllocation.as_span();
+    auto const rawSize = buffer.size() - size();
+    if (rawSize == 0U)
+    {
+        return outcome::success();
+    }
+    // tag, array, codec, raw size and binary head
+    constexpr std::size_t maxFrameHeadSize = 5U + 1U + 1U + 9U + 9U;
+    if (auto const bound = compress_bound(mCodec, rawSize);
+        mCompressedBlock.size() < bound)
+    {
+        mCompressedBlock.resize(bound);
+        mBlockFrame.resize(bound + maxFrameHeadSize + max_sync_marker_size);
+    }
+    DPLX_TRY(auto const compressedSize,
+             mCompressor.compress(buffer.first(rawSize), mCompressedBlock));
+
+    dp::memory_output_stream frameStream(mBlockFrame);
+    dp::emit_context ctx{frameStream};
+    DPLX_TRY(dp::emit_tag(ctx, block_frame_tag));
+    DPLX_TRY(dp::emit_array(ctx, 3U));
+    DPLX_TRY(dp::emit_integer(ctx, static_cast<unsigned>(mCodec)));
+    DPLX_TRY(dp::emit_integer(ctx, rawSize));
+    DPLX_TRY(dp::emit_binary(ctx, mCompressedBlock.data(), compressedSize));
+    auto const frameSize = mBlockFrame.size() - frameStream.size();
+
+    auto const block = seal_block(mWriteOffset, frameSize, rawSize);
+    DPLX_TRY(dp::emit_tag(ctx, block_sync_tag));
+    DPLX_TRY(emit_block_info(ctx, block));
+    auto const writeSize = mBlockFrame.size() - frameStream.size();
+
+    llfio::file_handle::const_buffer_type writeBuffers[]
+            = {std::span(mBlockFrame).first(writeSize)};
     DPLX_TRY(mBackingFile.write({writeBuffers, 0U}));
+
+    mBlockIndex.push_back(block);
+    mWriteOffset += writeSize;
+    mUnsyncedBytes += writeSize;
+    reset(buffer);
+    begin_block();
+    return outcome::success();
+}
+catch (std::bad_alloc const &)
+{
+    return errc::not_enough_memory;
+}
+
+auto file_sink_backend::grow_block(std::size_t const requestedSize) noexcept
+        -> result<void>
+{
+    if (size() >= requestedSize)
+    {
+        return outcome::success();
+    }
+    auto const buffer = mBufferAllocation.as_span();
+    auto const bufferedSize = buffer.size() - size();
+
+    dp::memory_allocation<llfio::utils::page_allocator<std::byte>> grown;
+    DPLX_TRY(grown.resize(static_cast<unsigned>(
+            std::max(2U * buffer.size(), bufferedSize + requestedSize))));
+    std::memcpy(grown.as_span().data(), buffer.data(), bufferedSize);
+    mBufferAllocation = std::move(grown);
     reset(mBufferAllocation.as_span());
+    commit_written(bufferedSize);
+    return outcome::success();
+}
+
+auto file_sink_backend::write_pages(std::span<std::byte> const buffer,
+                                    std::size_t const bufferedSize) noexcept
+        -> result<void>
+{
+    if (bufferedSize == mWrittenTailSize)
+    {
+        return outcome::success();
+    }
+    auto const pageSize = llfio::utils::page_size();
+    auto const tailSize = bufferedSize % pageSize;
+    auto const fullSize = bufferedSize - tailSize;
+    auto writeSize = fullSize;
+    if (tailSize != 0U)
+    {
+        // the padding is overwritten by the next write or truncated
+        std::memset(buffer.subspan(bufferedSize).data(), 0,
+                    pageSize - tailSize);
+        writeSize += pageSize;
+    }
+
+    llfio::file_handle::const_buffer_type writeBuffers[]
+            = {buffer.first(writeSize)};
+    DPLX_TRY(mBackingFile.write({writeBuffers, mWriteOffset}));
+
+    mWriteOffset += fullSize;
+    mWrittenTailSize = tailSize;
+    std::memmove(buffer.data(), buffer.subspan(fullSize).data(), tailSize);
+    reset(buffer);
+    commit_written(tailSize);
     return outcome::success();
 }
 
+auto file_sink_backend::copy_through_buffer(std::byte const *src,
+                                            std::size_t srcSize) noexcept
+        -> result<void>
+{
+    for (;;)
+    {
+        auto const chunkSize = std::min(srcSize, size());
+        std::memcpy(data(), src, chunkSize);
+        commit_written(chunkSize);
+        srcSize -= chunkSize;
+        if (srcSize == 0U)
+        {
+            return outcome::success();
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        src += chunkSize;
+        DPLX_TRY(write_buffer());
+    }
+}
+
 auto file_sink_backend::resize(std::size_t const requestedSize) noexcept
         -> result<void>
 {
@@ -193,19 +749,22 @@ auto file_sink_backend::resize(std::size_t const requestedSize) noexcept
 auto file_sink_backend::do_grow(size_type requestedSize) noexcept
         -> result<void>
 {
-    if (size() != mBufferAllocation.size())
+    if (mCompressing)
     {
-        llfio::file_handle::const_buffer_type writeBuffers[]
-                = {mBufferAllocation.as_span().first(mBufferAllocation.size()
-                                                     - size())};
-
-        DPLX_TRY(mBackingFile.write({writeBuffers, 0U}));
+        return grow_block(requestedSize);
     }
-    if (mBufferAllocation.size() < requestedSize)
+    DPLX_TRY(write_buffer());
+    if (size() < requestedSize)
     {
+        if (mAsyncWriter.is_valid() || mIoMode == file_sink_io_mode::direct)
+        {
+            // the registered buffers can't be resized and the direct mode
+            // buffer holds the tail page
+            return errc::not_enough_space;
+        }
         DPLX_TRY(resize(requestedSize));
+        reset(mBufferAllocation.as_span());
     }
-    reset(mBufferAllocation.as_span());
     return outcome::success();
 }
 
@@ -213,14 +772,21 @@ auto file_sink_backend::do_bulk_write(std::byte const *src,
                                       std::size_t srcSize) noexcept
         -> result<void>
 {
+    if (mCompressing)
+    {
+        DPLX_TRY(grow_block(srcSize));
+        std::memcpy(data(), src, srcSize);
+        commit_written(srcSize);
+        return outcome::success();
+    }
+    if (writes_through_buffer())
+    {
+        return copy_through_buffer(src, srcSize);
+    }
     if (srcSize < mBufferAllocation.size() / 2)
     {
-        auto const buffer = mBufferAllocation.as_span();
-        llfio::file_handle::const_buffer_type writeBuffers[]
-                = {buffer.first(buffer.size() - size())};
-        DPLX_TRY(mBackingFile.write({writeBuffers, 0U}));
-        reset(buffer);
-        std::memcpy(buffer.data(), src, srcSize);
+        DPLX_TRY(write_buffer());
+        std::memcpy(data(), src, srcSize);
         commit_written(srcSize);
         return outcome::success();
     }
@@ -232,28 +798,30 @@ auto file_sink_backend::do_bulk_write(std::byte const *src,
     };
 
     DPLX_TRY(mBackingFile.write({writeBuffers, 0U}));
+    mWriteOffset += writeBuffers[0].size() + srcSize;
+    mUnsyncedBytes += writeBuffers[0].size() + srcSize;
     reset(buffer);
     return outcome::success();
 }
 
 auto file_sink_backend::do_sync_output() noexcept -> result<void>
 {
-    if (size() != mBufferAllocation.size())
+    DPLX_TRY(write_buffer());
+    if (mAsyncWriter.is_valid())
     {
-        auto const buffer = mBufferAllocation.as_span();
-        llfio::file_handle::const_buffer_type writeBuffers[] = {
-                {buffer.data(), buffer.size() - size()}
-        };
-
-        DPLX_TRY(mBackingFile.write({writeBuffers, 0U}));
+        // the writes are only waited for by a rotation or finalize(),
+        // otherwise the completions are picked up during the next drains.
+        DPLX_TRY(mAsyncWriter.reap());
     }
-    if (mBufferAllocation.size() != mTargetBufferSize)
+    else if (mIoMode != file_sink_io_mode::direct
+             && mBufferAllocation.size() != mTargetBufferSize)
     {
         DPLX_TRY(resize(mTargetBufferSize));
+        reset(mBufferAllocation.as_span());
     }
-    reset(mBufferAllocation.as_span());
 
-    return rotate();
+    DPLX_TRY(rotate());
+    return persist_if_due();
 }
 
 auto file_sink_backend::do_rotate(llfio::file_handle &backingFile) noexcept
@@ -273,8 +841,14 @@ try
 {
     using namespace dplx::dlog;
 
-    db_file_sink_backend self{target_buffer_size, attributes, max_file_size,
-                              std::string(file_name_pattern), sink_id};
+    db_file_sink_backend self{target_buffer_size,
+                              attributes,
+                              io_mode,
+                              durability,
+                              codec,
+                              max_file_size,
+                              std::string(file_name_pattern),
+                              sink_id};
     DPLX_TRY(self.mFileDatabase, database.clone());
     DPLX_TRY(self.initialize())
 
@@ -318,10 +892,17 @@ auto db_file_sink_backend::operator=(db_file_sink_backend &&other)
 
 db_file_sink_backend::db_file_sink_backend(std::size_t const targetBufferSize,
                                            dlog::cbor_attribute_map attributes,
+                                           file_sink_io_mode const ioMode,
+                                           file_sink_durability const durability,
+                                           block_codec const codec,
                                            std::uint64_t const maxFileSize,
                                            std::string fileNamePattern,
                                            file_sink_id const sinkId) noexcept
-    : file_sink_backend(targetBufferSize, std::move(attributes))
+    : file_sink_backend(targetBufferSize,
+                        std::move(attributes),
+                        ioMode,
+                        durability,
+                        codec)
     , mMaxFileSize(maxFileSize)
     , mFileDatabase()
     , mFileNamePattern(std::move(fileNamePattern))
@@ -349,16 +930,13 @@ auto db_file_sink_backend::do_rotate(llfio::file_handle &backingFile) noexcept
             return false;
         }
 
-        {
-            dp::emit_context ctx{*this};
-            DPLX_TRY(dp::emit_break(ctx));
-        }
         auto const rotation = std::exchange(mCurrentRotation, 0);
         scope_guard releaseFile = [&backingFile] {
             backingFile.unlock_file();
             (void)backingFile.close();
         };
-        DPLX_TRY(sync_output());
+        DPLX_TRY(write_trailer());
+        DPLX_TRY(complete_writes());
 
         DPLX_TRY(auto const finalFileSize, backingFile.maximum_extent());
         (void)mFileDatabase.update_record_container_size(
@@ -366,8 +944,9 @@ auto db_file_sink_backend::do_rotate(llfio::file_handle &backingFile) noexcept
     }
 
     DPLX_TRY(auto &&created, mFileDatabase.create_record_container(
-                                     mFileNamePattern, mSinkId, file_mode,
-                                     file_caching, file_flags));
+                                     mFileNamePattern, mSinkId,
+                                     file_mode_for(io_mode()),
+                                     file_caching_for(io_mode()), file_flags));
     backingFile = std::move(created.handle);
     mFileEpoch = log_clock::epoch();
     mCurrentRotation = created.rotation;
@@ -7,19 +7,25 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <span>
 #include <string_view>
+#include <vector>
 
 #include <dplx/dp/fwd.hpp>
 #include <dplx/dp/legacy/memory_buffer.hpp>
 #include <dplx/make.hpp>
 
 #include <dplx/dlog/attributes.hpp>
+#include <dplx/dlog/block_codec.hpp>
 #include <dplx/dlog/concepts.hpp>
 #include <dplx/dlog/core/file_database.hpp>
 #include <dplx/dlog/core/log_clock.hpp>
+#include <dplx/dlog/core/strong_types.hpp>
+#include <dplx/dlog/detail/file_syncer.hpp>
+#include <dplx/dlog/detail/io_uring_writer.hpp>
 #include <dplx/dlog/llfio.hpp>
 #include <dplx/dlog/sinks/sink_frontend.hpp>
 
@@ -49,6 +55,17 @@ public:
         return self;
     }
 
+    // adds the attributes to the serialized ones, duplicate ids aren't
+    // detected
+    template <typename... Attrs>
+        requires(... && attribute<std::remove_cvref_t<Attrs>>)
+    auto append(Attrs &&...attrs) noexcept -> result<void>
+    {
+        return append_attributes(
+                detail::stack_attribute_args<std::remove_cvref_t<Attrs>...>{
+                        attrs...});
+    }
+
     [[nodiscard]] auto bytes() const noexcept -> std::span<std::byte const>
     {
         return mSerialized;
@@ -57,6 +74,71 @@ public:
 private:
     auto insert_attributes(detail::attribute_args const &attrRefs) noexcept
             -> result<void>;
+    auto append_attributes(detail::attribute_args const &attrRefs) noexcept
+            -> result<void>;
+};
+
+// how a file_sink_backend hands its buffers over to the OS
+enum class file_sink_io_mode : unsigned char
+{
+    // the draining thread writes the buffer and waits for the write
+    sync,
+    // the buffers are written asynchronously via an io_uring, the completions
+    // are reaped during later writes and syncs. Falls back to sync if io_uring
+    // isn't available.
+    io_uring,
+    // the file is opened with caching::none (O_DIRECT) and only written in
+    // whole pages, i.e. the log writes bypass the page cache. The partial
+    // page at the end is kept in the buffer and rewritten by the next write,
+    // the padding is truncated by finalize().
+    direct,
+};
+
+// when a file_sink_backend asks the OS to persist the written data
+// (fdatasync). The syncs are evaluated once per drain, i.e. every record
+// written since the previous sync shares a single one (group commit).
+enum class durability_mode : unsigned char
+{
+    // durability is left to the OS
+    none,
+    // after the configured interval or amount of bytes has been exceeded
+    periodic,
+    // after a batch containing a record with at least min_severity
+    on_severity,
+    // after every batch
+    per_batch,
+};
+
+struct file_sink_durability
+{
+    durability_mode mode = durability_mode::none;
+    // periodic mode, a zero disables the respective limit
+    std::chrono::milliseconds interval{};
+    std::uint64_t byte_interval{};
+    // on_severity mode
+    severity min_severity = severity::error;
+    // hand the syncs over to a helper thread instead of blocking the drain,
+    // the io_uring mode always queues them on its ring.
+    bool background = false;
+};
+
+// the location and time range of a record block within a record container
+struct record_block_info
+{
+    // the file offset and size of the block (frame), the size of uncompressed
+    // blocks equals their raw size
+    std::uint64_t offset;
+    std::uint64_t size;
+    // the size of the serialized records within the block
+    std::uint64_t raw_size;
+    // the earliest and latest record timestamp, a block without any record
+    // inherits the last timestamp of its predecessor
+    log_clock::time_point first_timestamp;
+    log_clock::time_point last_timestamp;
+    std::uint64_t num_records;
+    // the latest last_timestamp of this and every preceding block within an
+    // index prepared by prepare_record_block_index(), it isn't encoded
+    log_clock::time_point latest_timestamp{};
 };
 
 } // namespace dplx::dlog
@@ -69,6 +151,10 @@ struct dplx::make<dplx::dlog::file_sink_backend>
     dlog::llfio::path_view path;
     std::size_t target_buffer_size;
     dlog::cbor_attribute_map attributes;
+    dlog::file_sink_io_mode io_mode = dlog::file_sink_io_mode::sync;
+    dlog::file_sink_durability durability = {};
+    // compressed containers are only supported by the sync io mode
+    dlog::block_codec codec = dlog::block_codec::none;
 
     auto operator()() const noexcept -> result<dlog::file_sink_backend>;
 };
@@ -85,6 +171,31 @@ class file_sink_backend : public dp::output_buffer
             mBufferAllocation;
     std::size_t mTargetBufferSize{};
     dlog::cbor_attribute_map mContainerInfo;
+    file_sink_io_mode mIoMode{};
+    // only valid in io_uring mode, owns the buffers in that case
+    detail::io_uring_writer mAsyncWriter;
+    // the file offset of the buffer start and (direct mode) the size of the
+    // partial page which has already been written
+    std::uint64_t mWriteOffset{};
+    std::size_t mWrittenTailSize{};
+    file_sink_durability mDurability;
+    // only valid with a background durability policy and without io_uring
+    detail::file_syncer mSyncer;
+    std::uint64_t mUnsyncedBytes{};
+    severity mUnsyncedSeverity{};
+    std::chrono::steady_clock::time_point mLastDurableSync{};
+    // compressed containers: each block is compressed into a frame while the
+    // record array is written (the container header and trailer are written
+    // as is)
+    block_codec mCodec{};
+    bool mCompressing{};
+    block_compressor mCompressor;
+    std::vector<std::byte> mCompressedBlock;
+    std::vector<std::byte> mBlockFrame;
+    std::vector<record_block_info> mBlockIndex;
+    // the block which is currently written, its offset is a logical file
+    // offset, i.e. buffered content is included
+    record_block_info mCurrentBlock{};
 
 public:
     file_sink_backend() noexcept = default;
@@ -107,14 +218,43 @@ public:
         swap(lhs.mBackingFile, rhs.mBackingFile);
         swap(lhs.mBufferAllocation, rhs.mBufferAllocation);
         swap(lhs.mTargetBufferSize, rhs.mTargetBufferSize);
+        swap(lhs.mIoMode, rhs.mIoMode);
+        swap(lhs.mAsyncWriter, rhs.mAsyncWriter);
+        swap(lhs.mWriteOffset, rhs.mWriteOffset);
+        swap(lhs.mWrittenTailSize, rhs.mWrittenTailSize);
+        swap(lhs.mDurability, rhs.mDurability);
+        swap(lhs.mSyncer, rhs.mSyncer);
+        swap(lhs.mUnsyncedBytes, rhs.mUnsyncedBytes);
+        swap(lhs.mUnsyncedSeverity, rhs.mUnsyncedSeverity);
+        swap(lhs.mLastDurableSync, rhs.mLastDurableSync);
+        swap(lhs.mCodec, rhs.mCodec);
+        swap(lhs.mCompressing, rhs.mCompressing);
+        swap(lhs.mCompressor, rhs.mCompressor);
+        swap(lhs.mCompressedBlock, rhs.mCompressedBlock);
+        swap(lhs.mBlockFrame, rhs.mBlockFrame);
+        swap(lhs.mBlockIndex, rhs.mBlockIndex);
+        swap(lhs.mCurrentBlock, rhs.mCurrentBlock);
     }
 
 protected:
     explicit file_sink_backend(std::size_t targetBufferSize,
-                               dlog::cbor_attribute_map attributes) noexcept;
+                               dlog::cbor_attribute_map attributes,
+                               file_sink_io_mode ioMode,
+                               file_sink_durability durability,
+                               block_codec codec) noexcept;
 
     auto initialize() noexcept -> result<void>;
 
+    // terminates the record array and appends the block index, the trailer
+    // is written, but not completed.
+    auto write_trailer() noexcept -> result<void>;
+
+    // waits for the asynchronous writes to the backing file, truncates the
+    // page padding in direct mode and persists the file unless the
+    // durability mode is none. Must be called before the backing file is
+    // inspected or closed.
+    auto complete_writes() noexcept -> result<void>;
+
 public:
     using config_type = make<file_sink_backend>;
     static auto create(make<file_sink_backend> &&maker) noexcept
@@ -130,11 +270,42 @@ public:
     static inline constexpr llfio::file_handle::flag file_flags
             = llfio::file_handle::flag::none;
 
+    // direct mode needs positional writes in order to rewrite the last page
+    static constexpr auto file_mode_for(file_sink_io_mode ioMode) noexcept
+            -> llfio::file_handle::mode
+    {
+        return ioMode == file_sink_io_mode::direct
+                       ? llfio::file_handle::mode::write
+                       : file_mode;
+    }
+    static constexpr auto file_caching_for(file_sink_io_mode ioMode) noexcept
+            -> llfio::file_handle::caching
+    {
+        return ioMode == file_sink_io_mode::direct
+                       ? llfio::file_handle::caching::none
+                       : file_caching;
+    }
+
+    static inline constexpr unsigned num_io_uring_buffers = 4U;
+
     static inline constexpr std::string_view extension{".dlog"};
     static inline constexpr std::uint8_t magic[16]
             = {0x83, 0x4e, 0x0d, 0x0a, 0xab, 0x7e, 0x7b, 0x64,
                0x6c, 0x6f, 0x67, 0x7d, 0x7e, 0xbb, 0x0a, 0x1a};
 
+    // The record array of a compressed container consists of tagged
+    // [codec, raw size, compressed records] block frames. The records of
+    // both container kinds are grouped into blocks of roughly
+    // target_buffer_size bytes, each block is followed by a tagged sync
+    // marker with its record_block_info encoded as
+    // [offset, size, raw size, first timestamp, last timestamp, num records].
+    // The record array is followed by the tagged array of all block infos and
+    // the file offset of said index encoded as a (fixed size) CBOR uint64.
+    static inline constexpr std::uint64_t block_frame_tag = 0x646c'6662U;
+    static inline constexpr std::uint64_t block_sync_tag = 0x646c'736dU;
+    static inline constexpr std::uint64_t block_index_tag = 0x646c'6269U;
+    static inline constexpr std::size_t block_index_trailer_size = 9U;
+
     // returns the size of the finalized log record container
     // or 0 if file_sink_backend wasn't initialized
     auto finalize() noexcept -> result<std::uint32_t>;
@@ -142,9 +313,69 @@ public:
     auto clone_backing_file_handle() const noexcept
             -> result<llfio::file_handle>;
 
+    [[nodiscard]] auto io_mode() const noexcept -> file_sink_io_mode
+    {
+        return mIoMode;
+    }
+    [[nodiscard]] auto codec() const noexcept -> block_codec
+    {
+        return mCodec;
+    }
+
+    void observe_severity(severity const sev) noexcept
+    {
+        if (sev > mUnsyncedSeverity)
+        {
+            mUnsyncedSeverity = sev;
+        }
+    }
+    // called by the sink frontend after each batch has been written, i.e. at
+    // a record boundary. Closes the current block if it is large enough.
+    auto observe_batch(detail::message_batch_info const &batch) noexcept
+            -> result<void>;
+
+    // writes the buffered content and the pieces with a single gather write,
+    // i.e. the pieces aren't copied into the buffer unless they are small.
+    // The pieces only need to stay valid for the duration of the call.
+    auto write_gathered(std::span<bytes const> pieces) noexcept
+            -> result<void>;
+
 private:
     auto rotate() noexcept -> result<void>;
 
+    auto active_buffer() noexcept -> std::span<std::byte>;
+    // the file size after the buffered content has been written
+    auto logical_size() noexcept -> std::uint64_t;
+    // writes the buffered content and resets the buffer
+    auto write_buffer() noexcept -> result<void>;
+    auto write_pages(std::span<std::byte> buffer,
+                     std::size_t bufferedSize) noexcept -> result<void>;
+    void begin_block() noexcept;
+    // indexes the current block and emits its sync marker, compressed blocks
+    // are written by write_block() instead.
+    auto close_block() noexcept -> result<void>;
+    [[nodiscard]] auto seal_block(std::uint64_t offset,
+                                  std::uint64_t size,
+                                  std::uint64_t rawSize) const noexcept
+            -> record_block_info;
+    // compresses the buffered records and writes them as a block frame
+    auto write_block() noexcept -> result<void>;
+    // compressed blocks mustn't split records, i.e. the buffer grows until
+    // the block is closed at the next record boundary
+    auto grow_block(std::size_t requestedSize) noexcept -> result<void>;
+    // io_uring and direct mode can only write from the buffer, compressed
+    // containers need to compress everything
+    [[nodiscard]] auto writes_through_buffer() const noexcept -> bool
+    {
+        return mAsyncWriter.is_valid() || mIoMode == file_sink_io_mode::direct
+               || mCodec != block_codec::none;
+    }
+    auto copy_through_buffer(std::byte const *src, std::size_t srcSize) noexcept
+            -> result<void>;
+
+    // issues a sync if the durability policy asks for one
+    auto persist_if_due() noexcept -> result<void>;
+
     auto resize(std::size_t requestedSize) noexcept -> result<void>;
     auto do_grow(size_type requestedSize) noexcept -> result<void> final;
     auto do_bulk_write(std::byte const *src, std::size_t srcSize) noexcept
@@ -169,6 +400,9 @@ struct dplx::make<dplx::dlog::db_file_sink_backend>
     std::size_t target_buffer_size;
     dlog::file_sink_id sink_id;
     dlog::cbor_attribute_map attributes;
+    dlog::file_sink_io_mode io_mode = dlog::file_sink_io_mode::sync;
+    dlog::file_sink_durability durability = {};
+    dlog::block_codec codec = dlog::block_codec::none;
 
     auto operator()() const noexcept -> result<dlog::db_file_sink_backend>;
 };
@@ -212,6 +446,9 @@ public:
 private:
     explicit db_file_sink_backend(std::size_t targetBufferSize,
                                   dlog::cbor_attribute_map attributes,
+                                  file_sink_io_mode ioMode,
+                                  file_sink_durability durability,
+                                  block_codec codec,
                                   std::uint64_t maxFileSize,
                                   std::string fileNamePattern,
                                   file_sink_id sinkId) noexcept;
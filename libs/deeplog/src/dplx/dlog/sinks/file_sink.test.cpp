@@ -0,0 +1,217 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/sinks/file_sink.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_dir.hpp"
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+static_assert(dlog::gather_sink_backend<dlog::file_sink_backend>);
+static_assert(dlog::gather_sink_backend<dlog::db_file_sink_backend>);
+
+TEST_CASE("file_sink_backend writes gathered pieces")
+{
+    constexpr std::size_t bufferSize = 4096U;
+    auto const fileName = make_file_name(__FILE__, "dlog");
+    auto createRx = dplx::make<dlog::file_sink_backend>{
+            .base = test_dir,
+            .path = fileName,
+            .target_buffer_size = bufferSize,
+            .attributes = {},
+    }();
+    REQUIRE(createRx);
+    auto &&backend = std::move(createRx).assume_value();
+    auto fileRx = backend.clone_backing_file_handle();
+    REQUIRE(fileRx);
+    auto &&file = std::move(fileRx).assume_value();
+    auto const headerSize = file.maximum_extent().value();
+
+    std::vector<std::byte> const large(bufferSize, std::byte{0x2a});
+    std::array<std::byte, 8U> const small{};
+
+    SECTION("small batches are buffered")
+    {
+        std::array<dlog::bytes, 2U> const pieces{small, small};
+        REQUIRE(backend.write_gathered(pieces));
+        CHECK(file.maximum_extent().value() == headerSize);
+
+        REQUIRE(backend.sync_output());
+        CHECK(file.maximum_extent().value() == headerSize + 2 * small.size());
+    }
+    SECTION("large batches are written directly")
+    {
+        std::array<dlog::bytes, 1U> const first{small};
+        REQUIRE(backend.write_gathered(first));
+
+        std::array<dlog::bytes, 3U> const pieces{large, small, large};
+        REQUIRE(backend.write_gathered(pieces));
+        CHECK(file.maximum_extent().value()
+              == headerSize + 2 * small.size() + 2 * large.size());
+    }
+
+    REQUIRE(backend.finalize());
+}
+
+TEST_CASE("file_sink_backend writes the same container in every io mode")
+{
+    constexpr std::size_t bufferSize = 4096U;
+    std::vector<std::byte> const payload(3 * bufferSize + 7U, std::byte{0x2a});
+
+    auto const writeContainer
+            = [&](dlog::file_sink_io_mode ioMode) -> result<std::uint32_t> {
+        DPLX_TRY(auto &&backend,
+                 dplx::make<dlog::file_sink_backend>{
+                         .base = test_dir,
+                         .path = make_file_name(__FILE__, "dlog"),
+                         .target_buffer_size = bufferSize,
+                         .attributes = {},
+                         .io_mode = ioMode,
+                 }());
+        REQUIRE(backend.bulk_write(payload));
+        REQUIRE(backend.sync_output());
+        // rewrites the partial page in direct mode
+        REQUIRE(backend.bulk_write(payload.data(), 5U));
+        REQUIRE(backend.sync_output());
+        REQUIRE(backend.bulk_write(payload.data(), 5U));
+        return backend.finalize();
+    };
+    auto const expectedSize
+            = writeContainer(dlog::file_sink_io_mode::sync).value();
+
+    SECTION("io_uring")
+    {
+        // falls back to sync writes if io_uring isn't available
+        auto const writeRx = writeContainer(dlog::file_sink_io_mode::io_uring);
+        REQUIRE(writeRx);
+        CHECK(writeRx.assume_value() == expectedSize);
+    }
+    SECTION("direct")
+    {
+        auto const writeRx = writeContainer(dlog::file_sink_io_mode::direct);
+        if (writeRx.has_error()
+            && writeRx.assume_error() == system_error::errc::invalid_argument)
+        {
+            SKIP("the file system doesn't support O_DIRECT");
+        }
+        REQUIRE(writeRx);
+        CHECK(writeRx.assume_value() == expectedSize);
+    }
+}
+
+namespace
+{
+
+struct durability_case
+{
+    char const *name;
+    dlog::file_sink_io_mode io_mode;
+    dlog::file_sink_durability durability;
+};
+
+auto durability_cases() -> std::vector<durability_case>
+{
+    using namespace std::chrono_literals;
+    using dlog::durability_mode;
+    using dlog::file_sink_io_mode;
+    return {
+            {"none", file_sink_io_mode::sync, {}},
+            {"periodic", file_sink_io_mode::sync,
+             {.mode = durability_mode::periodic,
+              .interval = 10ms,
+              .byte_interval = 1U << 20}},
+            {"on_severity", file_sink_io_mode::sync,
+             {.mode = durability_mode::on_severity,
+              .min_severity = dlog::severity::error}},
+            {"per_batch", file_sink_io_mode::sync,
+             {.mode = durability_mode::per_batch}},
+            {"per_batch background", file_sink_io_mode::sync,
+             {.mode = durability_mode::per_batch, .background = true}},
+            {"per_batch io_uring", file_sink_io_mode::io_uring,
+             {.mode = durability_mode::per_batch}},
+    };
+}
+
+auto make_durable_backend(durability_case const &which)
+        -> result<dlog::file_sink_backend>
+{
+    return dplx::make<dlog::file_sink_backend>{
+            .base = test_dir,
+            .path = make_file_name(__FILE__, "dlog"),
+            .target_buffer_size = 0U,
+            .attributes = {},
+            .io_mode = which.io_mode,
+            .durability = which.durability,
+    }();
+}
+
+} // namespace
+
+TEST_CASE("file_sink_backend durability modes don't alter the container")
+{
+    std::vector<std::byte> const payload(1000U, std::byte{0x2a});
+    std::uint32_t expectedSize = 0U;
+    for (auto const &which : durability_cases())
+    {
+        INFO(which.name);
+        auto createRx = make_durable_backend(which);
+        REQUIRE(createRx);
+        auto &&backend = std::move(createRx).assume_value();
+        for (int i = 0; i < 3; ++i)
+        {
+            REQUIRE(backend.bulk_write(payload));
+            backend.observe_severity(dlog::severity::fatal);
+            REQUIRE(backend.sync_output());
+        }
+        auto finalizeRx = backend.finalize();
+        REQUIRE(finalizeRx);
+        if (expectedSize == 0U)
+        {
+            expectedSize = finalizeRx.assume_value();
+        }
+        CHECK(finalizeRx.assume_value() == expectedSize);
+    }
+}
+
+TEST_CASE("file_sink_backend drain latency per durability mode",
+          "[.][benchmark]")
+{
+    constexpr int recordsPerDrain = 64;
+    std::vector<std::byte> const record(128U, std::byte{0x2a});
+
+    for (auto const &which : durability_cases())
+    {
+        auto createRx = make_durable_backend(which);
+        REQUIRE(createRx);
+        auto &&backend = std::move(createRx).assume_value();
+
+        // a drain of 64 records, i.e. records per second = 64 / mean
+        BENCHMARK(which.name)
+        {
+            for (int i = 0; i < recordsPerDrain; ++i)
+            {
+                (void)backend.bulk_write(record);
+            }
+            backend.observe_severity(dlog::severity::error);
+            return backend.sync_output().has_value();
+        };
+        REQUIRE(backend.finalize());
+    }
+}
+
+} // namespace dlog_tests
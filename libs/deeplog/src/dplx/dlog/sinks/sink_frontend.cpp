@@ -7,47 +7,121 @@
 
 #include "dplx/dlog/sinks/sink_frontend.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 #include <dplx/dp/streams/output_buffer.hpp>
 
-namespace dplx::dlog::detail
-{
+#include <dplx/dlog/log_fabric.hpp>
 
-namespace
+namespace dplx::dlog::detail
 {
 
-struct copy_message_fn
+auto gather_messages(std::span<serialized_message_info const> const &messages,
+                     severity const threshold,
+                     std::span<bytes, max_gather_pieces> const pieces) noexcept
+        -> gathered_messages
 {
-    // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
-    dp::output_buffer &out;
-    severity threshold;
-
-    inline auto operator()(serialized_info_base const &message) const
-            -> result<void>
+    gathered_messages gathered{0U, 0U, 0U};
+    for (auto const &message : messages)
     {
-        return out.bulk_write(message.raw_data);
+        if (auto const *const record = get_if<serialized_record_info>(&message);
+            record == nullptr || record->message_severity >= threshold)
+        {
+            auto const rawData = visit(
+                    [](serialized_info_base const &info) {
+                        return info.raw_data;
+                    },
+                    message);
+            if (!rawData.empty())
+            {
+                if (gathered.num_pieces == max_gather_pieces)
+                {
+                    break;
+                }
+                pieces[gathered.num_pieces++] = rawData;
+            }
+            gathered.size += rawData.size();
+        }
+        gathered.num_messages += 1U;
     }
-    inline auto operator()(serialized_record_info const &message) const
-            -> result<void>
+    return gathered;
+}
+
+auto summarize_messages(
+        std::span<serialized_message_info const> const &messages,
+        severity const threshold) noexcept -> message_batch_info
+{
+    message_batch_info batch{
+            .num_records = 0U,
+            .max_severity = severity::none,
+            .first_timestamp = log_clock::time_point::max(),
+            .last_timestamp = log_clock::time_point::min(),
+    };
+    for (auto const &message : messages)
     {
-        if (message.message_severity >= threshold)
+        auto const *const record = get_if<serialized_record_info>(&message);
+        if (record == nullptr || record->message_severity < threshold)
         {
-            return out.bulk_write(message.raw_data);
+            continue;
         }
-        return outcome::success();
+        batch.num_records += 1U;
+        batch.max_severity = std::max(batch.max_severity,
+                                      record->message_severity);
+        batch.first_timestamp
+                = std::min(batch.first_timestamp, record->timestamp);
+        batch.last_timestamp = std::max(batch.last_timestamp, record->timestamp);
     }
-};
-
-} // namespace
+    return batch;
+}
 
 auto concate_messages(dp::output_buffer &out,
                       std::span<serialized_message_info const> const &messages,
                       severity const threshold) noexcept -> result<void>
 {
-    for (auto const &message : messages)
+    bytes pieces[max_gather_pieces];
+    for (auto remaining = messages; !remaining.empty();)
     {
-        DPLX_TRY(visit(copy_message_fn{out, threshold}, message));
+        auto const gathered
+                = detail::gather_messages(remaining, threshold, pieces);
+        remaining = remaining.subspan(gathered.num_messages);
+
+        // pieces which fit into the remaining output buffer are copied with
+        // a single commit instead of a bulk_write() per message.
+        auto const gatheredPieces
+                = std::span<bytes const>(pieces, gathered.num_pieces);
+        if (gathered.size <= out.size())
+        {
+            auto *dest = out.data();
+            for (auto const piece : gatheredPieces)
+            {
+                std::memcpy(dest, piece.data(), piece.size());
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                dest += piece.size();
+            }
+            out.commit_written(gathered.size);
+            continue;
+        }
+        for (auto const piece : gatheredPieces)
+        {
+            DPLX_TRY(out.bulk_write(piece));
+        }
     }
     return outcome::success();
 }
 
 } // namespace dplx::dlog::detail
+
+namespace dplx::dlog
+{
+
+void sink_frontend_base::clear_last_status() noexcept
+{
+    mLastStatus = {};
+    if (mOwner != nullptr)
+    {
+        mOwner->update_sink_threshold();
+    }
+}
+
+} // namespace dplx::dlog
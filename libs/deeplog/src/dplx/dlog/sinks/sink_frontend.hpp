@@ -15,6 +15,7 @@
 #include <dplx/dp/fwd.hpp>
 #include <dplx/make.hpp>
 
+#include <dplx/dlog/concepts.hpp>
 #include <dplx/dlog/core/serialized_messages.hpp>
 #include <dplx/dlog/core/strong_types.hpp>
 #include <dplx/dlog/fwd.hpp>
@@ -22,23 +23,75 @@
 namespace dplx::dlog::detail
 {
 
+class log_fabric_base;
+
+inline constexpr std::size_t max_gather_pieces = 64U;
+
+struct gathered_messages
+{
+    // the number of messages which have been processed
+    std::size_t num_messages;
+    std::size_t num_pieces;
+    // the number of bytes referenced by the pieces
+    std::size_t size;
+};
+
+// collects the raw data of the messages passing the threshold into pieces,
+// one per message (the bus framing separates the messages in memory, i.e.
+// they are never contiguous). Stops early if it runs out of pieces.
+auto gather_messages(std::span<serialized_message_info const> const &messages,
+                     severity threshold,
+                     std::span<bytes, max_gather_pieces> pieces) noexcept
+        -> gathered_messages;
+
+// summarizes the records passing the threshold
+struct message_batch_info
+{
+    std::size_t num_records;
+    // the highest record severity or severity::none
+    severity max_severity;
+    // the earliest and latest record timestamp, first > last if the batch
+    // doesn't contain any record
+    log_clock::time_point first_timestamp;
+    log_clock::time_point last_timestamp;
+};
+
+auto summarize_messages(
+        std::span<serialized_message_info const> const &messages,
+        severity threshold) noexcept -> message_batch_info;
+
+// a backend which wants to be notified about the records it has written, e.g.
+// to maintain an index
+template <typename Backend>
+concept batch_observing_backend
+        = requires(Backend &backend, message_batch_info const &batch) {
+              { backend.observe_batch(batch) } -> cncr::tryable;
+          };
+
 auto concate_messages(dp::output_buffer &out,
                       std::span<serialized_message_info const> const &messages,
                       severity threshold) noexcept -> result<void>;
 
-}
+} // namespace dplx::dlog::detail
 
 namespace dplx::dlog
 {
 
 class sink_frontend_base
 {
+    friend class detail::log_fabric_base;
+
 protected:
     // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
     system_error2::system_code mLastStatus;
     severity mThreshold;
     // NOLINTEND(cppcoreguidelines-non-private-member-variables-in-classes)
 
+private:
+    // the fabric the sink is attached to, it needs to recompute its sink
+    // threshold if the sink becomes active again
+    detail::log_fabric_base *mOwner;
+
 public:
     virtual ~sink_frontend_base() = default;
 
@@ -53,7 +106,7 @@ protected:
     explicit sink_frontend_base(severity threshold) noexcept
         : mLastStatus{}
         , mThreshold(threshold)
-
+        , mOwner{}
     {
     }
 
@@ -75,6 +128,10 @@ public:
         mLastStatus = std::move(consumeRx).assume_error();
         return false;
     }
+    [[nodiscard]] auto threshold() const noexcept -> severity
+    {
+        return mThreshold;
+    }
     [[nodiscard]] auto is_active() const noexcept -> bool
     {
         return mThreshold < detail::disable_threshold && !mLastStatus.failure();
@@ -116,10 +173,8 @@ public:
     {
         return mLastStatus;
     }
-    void clear_last_status() noexcept
-    {
-        mLastStatus = {};
-    }
+    // reactivates a failed sink
+    void clear_last_status() noexcept;
 
 private:
     virtual auto
@@ -191,7 +246,27 @@ private:
             -> result<void> override
     {
         (void)binarySize;
-        DPLX_TRY(detail::concate_messages(mBackend, messages, mThreshold));
+        if constexpr (gather_sink_backend<Backend>)
+        {
+            bytes pieces[detail::max_gather_pieces];
+            for (auto remaining = messages; !remaining.empty();)
+            {
+                auto const gathered = detail::gather_messages(
+                        remaining, mThreshold, pieces);
+                remaining = remaining.subspan(gathered.num_messages);
+                DPLX_TRY(mBackend.write_gathered(
+                        std::span<bytes const>(pieces, gathered.num_pieces)));
+            }
+        }
+        else
+        {
+            DPLX_TRY(detail::concate_messages(mBackend, messages, mThreshold));
+        }
+        if constexpr (detail::batch_observing_backend<Backend>)
+        {
+            DPLX_TRY(mBackend.observe_batch(
+                    detail::summarize_messages(messages, mThreshold)));
+        }
         return outcome::success();
     }
     auto do_sync() noexcept -> result<void> override
@@ -0,0 +1,156 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/sinks/sink_frontend.hpp"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <dplx/dp/streams/output_buffer.hpp>
+
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+namespace
+{
+
+// collects everything written to it through a small intermediate buffer
+template <std::size_t BufferSize>
+class collecting_output_buffer final : public dp::output_buffer
+{
+    std::array<std::byte, BufferSize> mBuffer{};
+
+public:
+    std::vector<std::byte> written;
+    int numBulkWrites{};
+
+    collecting_output_buffer() noexcept
+    {
+        reset(mBuffer.data(), mBuffer.size());
+    }
+
+    auto content() -> std::vector<std::byte> const &
+    {
+        (void)sync_output();
+        return written;
+    }
+
+private:
+    void flush_buffer()
+    {
+        written.insert(written.end(), mBuffer.data(),
+                       mBuffer.data() + (mBuffer.size() - size()));
+        reset(mBuffer.data(), mBuffer.size());
+    }
+    auto do_grow(size_type) noexcept -> result<void> override
+    {
+        flush_buffer();
+        return outcome::success();
+    }
+    auto do_bulk_write(std::byte const *src, std::size_t srcSize) noexcept
+            -> result<void> override
+    {
+        numBulkWrites += 1;
+        flush_buffer();
+        written.insert(written.end(), src, src + srcSize);
+        return outcome::success();
+    }
+    auto do_sync_output() noexcept -> result<void> override
+    {
+        flush_buffer();
+        return outcome::success();
+    }
+};
+
+auto make_record(dlog::bytes rawData,
+                 dlog::severity sev,
+                 dlog::log_clock::time_point timestamp = {})
+        -> dlog::serialized_message_info
+{
+    return dlog::serialized_record_info{{rawData}, timestamp, sev};
+}
+
+} // namespace
+
+TEST_CASE("concate_messages writes the messages passing the threshold")
+{
+    std::array<std::byte, 12U> memory{};
+    for (std::size_t i = 0U; i < memory.size(); ++i)
+    {
+        memory[i] = static_cast<std::byte>(i);
+    }
+    dlog::bytes const all(memory);
+    std::array<dlog::serialized_message_info, 4U> const messages{
+            make_record(all.subspan(0U, 3U), dlog::severity::warn),
+            make_record(all.subspan(3U, 2U), dlog::severity::info),
+            make_record(all.subspan(6U, 2U), dlog::severity::debug),
+            dlog::serialized_span_end_info{{all.subspan(9U, 3U)}},
+    };
+    std::vector<std::byte> const expected{
+            std::byte{0}, std::byte{1}, std::byte{2},  std::byte{3},
+            std::byte{4}, std::byte{9}, std::byte{10}, std::byte{11},
+    };
+
+    SECTION("one piece is gathered per message")
+    {
+        std::array<dlog::bytes, dlog::detail::max_gather_pieces> pieces{};
+        auto const gathered = dlog::detail::gather_messages(
+                messages, dlog::severity::info, pieces);
+        CHECK(gathered.num_messages == messages.size());
+        CHECK(gathered.num_pieces == 3U);
+        CHECK(gathered.size == expected.size());
+    }
+    SECTION("with enough buffer space")
+    {
+        collecting_output_buffer<64U> out;
+        REQUIRE(dlog::detail::concate_messages(out, messages,
+                                               dlog::severity::info));
+        CHECK(out.numBulkWrites == 0);
+        CHECK(out.content() == expected);
+    }
+    SECTION("with a buffer smaller than the run")
+    {
+        collecting_output_buffer<4U> out;
+        REQUIRE(dlog::detail::concate_messages(out, messages,
+                                               dlog::severity::info));
+        CHECK(out.content() == expected);
+    }
+}
+
+TEST_CASE("summarize_messages only considers the records passing the threshold")
+{
+    using dlog::log_clock;
+    auto const at = [](log_clock::rep ticks) {
+        return log_clock::time_point(log_clock::duration(ticks));
+    };
+    std::array<dlog::serialized_message_info, 4U> const messages{
+            make_record({}, dlog::severity::warn, at(20U)),
+            make_record({}, dlog::severity::info, at(10U)),
+            make_record({}, dlog::severity::debug, at(5U)),
+            dlog::serialized_span_end_info{{}},
+    };
+
+    auto const batch
+            = dlog::detail::summarize_messages(messages, dlog::severity::info);
+    CHECK(batch.num_records == 2U);
+    CHECK(batch.max_severity == dlog::severity::warn);
+    CHECK(batch.first_timestamp == at(10U));
+    CHECK(batch.last_timestamp == at(20U));
+
+    auto const empty
+            = dlog::detail::summarize_messages(messages, dlog::severity::error);
+    CHECK(empty.num_records == 0U);
+    CHECK(empty.max_severity == dlog::severity::none);
+    CHECK(empty.first_timestamp > empty.last_timestamp);
+}
+
+} // namespace dlog_tests
@@ -0,0 +1,120 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/source/context_attributes.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include <dplx/dp.hpp>
+#include <dplx/dp/api.hpp>
+#include <dplx/dp/streams/memory_output_stream.hpp>
+
+namespace dplx::dlog
+{
+
+auto context_attributes::merge(context_attributes const *parent,
+                               detail::attribute_args const &attrs) noexcept
+        -> result<context_attributes>
+try
+{
+    std::span<resource_id const> const ids(attrs.ids, attrs.num_attributes);
+    auto const isOverridden = [ids](entry const &e) {
+        return std::ranges::find(ids, e.id) != ids.end();
+    };
+
+    dp::void_stream voidOut;
+    dp::emit_context sizeCtx{voidOut};
+    std::size_t encodedSize
+            = detail::encoded_size_of_attributes(sizeCtx, attrs);
+    std::size_t numEntries = attrs.num_attributes;
+    if (parent != nullptr)
+    {
+        for (auto const &e : parent->mEntries)
+        {
+            if (!isOverridden(e))
+            {
+                encodedSize += e.size;
+                numEntries += 1U;
+            }
+        }
+    }
+    if (encodedSize > std::numeric_limits<std::uint32_t>::max()
+        || numEntries > std::numeric_limits<std::uint_least16_t>::max())
+    {
+        return errc::invalid_argument;
+    }
+
+    context_attributes self;
+    self.mSerialized.resize(encodedSize);
+    self.mEntries.reserve(numEntries);
+
+    std::size_t offset = 0U;
+    if (parent != nullptr)
+    {
+        for (auto const &e : parent->mEntries)
+        {
+            if (isOverridden(e))
+            {
+                continue;
+            }
+            std::memcpy(self.mSerialized.data() + offset,
+                        parent->mSerialized.data() + e.offset, e.size);
+            self.mEntries.push_back(
+                    {e.id, static_cast<std::uint32_t>(offset), e.size});
+            offset += e.size;
+        }
+    }
+
+    dp::memory_output_stream ostream(
+            std::span<std::byte>(self.mSerialized).subspan(offset));
+    dp::emit_context ctx{ostream};
+    for (std::uint_least16_t i = 0U; i < attrs.num_attributes; ++i)
+    {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        detail::attribute_args const single{
+                attrs.attributes + i,
+                attrs.attribute_types + i,
+                attrs.ids + i,
+                1U,
+        };
+        auto const entrySize
+                = detail::encoded_size_of_attributes(sizeCtx, single);
+        DPLX_TRY(detail::encode_attributes(ctx, single));
+        self.mEntries.push_back({attrs.ids[i],
+                                 static_cast<std::uint32_t>(offset),
+                                 static_cast<std::uint32_t>(entrySize)});
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        offset += entrySize;
+    }
+    return self;
+}
+catch (std::bad_alloc const &)
+{
+    return errc::not_enough_memory;
+}
+
+attribute_scope::attribute_scope(log_context &ctx,
+                                 detail::attribute_args const &attrs) noexcept
+    : mContext{}
+    , mPrevious{ctx.attributes()}
+    , mAttributes{}
+{
+    // logging must not fail due to attributes, i.e. we simply keep the
+    // enclosing attributes if the merge fails.
+    if (auto mergeRx = context_attributes::merge(mPrevious, attrs);
+        mergeRx.has_value())
+    {
+        mAttributes = std::move(mergeRx).assume_value();
+        mContext = &ctx;
+        mContext->attributes(&mAttributes);
+    }
+}
+
+} // namespace dplx::dlog
@@ -0,0 +1,172 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include <dplx/dp/streams/output_buffer.hpp>
+
+#include <dplx/dlog/attributes.hpp>
+#include <dplx/dlog/config.hpp>
+#include <dplx/dlog/core/strong_types.hpp>
+#include <dplx/dlog/disappointment.hpp>
+#include <dplx/dlog/source/log_context.hpp>
+
+namespace dplx::dlog
+{
+
+// A set of attributes which is attached to a log_context and therefore
+// applies to every record written through it (also known as MDC). The
+// attributes are serialized once on construction; records splice the
+// resulting bytes into their attribute map.
+class context_attributes
+{
+    struct entry
+    {
+        resource_id id;
+        std::uint32_t offset;
+        std::uint32_t size;
+    };
+
+    std::vector<std::byte> mSerialized;
+    std::vector<entry> mEntries;
+
+public:
+    context_attributes() noexcept = default;
+
+    template <typename... Attrs>
+        requires(... && attribute<std::remove_cvref_t<Attrs>>)
+    static auto from(Attrs &&...attrs) noexcept -> result<context_attributes>
+    {
+        return context_attributes::merge(
+                nullptr,
+                detail::stack_attribute_args<std::remove_cvref_t<Attrs>...>{
+                        attrs...});
+    }
+
+    // creates a set which contains the attributes of the parent set which
+    // aren't overridden by the given attributes and the given attributes.
+    static auto merge(context_attributes const *parent,
+                      detail::attribute_args const &attrs) noexcept
+            -> result<context_attributes>;
+
+    // the encoded map entries (without a map head)
+    [[nodiscard]] auto bytes() const noexcept -> std::span<std::byte const>
+    {
+        return mSerialized;
+    }
+    [[nodiscard]] auto size() const noexcept -> std::uint_least16_t
+    {
+        return static_cast<std::uint_least16_t>(mEntries.size());
+    }
+    [[nodiscard]] auto empty() const noexcept -> bool
+    {
+        return mEntries.empty();
+    }
+
+    struct splice_info
+    {
+        std::uint64_t encoded_size;
+        unsigned num_entries;
+    };
+    // the entries which are spliced into the attribute map of a record, i.e.
+    // the entries overridden by a record attribute are skipped.
+    template <typename Overridden>
+    [[nodiscard]] auto splice_size(Overridden const &isOverridden) const noexcept
+            -> splice_info
+    {
+        splice_info info{mSerialized.size(), size()};
+        for (auto const &e : mEntries)
+        {
+            if (isOverridden(e.id))
+            {
+                info.encoded_size -= e.size;
+                info.num_entries -= 1U;
+            }
+        }
+        return info;
+    }
+    template <typename Overridden>
+    auto splice(dp::output_buffer &out,
+                Overridden const &isOverridden) const noexcept -> result<void>
+    {
+        if (std::ranges::none_of(mEntries, [&isOverridden](entry const &e) {
+                return isOverridden(e.id);
+            }))
+        {
+            return out.bulk_write(mSerialized.data(), mSerialized.size());
+        }
+        for (auto const &e : mEntries)
+        {
+            if (!isOverridden(e.id))
+            {
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                DPLX_TRY(out.bulk_write(mSerialized.data() + e.offset,
+                                        e.size));
+            }
+        }
+        return outcome::success();
+    }
+};
+
+// attaches a context_attributes set to a log_context for the lifetime of the
+// scope. The attributes of the enclosing scope are inherited.
+class [[nodiscard]] attribute_scope
+{
+    log_context *mContext;
+    context_attributes const *mPrevious;
+    context_attributes mAttributes;
+
+public:
+    ~attribute_scope() noexcept
+    {
+        if (mContext != nullptr)
+        {
+            mContext->attributes(mPrevious);
+        }
+    }
+    attribute_scope() noexcept
+        : mContext{}
+        , mPrevious{}
+        , mAttributes{}
+    {
+    }
+
+    attribute_scope(attribute_scope const &) = delete;
+    auto operator=(attribute_scope const &) -> attribute_scope & = delete;
+
+    attribute_scope(attribute_scope &&) = delete;
+    auto operator=(attribute_scope &&) -> attribute_scope & = delete;
+
+    template <typename... Attrs>
+        requires(... && attribute<Attrs>)
+    explicit attribute_scope(log_context &ctx, Attrs const &...attrs) noexcept
+        : attribute_scope(ctx, detail::stack_attribute_args<Attrs...>{attrs...})
+    {
+    }
+#if !DPLX_DLOG_DISABLE_IMPLICIT_CONTEXT
+    template <typename... Attrs>
+        requires(... && attribute<Attrs>)
+    explicit attribute_scope(Attrs const &...attrs) noexcept
+        : attribute_scope(detail::active_context(),
+                          detail::stack_attribute_args<Attrs...>{attrs...})
+    {
+    }
+#endif
+
+private:
+    attribute_scope(log_context &ctx,
+                    detail::attribute_args const &attrs) noexcept;
+};
+
+} // namespace dplx::dlog
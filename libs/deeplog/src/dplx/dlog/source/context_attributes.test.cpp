@@ -0,0 +1,153 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/source/context_attributes.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <dplx/dp/api.hpp>
+#include <dplx/dp/items/parse_core.hpp>
+#include <dplx/dp/items/skip_item.hpp>
+#include <dplx/dp/streams/memory_input_stream.hpp>
+
+#include <dplx/dlog/bus/buffer_bus.hpp>
+#include <dplx/dlog/bus/mpsc_bus.hpp>
+#include <dplx/dlog/log_fabric.hpp>
+#include <dplx/dlog/macros.hpp>
+
+#include "test_dir.hpp"
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+namespace
+{
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+using request_id = dlog::basic_attribute_ref<dlog::resource_id{1000},
+                                             u8"test.request_id",
+                                             std::uint64_t>;
+using peer = dlog::basic_attribute_ref<dlog::resource_id{1001},
+                                       u8"test.peer",
+                                       std::string_view>;
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+} // namespace
+
+TEST_CASE("context_attributes overrides the attributes of its parent")
+{
+    auto parentRx = dlog::context_attributes::from(request_id{1U},
+                                                   peer{"localhost"});
+    REQUIRE(parentRx);
+    auto const &parent = parentRx.assume_value();
+    CHECK(parent.size() == 2U);
+    CHECK(!parent.bytes().empty());
+
+    auto mergedRx = dlog::context_attributes::merge(
+            &parent, dlog::detail::stack_attribute_args<request_id>{
+                             request_id{2U}});
+    REQUIRE(mergedRx);
+    auto const &merged = mergedRx.assume_value();
+    CHECK(merged.size() == 2U);
+    CHECK(merged.bytes().size() == parent.bytes().size());
+}
+
+TEST_CASE("attribute_scope attaches its attributes to the log_context")
+{
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric core{dlog::mpsc_bus(test_dir, "context_attributes.dmsb",
+                                         4U, regionSize)
+                                  .value()};
+    dlog::log_context ctx{core};
+
+    {
+        dlog::attribute_scope outer(ctx, peer{"localhost"});
+        REQUIRE(ctx.attributes() != nullptr);
+        CHECK(ctx.attributes()->size() == 1U);
+        {
+            dlog::attribute_scope inner(ctx, request_id{42U});
+            REQUIRE(ctx.attributes() != nullptr);
+            CHECK(ctx.attributes()->size() == 2U);
+
+            DLOG_TO(ctx, dlog::severity::warn, "scoped msg with arg {}", 1);
+            DLOG_TO(ctx, dlog::severity::warn, "scoped msg with attributes",
+                    dlog::make_attributes(request_id{43U}));
+        }
+        CHECK(ctx.attributes()->size() == 1U);
+    }
+    CHECK(ctx.attributes() == nullptr);
+
+    auto retireRx = core.retire_log_records();
+    REQUIRE(retireRx);
+    CHECK(retireRx.assume_value() == 0);
+}
+
+TEST_CASE("record attributes take precedence over context attributes")
+{
+    dlog::log_fabric core{
+            dlog::bufferbus(test_dir, TEST_FILE_BB, small_buffer_bus_size)
+                    .value(),
+            dlog::severity::trace};
+    dlog::log_context ctx{core};
+    {
+        dlog::attribute_scope scope(ctx, request_id{42U}, peer{"localhost"});
+        DLOG_TO(ctx, dlog::severity::warn, "overridden",
+                dlog::make_attributes(request_id{43U}));
+    }
+
+    std::vector<std::vector<std::byte>> messages;
+    REQUIRE(core.message_bus().consume_messages(
+            [&messages](std::span<dlog::bytes const> msgs) {
+                for (auto const msg : msgs)
+                {
+                    messages.emplace_back(msg.begin(), msg.end());
+                }
+            }));
+    REQUIRE(messages.size() == 1U);
+
+    auto &&buffer = dp::get_input_buffer(messages.front());
+    dp::parse_context parseCtx{buffer};
+    // skip everything but the attribute map
+    REQUIRE(dp::expect_item_head(parseCtx, dp::type_code::array, 6U));
+    for (int i = 0; i < 5; ++i) // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+    {
+        REQUIRE(dp::skip_item(parseCtx));
+    }
+    auto mapHeadRx = dp::parse_item_head(parseCtx);
+    REQUIRE(mapHeadRx);
+    REQUIRE(mapHeadRx.assume_value().type == dp::type_code::map);
+
+    int numRequestIds = 0;
+    int numPeers = 0;
+    for (std::uint64_t i = 0U; i < mapHeadRx.assume_value().value; ++i)
+    {
+        auto keyRx = dp::decode(dp::as_value<std::uint64_t>, parseCtx);
+        REQUIRE(keyRx);
+        if (keyRx.assume_value() == static_cast<std::uint64_t>(request_id::id))
+        {
+            numRequestIds += 1;
+            auto valueRx = dp::decode(dp::as_value<std::uint64_t>, parseCtx);
+            REQUIRE(valueRx);
+            CHECK(valueRx.assume_value() == 43U);
+            continue;
+        }
+        numPeers += static_cast<int>(keyRx.assume_value()
+                                     == static_cast<std::uint64_t>(peer::id));
+        REQUIRE(dp::skip_item(parseCtx));
+    }
+    CHECK(numRequestIds == 1);
+    CHECK(numPeers == 1);
+}
+
+} // namespace dlog_tests
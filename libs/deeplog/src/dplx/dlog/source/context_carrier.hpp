@@ -0,0 +1,233 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <string_view>
+#include <utility>
+
+#include <dplx/dlog/attributes.hpp>
+#include <dplx/dlog/config.hpp>
+#include <dplx/dlog/source/context_attributes.hpp>
+#include <dplx/dlog/source/log_context.hpp>
+#include <dplx/dlog/source/span_scope.hpp>
+
+namespace dplx::dlog
+{
+
+// Carries a log_context across the suspension points of a coroutine or the
+// hops of an executor task. It is meant to be stored in the coroutine frame
+// (or task) and to be installed as the active thread context around each
+// resumption; installing and uninstalling are a pair of moves.
+//
+// While the carrier is installed the thread context is the authoritative
+// copy, i.e. context() always refers to the state which is currently in use.
+//
+// The context attributes are owned by an attribute_scope which the carrier
+// usually outlives, therefore the carrier keeps a copy of them.
+class context_carrier
+{
+    context_attributes mAttributes;
+    log_context mContext;
+    log_context mSaved;
+    log_context *mInstalledIn;
+
+public:
+    ~context_carrier() noexcept
+    {
+        uninstall();
+    }
+    explicit context_carrier(log_context &&ctx) noexcept
+        : mAttributes()
+        , mContext(std::move(ctx))
+        , mSaved()
+        , mInstalledIn(nullptr)
+    {
+        own_attributes();
+    }
+    explicit context_carrier(log_context const &ctx) noexcept
+        : mAttributes()
+        , mContext(ctx)
+        , mSaved()
+        , mInstalledIn(nullptr)
+    {
+        own_attributes();
+    }
+#if !DPLX_DLOG_DISABLE_IMPLICIT_CONTEXT
+    // captures the active thread context
+    context_carrier() noexcept
+        : context_carrier(std::as_const(detail::active_context()))
+    {
+    }
+#endif
+
+    context_carrier(context_carrier const &) = delete;
+    auto operator=(context_carrier const &) -> context_carrier & = delete;
+
+    // spans opened on the carrier refer to it, i.e. it must not move.
+    context_carrier(context_carrier &&) = delete;
+    auto operator=(context_carrier &&) -> context_carrier & = delete;
+
+    // a plain span_scope opened on the returned context refers to it, i.e.
+    // it must be closed before the carrier is installed or uninstalled; use
+    // an async_span_scope for spans which outlive a resumption.
+    [[nodiscard]] auto context() noexcept -> log_context &
+    {
+        return mInstalledIn != nullptr ? *mInstalledIn : mContext;
+    }
+    [[nodiscard]] auto installed() const noexcept -> bool
+    {
+        return mInstalledIn != nullptr;
+    }
+
+#if !DPLX_DLOG_DISABLE_IMPLICIT_CONTEXT
+    class [[nodiscard]] resumption_scope
+    {
+        context_carrier *mCarrier;
+
+    public:
+        ~resumption_scope() noexcept
+        {
+            mCarrier->uninstall();
+        }
+        explicit resumption_scope(context_carrier &carrier) noexcept
+            : mCarrier(&carrier)
+        {
+            mCarrier->install();
+        }
+
+        resumption_scope(resumption_scope const &) = delete;
+        auto operator=(resumption_scope const &)
+                -> resumption_scope & = delete;
+
+        resumption_scope(resumption_scope &&) = delete;
+        auto operator=(resumption_scope &&) -> resumption_scope & = delete;
+    };
+
+    // makes the carried context the active thread context until the
+    // returned scope is destroyed (e.g. on the next suspension).
+    auto resume() noexcept -> resumption_scope
+    {
+        return resumption_scope(*this);
+    }
+
+    void install() noexcept
+    {
+        if (mInstalledIn != nullptr)
+        {
+            return;
+        }
+        mInstalledIn = &detail::active_context();
+        mSaved = std::move(*mInstalledIn);
+        *mInstalledIn = std::move(mContext);
+    }
+#endif
+    void uninstall() noexcept
+    {
+        if (mInstalledIn == nullptr)
+        {
+            return;
+        }
+        mContext = std::move(*mInstalledIn);
+        *mInstalledIn = std::move(mSaved);
+        mInstalledIn = nullptr;
+    }
+
+private:
+    void own_attributes() noexcept
+    {
+        auto const *const attributes = mContext.attributes();
+        if (attributes == nullptr)
+        {
+            return;
+        }
+        // logging must not fail due to attributes, i.e. they are dropped if
+        // they can't be copied.
+        auto copyRx = context_attributes::merge(
+                attributes, detail::stack_attribute_args<>{});
+        if (copyRx.has_value())
+        {
+            mAttributes = std::move(copyRx).assume_value();
+            mContext.attributes(&mAttributes);
+        }
+        else
+        {
+            mContext.attributes(nullptr);
+        }
+    }
+};
+
+// A span_scope which is owned by a coroutine frame and may therefore be
+// closed on a different thread than it has been opened on. The span is
+// closed on the context the carrier currently refers to.
+class [[nodiscard]] async_span_scope
+{
+    context_carrier *mCarrier;
+    span_scope mScope;
+
+public:
+    ~async_span_scope() noexcept
+    {
+        mScope.rebind(mCarrier->context());
+    }
+
+    template <typename... Attrs>
+        requires(... && attribute<Attrs>)
+    explicit async_span_scope(
+            context_carrier &carrier,
+            std::string_view name,
+            Attrs const &...attrs,
+            span_kind kind
+            = span_kind::internal DPLX_DLOG_DETAIL_ATTR_FUNCTION_DEF) noexcept
+        : mCarrier(&carrier)
+        , mScope(span_scope::do_open(
+                  carrier.context(), name, carrier.context().span(), kind,
+                  make_attributes(attrs... DPLX_DLOG_DETAIL_ATTR_FUNCTION_USE)))
+    {
+    }
+
+    // see span_scope::open_deferred()
+    static auto open_deferred(context_carrier &carrier,
+                              std::string_view name,
+                              span_kind kind = span_kind::internal
+                                      DPLX_DLOG_DETAIL_FUNCTION_NAME_DEF) noexcept
+            -> async_span_scope
+    {
+        return async_span_scope(carrier, name,
+                                kind DPLX_DLOG_DETAIL_FUNCTION_NAME_USE,
+                                deferred_tag{});
+    }
+
+    async_span_scope(async_span_scope const &) = delete;
+    auto operator=(async_span_scope const &) -> async_span_scope & = delete;
+
+    async_span_scope(async_span_scope &&) = delete;
+    auto operator=(async_span_scope &&) -> async_span_scope & = delete;
+
+    [[nodiscard]] auto context() const noexcept -> span_context
+    {
+        return mScope.context();
+    }
+
+private:
+    struct deferred_tag
+    {
+    };
+    async_span_scope(context_carrier &carrier,
+                     std::string_view name,
+                     span_kind kind,
+                     std::string_view function,
+                     deferred_tag) noexcept
+        : mCarrier(&carrier)
+        , mScope(span_scope::do_open_deferred(carrier.context(), name,
+                                              carrier.context().span(), kind,
+                                              function))
+    {
+    }
+};
+
+} // namespace dplx::dlog
@@ -0,0 +1,124 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/source/context_carrier.hpp"
+
+#include <optional>
+#include <string_view>
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <dplx/dlog/bus/mpsc_bus.hpp>
+#include <dplx/dlog/log_fabric.hpp>
+#include <dplx/dlog/source/context_attributes.hpp>
+
+#include "test_dir.hpp"
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+static_assert(!std::is_move_constructible_v<dlog::context_carrier>);
+static_assert(!std::is_move_constructible_v<dlog::async_span_scope>);
+
+TEST_CASE("an async_span_scope can be closed on the carrier context")
+{
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "context_carrier.dmsb", 4U, regionSize)
+                    .value()};
+    dlog::context_carrier carrier{dlog::log_context{core}};
+
+    std::optional<dlog::async_span_scope> span;
+    span.emplace(carrier, "async");
+    auto const spanContext = span->context();
+    CHECK(spanContext.spanId != dlog::span_id::invalid());
+    CHECK(carrier.context().span() == spanContext);
+
+    span.reset();
+    CHECK(carrier.context().span() == dlog::span_context{});
+}
+
+TEST_CASE("a deferred async_span_scope can be closed on the carrier context")
+{
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "context_carrier3.dmsb", 4U, regionSize)
+                    .value()};
+    dlog::context_carrier carrier{dlog::log_context{core}};
+
+    {
+        auto span = dlog::async_span_scope::open_deferred(carrier, "async");
+        CHECK(span.context().spanId != dlog::span_id::invalid());
+        CHECK(carrier.context().span() == span.context());
+        CHECK(carrier.context().deferred_span() != nullptr);
+    }
+    CHECK(carrier.context().span() == dlog::span_context{});
+    CHECK(carrier.context().deferred_span() == nullptr);
+}
+
+TEST_CASE("a context_carrier owns a copy of the context attributes")
+{
+    using peer = dlog::basic_attribute_ref<
+            dlog::resource_id{1001}, // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+            u8"test.peer", std::string_view>;
+
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "context_carrier4.dmsb", 4U, regionSize)
+                    .value()};
+    dlog::log_context ctx{core};
+
+    std::optional<dlog::context_carrier> carrier;
+    {
+        dlog::attribute_scope scope(ctx, peer{"localhost"});
+        carrier.emplace(ctx);
+        REQUIRE(carrier->context().attributes() != nullptr);
+        CHECK(carrier->context().attributes() != ctx.attributes());
+    }
+    REQUIRE(carrier->context().attributes() != nullptr);
+    CHECK(carrier->context().attributes()->size() == 1U);
+}
+
+#if !DPLX_DLOG_DISABLE_IMPLICIT_CONTEXT
+TEST_CASE("a context_carrier can be resumed on another thread")
+{
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "context_carrier2.dmsb", 4U, regionSize)
+                    .value()};
+    auto const previous = dlog::set_thread_context(dlog::log_context{});
+    dlog::context_carrier carrier{dlog::log_context{core}};
+
+    std::optional<dlog::async_span_scope> span;
+    {
+        auto resumption = carrier.resume();
+        CHECK(carrier.installed());
+        CHECK(dlog::detail::active_context().port() == &core);
+        span.emplace(carrier, "async");
+        CHECK(dlog::detail::active_context().span() == span->context());
+    }
+    CHECK(!carrier.installed());
+    CHECK(dlog::detail::active_context().port() == nullptr);
+    CHECK(carrier.context().span() == span->context());
+
+    std::thread([&] {
+        auto resumption = carrier.resume();
+        CHECK(dlog::detail::active_context().span() == span->context());
+        span.reset();
+        CHECK(dlog::detail::active_context().span() == dlog::span_context{});
+    }).join();
+
+    // the span has been closed on the other thread's context
+    CHECK(dlog::detail::active_context().span() == dlog::span_context{});
+    CHECK(carrier.context().span() == dlog::span_context{});
+    (void)dlog::set_thread_context(previous);
+}
+#endif
+
+} // namespace dlog_tests
@@ -7,6 +7,10 @@
 
 #include "dplx/dlog/source/log.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <span>
+
 #include <dplx/dp/api.hpp>
 #include <dplx/dp/items/emit_core.hpp>
 #include <dplx/dp/items/emit_ranges.hpp>
@@ -17,6 +21,8 @@
 
 #include <dplx/dlog/attributes.hpp>
 #include <dplx/dlog/core/log_clock.hpp>
+#include <dplx/dlog/core/serialized_messages.hpp>
+#include <dplx/dlog/source/context_attributes.hpp>
 #include <dplx/dlog/source/record_output_buffer.hpp>
 
 auto dplx::dp::codec<dplx::dlog::detail::trivial_string_view>::size_of(
@@ -150,6 +156,187 @@ auto dplx::dp::codec<dplx::dlog::detail::trivial_system_code_view>::encode(
     return outcome::success();
 }
 
+auto dplx::dp::codec<dplx::dlog::detail::reified_blob>::decode(
+        dp::parse_context &ctx, dlog::detail::reified_blob &blob) noexcept
+        -> result<void>
+{
+    DPLX_TRY(dp::parse_binary(ctx, blob.mBytes));
+    return outcome::success();
+}
+
+auto dplx::dp::codec<dplx::dlog::detail::trivial_blob_view>::size_of(
+        dp::emit_context &ctx,
+        dlog::detail::trivial_blob_view const blob) noexcept -> std::uint64_t
+{
+    return dp::item_size_of_binary(ctx, blob.size);
+}
+
+auto dplx::dp::codec<dplx::dlog::detail::trivial_blob_view>::encode(
+        dp::emit_context &ctx,
+        dlog::detail::trivial_blob_view const blob) noexcept -> result<void>
+{
+    return dp::emit_binary(ctx, blob.data, blob.size);
+}
+
+auto dplx::dp::codec<dplx::dlog::detail::reified_typed_array>::decode(
+        dp::parse_context &ctx,
+        dlog::detail::reified_typed_array &array) noexcept -> result<void>
+{
+    DPLX_TRY(dp::item_head tagHead, dp::parse_item_head(ctx));
+    if (tagHead.type != dp::type_code::tag) [[unlikely]]
+    {
+        return dp::errc::item_type_mismatch;
+    }
+    auto const elementSize
+            = dlog::detail::typed_array_element_size(tagHead.value);
+    if (elementSize == 0U) [[unlikely]]
+    {
+        return dp::errc::item_type_mismatch;
+    }
+
+    DPLX_TRY(dp::parse_binary(ctx, array.mBytes));
+    if (array.mBytes.size() % elementSize != 0U) [[unlikely]]
+    {
+        return dp::errc::bad;
+    }
+    array.mTag = tagHead.value;
+    return outcome::success();
+}
+
+auto dplx::dp::codec<dplx::dlog::detail::trivial_typed_array_view>::size_of(
+        dp::emit_context &ctx,
+        dlog::detail::trivial_typed_array_view const array) noexcept
+        -> std::uint64_t
+{
+    return dp::encoded_item_head_size<dp::type_code::tag>(array.tag)
+           + dp::item_size_of_binary(ctx, array.size);
+}
+
+auto dplx::dp::codec<dplx::dlog::detail::trivial_typed_array_view>::encode(
+        dp::emit_context &ctx,
+        dlog::detail::trivial_typed_array_view const array) noexcept
+        -> result<void>
+{
+    // the elements are stored in native byte order which is recorded by the
+    // tag, i.e. the payload can be copied verbatim
+    DPLX_TRY(dp::emit_tag(ctx, array.tag));
+    return dp::emit_binary(ctx, array.data, array.size);
+}
+
+namespace dplx::dlog::detail
+{
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+auto typed_array_element_size(std::uint64_t const tag) noexcept -> std::size_t
+{
+    constexpr std::uint64_t tagLimit = typed_array_tag_base + 24U;
+    if (tag < typed_array_tag_base || tag >= tagLimit)
+    {
+        return 0U;
+    }
+    auto const log2Size = static_cast<unsigned>(tag & 0b11U);
+    if ((tag & typed_array_tag_float_bit) != 0U)
+    {
+        // binary16 and binary128 are not supported
+        return log2Size == 1U || log2Size == 2U ? std::size_t{2U} << log2Size
+                                                : 0U;
+    }
+    if ((tag & typed_array_tag_signed_bit) != 0U
+        && (tag & typed_array_tag_little_endian_bit) != 0U && log2Size == 0U)
+    {
+        // reserved
+        return 0U;
+    }
+    return std::size_t{1U} << log2Size;
+}
+
+namespace
+{
+
+template <typename T>
+auto format_typed_array_elements(fmt::format_context::iterator out,
+                                 std::span<std::byte const> const bytes,
+                                 bool const swapBytes)
+        -> fmt::format_context::iterator
+{
+    *out++ = '[';
+    for (std::size_t i = 0U; i < bytes.size(); i += sizeof(T))
+    {
+        std::byte raw[sizeof(T)];
+        std::memcpy(static_cast<std::byte *>(raw), bytes.subspan(i).data(),
+                    sizeof(T));
+        if (swapBytes)
+        {
+            std::ranges::reverse(raw);
+        }
+        T value;
+        std::memcpy(&value, static_cast<std::byte const *>(raw), sizeof(T));
+
+        if (i != 0U)
+        {
+            *out++ = ',';
+            *out++ = ' ';
+        }
+        out = fmt::format_to(out, "{}", value);
+    }
+    *out++ = ']';
+    return out;
+}
+
+} // namespace
+
+auto format_typed_array(fmt::format_context::iterator out,
+                        reified_typed_array const &array)
+        -> fmt::format_context::iterator
+{
+    constexpr bool nativeLittleEndian
+            = std::endian::native == std::endian::little;
+    std::span<std::byte const> const bytes(array.mBytes);
+    bool const isLittleEndian
+            = (array.mTag & typed_array_tag_little_endian_bit) != 0U;
+    bool const swapBytes = isLittleEndian != nativeLittleEndian;
+    bool const isSigned = (array.mTag & typed_array_tag_signed_bit) != 0U;
+
+    if ((array.mTag & typed_array_tag_float_bit) != 0U)
+    {
+        return typed_array_element_size(array.mTag) == sizeof(float)
+                       ? format_typed_array_elements<float>(out, bytes,
+                                                            swapBytes)
+                       : format_typed_array_elements<double>(out, bytes,
+                                                             swapBytes);
+    }
+    switch (typed_array_element_size(array.mTag))
+    {
+    case 1U:
+        return isSigned ? format_typed_array_elements<std::int8_t>(out, bytes,
+                                                                   false)
+                        : format_typed_array_elements<std::uint8_t>(out, bytes,
+                                                                    false);
+    case 2U:
+        return isSigned ? format_typed_array_elements<std::int16_t>(
+                                 out, bytes, swapBytes)
+                        : format_typed_array_elements<std::uint16_t>(
+                                 out, bytes, swapBytes);
+    case 4U:
+        return isSigned ? format_typed_array_elements<std::int32_t>(
+                                 out, bytes, swapBytes)
+                        : format_typed_array_elements<std::uint32_t>(
+                                 out, bytes, swapBytes);
+    case 8U:
+        return isSigned ? format_typed_array_elements<std::int64_t>(
+                                 out, bytes, swapBytes)
+                        : format_typed_array_elements<std::uint64_t>(
+                                 out, bytes, swapBytes);
+    default:
+        return fmt::format_to(out, "<invalid typed array>");
+    }
+}
+
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+} // namespace dplx::dlog::detail
+
 auto dplx::dlog::detail::erased_loggable_ref::emit_reification_prefix(
         dp::emit_context &ctx, reification_type_id id) noexcept
         -> result<std::uint64_t>
@@ -251,100 +438,111 @@ inline auto encode_any_loggable(dp::emit_context &ctx,
 // NOLINTEND(cppcoreguidelines-pro-type-union-access)
 // NOLINTEND(cppcoreguidelines-macro-usage)
 
-} // namespace
-
-// NOLINTNEXTLINE(readability-function-cognitive-complexity)
-auto vlog(log_context const &logCtx, log_args const &args) noexcept
-        -> result<void>
+// the record attributes take precedence over the context attributes, i.e. a
+// record must not contain an attribute map with duplicate keys.
+class record_attribute_overrides
 {
-    if (args.sev == severity::none) [[unlikely]]
+    std::span<resource_id const> mUserAttributeIds;
+    bool mHasLine;
+    bool mHasFileName;
+
+public:
+    record_attribute_overrides(std::span<resource_id const> userAttributeIds,
+                               bool hasLine,
+                               bool hasFileName) noexcept
+        : mUserAttributeIds(userAttributeIds)
+        , mHasLine(hasLine)
+        , mHasFileName(hasFileName)
     {
-        return outcome::success();
     }
-    constexpr severity severity_max{24};
-    if (args.sev > severity_max) [[unlikely]]
+
+    auto operator()(resource_id const id) const noexcept -> bool
     {
-        return errc::invalid_argument;
+        return (mHasLine && id == attr::line::id)
+            || (mHasFileName && id == attr::file::id)
+            || std::ranges::find(mUserAttributeIds, id)
+                       != mUserAttributeIds.end();
     }
+};
 
-    // layout:
-    // array 6
-    // +  ui    severity
-    // +  arr?  owner
-    // +  ui64  timestamp
-    // +  str   message
-    // +  array format args
-    // +  map   attributes
-
-    constexpr auto numArrayElements = 6U;
-    constexpr auto timestampSize = 9U;
-    auto const timeStamp = log_clock::now();
-    bool const hasLine = args.location.line >= 0;
-    bool const hasFileName = args.location.filenameSize >= 0;
-    unsigned const numAttributes = static_cast<unsigned>(hasLine)
-                                   + static_cast<unsigned>(hasFileName);
+} // namespace
+
+// the record frame layout is documented alongside preparse_messages() which
+// relies on the fixed offsets of its head.
+
+auto encoded_size_of_record_frame(
+        log_context const &logCtx,
+        log_args const &args,
+        std::span<resource_id const> const userAttributeIds) noexcept
+        -> std::uint64_t
+{
     dp::void_stream voidOut;
     dp::emit_context sizeCtx{voidOut};
 
-    // compute buffer size
     constexpr auto encodedArraySize
             = dp::encoded_item_head_size<dp::type_code::array>(
-                    numArrayElements);
-    constexpr auto encodedMetaSize = /*severity:*/ 1U + timestampSize;
+                    record_num_array_elements);
+    constexpr auto encodedMetaSize = /*severity:*/ 1U + record_timestamp_size;
 
-    auto encodedSize
-            = static_cast<unsigned>(encodedArraySize + encodedMetaSize);
+    std::uint64_t encodedSize = encodedArraySize + encodedMetaSize;
 
     encodedSize += /* ctx array/tuple prefix */ 1U;
     auto const instrumentationScope = logCtx.instrumentation_scope();
     encodedSize += instrumentationScope.empty()
                            ? 0U
-                           : static_cast<unsigned>(dp::item_size_of_u8string(
-                                     sizeCtx, instrumentationScope.size()));
-    auto const ownerId = logCtx.span();
-    auto const hasOwnerSpan = ownerId.spanId != span_id::invalid();
-    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
-    encodedSize += hasOwnerSpan ? 17U + 9U : 0U;
+                           : dp::item_size_of_u8string(
+                                     sizeCtx, instrumentationScope.size());
+    encodedSize += logCtx.span().spanId != span_id::invalid()
+                           ? record_owner_span_size
+                           : 0U;
 
-    encodedSize += static_cast<unsigned>(
-            dp::item_size_of_u8string(sizeCtx, args.message.size()));
+    encodedSize += dp::item_size_of_u8string(sizeCtx, args.message.size());
 
-    encodedSize += static_cast<unsigned>(
-            dp::encoded_item_head_size<dp::type_code::array>(
-                    args.num_arguments));
-    for (unsigned i = 0; i < args.num_arguments; ++i)
+    encodedSize += dp::encoded_item_head_size<dp::type_code::array>(
+            args.num_arguments);
+
+    bool const hasLine = args.location.line >= 0;
+    bool const hasFileName = args.location.filenameSize >= 0;
+    auto const *const contextAttributes = logCtx.attributes();
+    unsigned numAttributes = static_cast<unsigned>(hasLine)
+                             + static_cast<unsigned>(hasFileName)
+                             + static_cast<unsigned>(userAttributeIds.size());
+    if (contextAttributes != nullptr)
     {
-        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-        encodedSize += static_cast<unsigned>(detail::item_size_of_any_loggable(
-                sizeCtx, args.part_types[i], args.message_parts[i]));
-        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        auto const spliced = contextAttributes->splice_size(
+                record_attribute_overrides(userAttributeIds, hasLine,
+                                           hasFileName));
+        numAttributes += spliced.num_entries;
+        encodedSize += spliced.encoded_size;
     }
-
-    encodedSize += 1U; // map with 0-2 entries
+    encodedSize += dp::encoded_item_head_size<dp::type_code::map>(
+            numAttributes);
     if (hasLine)
     {
         encodedSize += /* rid: */ 1U
-                       + static_cast<unsigned>(dp::item_size_of_integer(
-                               sizeCtx, args.location.line));
+                       + dp::item_size_of_integer(sizeCtx, args.location.line);
     }
     if (hasFileName)
     {
         encodedSize += /* rid: */ 1U
-                       + static_cast<unsigned>(dp::item_size_of_u8string(
-                               sizeCtx, args.location.filenameSize));
+                       + dp::item_size_of_u8string(sizeCtx,
+                                                   args.location.filenameSize);
     }
+    return encodedSize;
+}
 
-    // allocate an output buffer on the message bus
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
-    record_output_buffer_storage outStorage;
-    DPLX_TRY(auto *out, logCtx.port()->allocate_record_buffer_inplace(
-                                outStorage, encodedSize, ownerId.spanId));
-    record_output_guard outGuard(*out);
-
-    dp::emit_context ctx{*out};
+auto emit_record_frame_head(dp::emit_context &ctx,
+                            log_context const &logCtx,
+                            log_args const &args) noexcept -> result<void>
+{
+    auto const timeStamp = log_clock::now();
+    auto const instrumentationScope = logCtx.instrumentation_scope();
+    auto const ownerId = logCtx.span();
+    auto const hasOwnerSpan = ownerId.spanId != span_id::invalid();
 
-    // write to output buffer
-    (void)dp::emit_array(ctx, numArrayElements);
+    // the output buffer has been allocated with the exact record size,
+    // therefore we don't need to check the fixed size parts
+    (void)dp::emit_array(ctx, record_num_array_elements);
     // severity
     *ctx.out.data()
             = static_cast<std::byte>(static_cast<unsigned>(args.sev) - 1U);
@@ -352,8 +550,9 @@ auto vlog(log_context const &logCtx, log_args const &args) noexcept
     // logCtx
     ctx.out.data()[1] = static_cast<std::byte>(
             static_cast<unsigned>(dp::type_code::array)
-            | (instrumentationScope.data() != nullptr ? 1U : 0U)
-            | (hasOwnerSpan ? 2U : 0U));
+            | (instrumentationScope.data() != nullptr ? record_owner_scope_flag
+                                                      : 0U)
+            | (hasOwnerSpan ? record_owner_span_flag : 0U));
     ctx.out.commit_written(2U);
     if (instrumentationScope.data() != nullptr)
     {
@@ -370,18 +569,33 @@ auto vlog(log_context const &logCtx, log_args const &args) noexcept
     *ctx.out.data() = static_cast<std::byte>(27U); // NOLINT
     // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
     dp::detail::store(ctx.out.data() + 1, timeStamp.time_since_epoch().count());
-    ctx.out.commit_written(timestampSize);
+    ctx.out.commit_written(record_timestamp_size);
 
     // message
     (void)dp::emit_u8string(ctx, args.message.data(), args.message.size());
 
-    (void)dp::emit_array<unsigned>(ctx, args.num_arguments);
-    for (unsigned i = 0; i < args.num_arguments; ++i)
+    return dp::emit_array<unsigned>(ctx, args.num_arguments);
+}
+
+auto emit_record_frame_tail(
+        dp::emit_context &ctx,
+        log_context const &logCtx,
+        log_args const &args,
+        std::span<resource_id const> const userAttributeIds) noexcept
+        -> result<void>
+{
+    bool const hasLine = args.location.line >= 0;
+    bool const hasFileName = args.location.filenameSize >= 0;
+    auto const *const contextAttributes = logCtx.attributes();
+    record_attribute_overrides const isOverridden(userAttributeIds, hasLine,
+                                                  hasFileName);
+    unsigned numAttributes = static_cast<unsigned>(hasLine)
+                             + static_cast<unsigned>(hasFileName)
+                             + static_cast<unsigned>(userAttributeIds.size());
+    if (contextAttributes != nullptr)
     {
-        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-        DPLX_TRY(detail::encode_any_loggable(ctx, args.part_types[i],
-                                             args.message_parts[i]));
-        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        numAttributes += contextAttributes->splice_size(isOverridden)
+                                 .num_entries;
     }
 
     DPLX_TRY(dp::emit_map(ctx, numAttributes));
@@ -397,7 +611,74 @@ auto vlog(log_context const &logCtx, log_args const &args) noexcept
                 ctx, args.location.filename,
                 static_cast<std::size_t>(args.location.filenameSize)));
     }
+    if (contextAttributes != nullptr && !contextAttributes->empty())
+    {
+        // the context attributes have been pre-encoded
+        DPLX_TRY(contextAttributes->splice(ctx.out, isOverridden));
+    }
     return outcome::success();
 }
 
+auto vlog(log_context const &logCtx, log_args const &args) noexcept
+        -> result<void>
+{
+    return detail::vlog(logCtx, args, stack_attribute_args<>{});
+}
+
+auto vlog(log_context const &logCtx,
+          log_args const &args,
+          attribute_args const &attrs) noexcept -> result<void>
+{
+    if (args.sev == severity::none) [[unlikely]]
+    {
+        return outcome::success();
+    }
+    if (args.sev > record_severity_max) [[unlikely]]
+    {
+        return errc::invalid_argument;
+    }
+
+    logCtx.flush_deferred_span();
+
+    dp::void_stream voidOut;
+    dp::emit_context sizeCtx{voidOut};
+
+    // compute buffer size
+    std::span<resource_id const> const attributeIds(attrs.ids,
+                                                    attrs.num_attributes);
+    auto encodedSize
+            = detail::encoded_size_of_record_frame(logCtx, args, attributeIds);
+    for (unsigned i = 0; i < args.num_arguments; ++i)
+    {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        encodedSize += detail::item_size_of_any_loggable(
+                sizeCtx, args.part_types[i], args.message_parts[i]);
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    encodedSize += detail::encoded_size_of_attributes(sizeCtx, attrs);
+
+    // allocate an output buffer on the message bus
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
+    record_output_buffer_storage outStorage;
+    DPLX_TRY(auto *out,
+             logCtx.port()->allocate_record_buffer_inplace(
+                     outStorage, static_cast<std::size_t>(encodedSize),
+                     logCtx.span().spanId));
+    record_output_guard outGuard(*out);
+
+    dp::emit_context ctx{*out};
+
+    // write to output buffer
+    DPLX_TRY(detail::emit_record_frame_head(ctx, logCtx, args));
+    for (unsigned i = 0; i < args.num_arguments; ++i)
+    {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        DPLX_TRY(detail::encode_any_loggable(ctx, args.part_types[i],
+                                             args.message_parts[i]));
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    DPLX_TRY(detail::emit_record_frame_tail(ctx, logCtx, args, attributeIds));
+    return detail::encode_attributes(ctx, attrs);
+}
+
 } // namespace dplx::dlog::detail
@@ -7,8 +7,11 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <span>
+#include <utility>
 
 #if __cpp_lib_source_location >= 201'907L
 #include <source_location>
@@ -16,12 +19,16 @@
 
 #include <fmt/core.h>
 
+#include <dplx/dp/api.hpp>
+
+#include <dplx/dlog/attributes.hpp>
 #include <dplx/dlog/config.hpp>
 #include <dplx/dlog/core/strong_types.hpp>
 #include <dplx/dlog/detail/any_loggable_ref.hpp>
 #include <dplx/dlog/fwd.hpp>
 #include <dplx/dlog/loggable.hpp>
 #include <dplx/dlog/source/log_context.hpp>
+#include <dplx/dlog/source/record_output_buffer.hpp>
 
 namespace dplx::dlog::detail
 {
@@ -164,16 +171,344 @@ public:
 
 } // namespace dplx::dlog::detail
 
-namespace dplx::dlog
+namespace dplx::dlog::detail
 {
 
-namespace detail
-{
+inline constexpr severity record_severity_max{24};
 
 auto vlog(log_context const &logCtx, log_args const &args) noexcept
         -> result<void>;
+auto vlog(log_context const &logCtx,
+          log_args const &args,
+          attribute_args const &attrs) noexcept -> result<void>;
+
+// the record frame consists of everything but the format arguments and the
+// user attributes, i.e. the functions below allow to compose a record with a
+// custom argument encoder without duplicating the record layout.
+// The frame tail contains the location and context attributes; the user
+// attributes need to be encoded right after it. Context attributes which are
+// overridden by the record (user or location) attributes are omitted.
+auto encoded_size_of_record_frame(log_context const &logCtx,
+                                  log_args const &args,
+                                  std::span<resource_id const> userAttributeIds
+                                  = {}) noexcept -> std::uint64_t;
+auto emit_record_frame_head(dp::emit_context &ctx,
+                            log_context const &logCtx,
+                            log_args const &args) noexcept -> result<void>;
+auto emit_record_frame_tail(dp::emit_context &ctx,
+                            log_context const &logCtx,
+                            log_args const &args,
+                            std::span<resource_id const> userAttributeIds
+                            = {}) noexcept -> result<void>;
+
+struct encoded_static_prefix
+{
+    static constexpr std::size_t max_size = 1U + 9U;
+
+    std::byte bytes[max_size];
+    std::uint_least8_t size;
+};
+
+consteval void append_posint(encoded_static_prefix &prefix,
+                             std::uint64_t const value) noexcept
+{
+    constexpr unsigned inlineLimit = 24U;
+    constexpr unsigned byteBits = 8U;
+
+    if (value < inlineLimit)
+    {
+        prefix.bytes[prefix.size++] = static_cast<std::byte>(value);
+        return;
+    }
+
+    unsigned numBytes = 1U;
+    unsigned additionalInfo = inlineLimit;
+    while (numBytes < sizeof(std::uint64_t)
+           && (value >> (numBytes * byteBits)) != 0U)
+    {
+        numBytes *= 2U;
+        additionalInfo += 1U;
+    }
+    prefix.bytes[prefix.size++] = static_cast<std::byte>(additionalInfo);
+    for (unsigned i = numBytes; i > 0U; --i)
+    {
+        prefix.bytes[prefix.size++]
+                = static_cast<std::byte>(value >> ((i - 1U) * byteBits));
+    }
+}
+
+// precomputes the `[reification_type_id, ...` prefix of a format argument
+consteval auto make_reification_prefix(reification_type_id id) noexcept
+        -> encoded_static_prefix
+{
+    encoded_static_prefix prefix{
+            {static_cast<std::byte>(dp::type_code::array) | std::byte{2U}},
+            1U
+    };
+    detail::append_posint(prefix, static_cast<std::uint64_t>(id));
+    return prefix;
+}
+
+// precomputes the map key of an attribute
+consteval auto make_attribute_prefix(resource_id id) noexcept
+        -> encoded_static_prefix
+{
+    encoded_static_prefix prefix{{}, 0U};
+    detail::append_posint(prefix, static_cast<std::uint64_t>(id));
+    return prefix;
+}
+
+template <typename T>
+inline constexpr encoded_static_prefix reification_prefix_v
+        = detail::make_reification_prefix(effective_reification_tag_v<T>);
+
+template <attribute Attr>
+inline constexpr encoded_static_prefix attribute_prefix_v
+        = detail::make_attribute_prefix(Attr::id);
+
+DPLX_ATTR_FORCE_INLINE auto
+write_static_prefix(dp::emit_context &ctx,
+                    encoded_static_prefix const &prefix) noexcept
+        -> result<void>
+{
+    if (ctx.out.size() < prefix.size) [[unlikely]]
+    {
+        DPLX_TRY(ctx.out.ensure_size(prefix.size));
+    }
+    std::memcpy(ctx.out.data(), static_cast<std::byte const *>(prefix.bytes),
+                prefix.size);
+    ctx.out.commit_written(prefix.size);
+    return outcome::success();
+}
+
+// maps the argument to the type which would have been stored in an
+// any_loggable_ref_storage, but without erasing it.
+template <typename T>
+DPLX_ATTR_FORCE_INLINE constexpr auto
+as_typed_loggable(T const &value) noexcept -> decltype(auto)
+{
+    constexpr auto storageId = any_loggable_ref_storage_tag<T>;
+    if constexpr (storageId == any_loggable_ref_storage_id::thunk)
+    {
+        return (value);
+    }
+    else
+    {
+        return any_loggable_ref_storage_type_of_t<storageId>(value);
+    }
+}
+
+// recovers the statically typed attribute value from its stack_attribute_args
+// storage, i.e. the inverse of the type erasure.
+template <attribute Attr>
+DPLX_ATTR_FORCE_INLINE constexpr auto
+as_typed_attribute(any_loggable_ref_storage const &storage) noexcept
+        -> decltype(auto)
+{
+    using value_type = typename Attr::type;
+    constexpr auto storageId = any_loggable_ref_storage_tag<value_type>;
+    if constexpr (storageId == any_loggable_ref_storage_id::thunk)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-union-access)
+        return *static_cast<value_type const *>(storage.thunk.self);
+    }
+    else
+    {
+        return detail::get<storageId>(storage);
+    }
+}
+
+template <typename T>
+DPLX_ATTR_FORCE_INLINE auto item_size_of_typed_loggable(dp::emit_context &ctx,
+                                                        T const &value) noexcept
+        -> std::uint64_t
+{
+    return reification_prefix_v<T>.size
+           + dp::encoded_size_of(ctx, detail::as_typed_loggable(value));
+}
+
+template <typename T>
+DPLX_ATTR_FORCE_INLINE auto encode_typed_loggable(dp::emit_context &ctx,
+                                                  T const &value) noexcept
+        -> result<void>
+{
+    DPLX_TRY(detail::write_static_prefix(ctx, reification_prefix_v<T>));
+    return dp::encode(ctx, detail::as_typed_loggable(value));
+}
+
+template <attribute Attr>
+DPLX_ATTR_FORCE_INLINE auto
+item_size_of_typed_attribute(dp::emit_context &ctx,
+                             any_loggable_ref_storage const &storage) noexcept
+        -> std::uint64_t
+{
+    return attribute_prefix_v<Attr>.size
+           + dp::encoded_size_of(ctx,
+                                 detail::as_typed_attribute<Attr>(storage));
+}
+
+template <attribute Attr>
+DPLX_ATTR_FORCE_INLINE auto
+encode_typed_attribute(dp::emit_context &ctx,
+                       any_loggable_ref_storage const &storage) noexcept
+        -> result<void>
+{
+    DPLX_TRY(detail::write_static_prefix(ctx, attribute_prefix_v<Attr>));
+    return dp::encode(ctx, detail::as_typed_attribute<Attr>(storage));
+}
+
+template <attribute... Attrs, std::size_t... Is>
+DPLX_ATTR_FORCE_INLINE auto
+encoded_size_of_typed_attributes(dp::emit_context &ctx,
+                                 stack_attribute_args<Attrs...> const &attrs,
+                                 std::index_sequence<Is...>) noexcept
+        -> std::uint64_t
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    return (std::uint64_t{} + ...
+            + detail::item_size_of_typed_attribute<Attrs>(ctx,
+                                                          attrs.values[Is]));
+}
+
+template <attribute... Attrs, std::size_t... Is>
+DPLX_ATTR_FORCE_INLINE auto
+encode_typed_attributes(dp::emit_context &ctx,
+                        stack_attribute_args<Attrs...> const &attrs,
+                        std::index_sequence<Is...>) noexcept -> result<void>
+{
+    result<void> encodeRx = outcome::success();
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    (void)(... && (encodeRx = detail::encode_typed_attribute<Attrs>(
+                           ctx, attrs.values[Is]))
+                          .has_value());
+    return encodeRx;
+}
+
+// writes a record by allocating it directly from the given port or bus. The
+// port must hand out output buffers of type OutputBuffer, i.e. passing the
+// final output buffer type of a bus devirtualizes the commit.
+template <typename OutputBuffer,
+          typename Port,
+          attribute... Attrs,
+          typename... Args>
+inline auto tlog_to(Port &port,
+                    log_context const &logCtx,
+                    log_args const &frame,
+                    stack_attribute_args<Attrs...> const &attrs,
+                    Args const &...args) noexcept -> result<void>
+{
+    static_assert(sizeof...(Attrs) <= UINT_LEAST16_MAX);
+    std::span<resource_id const> const attributeIds(attrs.ids,
+                                                    attrs.num_attributes);
+    constexpr auto attributeIndices = std::index_sequence_for<Attrs...>{};
+
+    if (frame.sev == severity::none) [[unlikely]]
+    {
+        return outcome::success();
+    }
+    if (frame.sev > record_severity_max) [[unlikely]]
+    {
+        return errc::invalid_argument;
+    }
+
+    logCtx.flush_deferred_span();
+
+    dp::void_stream voidOut;
+    dp::emit_context sizeCtx{voidOut};
+    auto const encodedSize
+            = detail::encoded_size_of_record_frame(logCtx, frame,
+                                                   attributeIds)
+              + (std::uint64_t{} + ...
+                 + detail::item_size_of_typed_loggable(sizeCtx, args))
+              + detail::encoded_size_of_typed_attributes(sizeCtx, attrs,
+                                                         attributeIndices);
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
+    record_output_buffer_storage outStorage;
+    DPLX_TRY(auto *allocated,
+             port.allocate_record_buffer_inplace(
+                     outStorage, static_cast<std::size_t>(encodedSize),
+                     logCtx.span().spanId));
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-static-cast-downcast)
+    auto *const out = static_cast<OutputBuffer *>(allocated);
+    record_output_guard outGuard(*out);
+
+    dp::emit_context ctx{*out};
+    DPLX_TRY(detail::emit_record_frame_head(ctx, logCtx, frame));
+
+    result<void> encodeRx = outcome::success();
+    (void)(... && (encodeRx = detail::encode_typed_loggable(ctx, args))
+                          .has_value());
+    if (encodeRx.has_error()) [[unlikely]]
+    {
+        return encodeRx;
+    }
+    DPLX_TRY(detail::emit_record_frame_tail(ctx, logCtx, frame,
+                                            attributeIds));
+    return detail::encode_typed_attributes(ctx, attrs, attributeIndices);
+}
+
+// the statically typed counterpart of vlog() which generates a specialized
+// encoder for each argument pack and therefore avoids the type switch.
+template <attribute... Attrs, typename... Args>
+inline auto tlog(log_context const &logCtx,
+                 log_args const &frame,
+                 stack_attribute_args<Attrs...> const &attrs,
+                 Args const &...args) noexcept -> result<void>
+{
+    return detail::tlog_to<record_output_buffer>(*logCtx.port(), logCtx,
+                                                 frame, attrs, args...);
+}
+
+template <attribute... Attrs, typename... Args>
+DPLX_ATTR_FORCE_INLINE auto
+dispatch_log(log_context const &ctx,
+             severity sev,
+             fmt::string_view message,
+#if DPLX_DLOG_USE_SOURCE_LOCATION
+             std::source_location const &location,
+#else
+             detail::log_location const &location,
+#endif
+             stack_attribute_args<Attrs...> const &attrs,
+             Args const &...args) noexcept -> result<void>
+{
+#if DPLX_DLOG_USE_TYPE_ERASED_LOG
+    if constexpr (sizeof...(Attrs) == 0U)
+    {
+        return detail::vlog(ctx, detail::stack_log_args<Args...>{
+                                         message, sev, location, args...});
+    }
+    else
+    {
+        return detail::vlog(ctx,
+                            detail::stack_log_args<Args...>{message, sev,
+                                                            location, args...},
+                            attrs);
+    }
+#else
+    return detail::tlog(ctx,
+                        log_args{
+                                message,
+                                nullptr,
+                                nullptr,
+#if DPLX_DLOG_USE_SOURCE_LOCATION
+                                detail::from_source_location(location),
+#else
+                                location,
+#endif
+                                static_cast<std::uint_least16_t>(
+                                        sizeof...(Args)),
+                                sev,
+                        },
+                        attrs, args...);
+#endif
+}
+
+} // namespace dplx::dlog::detail
 
-} // namespace detail
+namespace dplx::dlog
+{
 
 template <typename... Args>
     requires(... && loggable<Args>)
@@ -193,8 +528,8 @@ log(log_context const &ctx,
         return outcome::success();
     }
 
-    return detail::vlog(ctx, detail::stack_log_args<Args...>{
-                                     message, sev, location, args...});
+    return detail::dispatch_log(ctx, sev, message, location,
+                                detail::stack_attribute_args<>{}, args...);
 }
 
 template <typename... Args>
@@ -216,8 +551,53 @@ log(log_record_port &port,
         return outcome::success();
     }
 
-    return detail::vlog(ctx, detail::stack_log_args<Args...>{
-                                     message, sev, location, args...});
+    return detail::dispatch_log(ctx, sev, message, location,
+                                detail::stack_attribute_args<>{}, args...);
+}
+
+template <attribute... Attrs, typename... Args>
+    requires(... && loggable<Args>)
+[[nodiscard]] inline auto
+log(log_context const &ctx,
+    severity sev,
+    fmt::format_string<reification_type_of_t<Args>...> message,
+#if DPLX_DLOG_USE_SOURCE_LOCATION
+    std::source_location const &location,
+#else
+    detail::log_location const &location,
+#endif
+    detail::stack_attribute_args<Attrs...> const &attrs,
+    Args const &...args) noexcept -> result<void>
+{
+    if (sev < ctx.threshold()) [[unlikely]]
+    {
+        return outcome::success();
+    }
+
+    return detail::dispatch_log(ctx, sev, message, location, attrs, args...);
+}
+
+template <attribute... Attrs, typename... Args>
+    requires(... && loggable<Args>)
+[[nodiscard]] inline auto
+log(log_record_port &port,
+    severity sev,
+    fmt::format_string<reification_type_of_t<Args>...> message,
+#if DPLX_DLOG_USE_SOURCE_LOCATION
+    std::source_location const &location,
+#else
+    detail::log_location const &location,
+#endif
+    detail::stack_attribute_args<Attrs...> const &attrs,
+    Args const &...args) noexcept -> result<void>
+{
+    log_context ctx(port);
+    if (sev < ctx.threshold()) [[unlikely]]
+    {
+        return outcome::success();
+    }
+
+    return detail::dispatch_log(ctx, sev, message, location, attrs, args...);
 }
 
 } // namespace dplx::dlog
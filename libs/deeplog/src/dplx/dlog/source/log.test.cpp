@@ -126,4 +126,85 @@ TEST_CASE("The logger can write a message with a custom type")
     CHECK(retireRx.assume_value() == 0);
 }
 
+TEST_CASE("reification prefixes are encoded as CBOR posints")
+{
+    using dlog::detail::make_reification_prefix;
+    using dlog::reification_type_id;
+
+    constexpr auto uint64Prefix
+            = make_reification_prefix(reification_type_id::uint64);
+    STATIC_REQUIRE(uint64Prefix.size == 2U);
+    STATIC_REQUIRE(uint64Prefix.bytes[0] == std::byte{0x82});
+
+    constexpr auto customPrefix
+            = dlog::detail::reification_prefix_v<custom_loggable>;
+    constexpr auto customId = static_cast<std::uint64_t>(
+            dlog::effective_reification_tag_v<custom_loggable>);
+    STATIC_REQUIRE(customId > 0xffU);
+    STATIC_REQUIRE(customPrefix.size == 4U);
+    STATIC_REQUIRE(customPrefix.bytes[1] == std::byte{0x19});
+    STATIC_REQUIRE(customPrefix.bytes[2] == std::byte(customId >> 8U));
+    STATIC_REQUIRE(customPrefix.bytes[3] == std::byte(customId & 0xffU));
+}
+
+TEST_CASE("The logger can write a message with mixed statically typed args")
+{
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "t4.dmsb", 4U, regionSize).value()};
+    dlog::log_context ctx{core};
+
+    DLOG_TO(ctx, dlog::severity::warn, "{} {} {} {} {}", -1, 0.5F, true,
+            std::string_view{"str"}, custom_loggable{});
+
+    auto retireRx = core.retire_log_records();
+    REQUIRE(retireRx);
+    CHECK(retireRx.assume_value() == 0);
+}
+
+TEST_CASE("The logger can write a message with a blob and a typed array")
+{
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "t5.dmsb", 4U, regionSize).value()};
+    dlog::log_context ctx{core};
+
+    std::byte const blob[] = {std::byte{0xde}, std::byte{0xad}};
+    float const samples[] = {0.5F, 1.0F, -2.0F};
+    DLOG_TO(ctx, dlog::severity::warn, "blob {} samples {}",
+            std::span<std::byte const>(blob), std::span<float const>(samples));
+
+    auto retireRx = core.retire_log_records();
+    REQUIRE(retireRx);
+    CHECK(retireRx.assume_value() == 0);
+}
+
+TEST_CASE("The logger can write a message with user attributes")
+{
+    // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+    using request_id = dlog::basic_attribute_ref<dlog::resource_id{1000},
+                                                 u8"test.request_id",
+                                                 std::uint64_t>;
+    using peer = dlog::basic_attribute_ref<dlog::resource_id{1001},
+                                           u8"test.peer",
+                                           std::string_view>;
+    // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+    STATIC_REQUIRE(dlog::detail::attribute_prefix_v<request_id>.size == 3U);
+
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "t6.dmsb", 4U, regionSize).value()};
+    dlog::log_context ctx{core};
+
+    DLOG_TO(ctx, dlog::severity::warn, "attributed msg with arg {}",
+            dlog::make_attributes(request_id{42U}, peer{"localhost"}), 1);
+    DLOG_TO(ctx, dlog::severity::warn, "attributed msg without args",
+            dlog::make_attributes(request_id{43U}));
+
+    auto retireRx = core.retire_log_records();
+    REQUIRE(retireRx);
+    CHECK(retireRx.assume_value() == 0);
+}
+
 } // namespace dlog_tests
@@ -9,4 +9,21 @@
 
 namespace dplx::dlog
 {
+
+auto log_context::refresh_threshold() const noexcept -> severity
+{
+    auto const generation = current_threshold_generation();
+    auto threshold = detail::disable_threshold;
+    if (mTargetPort != nullptr)
+    {
+        threshold = mInstrumentationScope.empty()
+                            ? mTargetPort->default_threshold()
+                            : mTargetPort->threshold(mInstrumentationScope);
+    }
+    // concurrent refreshes store equivalent states, i.e. last one wins
+    mThresholdState.store(pack_threshold(generation, threshold),
+                          std::memory_order_relaxed);
+    return threshold;
 }
+
+} // namespace dplx::dlog
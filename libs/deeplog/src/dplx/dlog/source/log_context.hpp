@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <string_view>
 #include <utility>
 
@@ -18,6 +20,13 @@
 #include <dplx/dlog/fwd.hpp>
 #include <dplx/dlog/source/log_record_port.hpp>
 
+namespace dplx::dlog::detail
+{
+
+void flush_deferred_span(span_scope &scope, log_record_port &port) noexcept;
+
+} // namespace dplx::dlog::detail
+
 namespace dplx::dlog
 {
 
@@ -40,42 +49,120 @@ public:
 
 class log_context
 {
-    severity mThresholdCache;
+    // the threshold generation (upper half) and the resolved threshold (lower
+    // half) are packed into a single word, i.e. the fast path is a single
+    // load. The cache is refreshed by const accessors, therefore it is a
+    // (relaxed) atomic: a const log_context may be shared across threads.
+    // The generation is sampled before the threshold is resolved, otherwise
+    // a concurrent reconfiguration might get lost.
+    mutable std::atomic<std::uint64_t> mThresholdState;
+    // raises the resolved threshold, e.g. within an unsampled trace; it is
+    // kept separately so that it survives threshold reconfigurations.
+    severity mThresholdOverride;
     log_record_port *mTargetPort;
     std::string_view mInstrumentationScope;
     span_context mCurrentSpan;
+    context_attributes const *mAttributes;
+    // a span whose start message is held back until a record or a child span
+    // is written within it, see span_scope::open_deferred()
+    mutable span_scope *mDeferredSpan;
 
 public:
     constexpr log_context() noexcept
-        : mThresholdCache{detail::disable_threshold}
+        : mThresholdState{pack_threshold(0U, detail::disable_threshold)}
+        , mThresholdOverride{severity::none}
         , mTargetPort{}
         , mInstrumentationScope{}
         , mCurrentSpan{}
+        , mAttributes{}
+        , mDeferredSpan{}
     {
     }
     explicit log_context(scope_name name) noexcept
-        : mThresholdCache{detail::disable_threshold}
+        : mThresholdState{pack_threshold(0U, detail::disable_threshold)}
+        , mThresholdOverride{severity::none}
         , mTargetPort{}
         , mInstrumentationScope(name)
         , mCurrentSpan{}
+        , mAttributes{}
+        , mDeferredSpan{}
     {
     }
     explicit log_context(log_record_port &targetPort,
                          span_context span = span_context{})
-        : mThresholdCache{targetPort.default_threshold()}
+        : mThresholdState{pack_threshold(current_threshold_generation(),
+                                         targetPort.default_threshold())}
+        , mThresholdOverride{severity::none}
         , mTargetPort(&targetPort)
         , mInstrumentationScope{}
         , mCurrentSpan(span)
+        , mAttributes{}
+        , mDeferredSpan{}
     {
     }
     explicit log_context(log_record_port &targetPort,
                          scope_name name,
                          span_context span = span_context{})
-        : mThresholdCache{targetPort.threshold(name)}
+        : mThresholdState{pack_threshold(current_threshold_generation(),
+                                         targetPort.threshold(name))}
+        , mThresholdOverride{severity::none}
         , mTargetPort(&targetPort)
         , mInstrumentationScope(name)
         , mCurrentSpan(span)
+        , mAttributes{}
+        , mDeferredSpan{}
+    {
+    }
+
+    // a copy doesn't inherit the deferred span because it may outlive it
+    log_context(log_context const &other) noexcept
+        : mThresholdState{other.mThresholdState.load(std::memory_order_relaxed)}
+        , mThresholdOverride{other.mThresholdOverride}
+        , mTargetPort{other.mTargetPort}
+        , mInstrumentationScope{other.mInstrumentationScope}
+        , mCurrentSpan{other.mCurrentSpan}
+        , mAttributes{other.mAttributes}
+        , mDeferredSpan{}
+    {
+    }
+    auto operator=(log_context const &other) noexcept
+            -> log_context &
     {
+        mThresholdState.store(
+                other.mThresholdState.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+        mThresholdOverride = other.mThresholdOverride;
+        mTargetPort = other.mTargetPort;
+        mInstrumentationScope = other.mInstrumentationScope;
+        mCurrentSpan = other.mCurrentSpan;
+        mAttributes = other.mAttributes;
+        mDeferredSpan = nullptr;
+        return *this;
+    }
+    // moving transfers the deferred span, e.g. a context_carrier moves the
+    // context between its frame and the active thread context
+    log_context(log_context &&other) noexcept
+        : mThresholdState{other.mThresholdState.load(std::memory_order_relaxed)}
+        , mThresholdOverride{other.mThresholdOverride}
+        , mTargetPort{other.mTargetPort}
+        , mInstrumentationScope{other.mInstrumentationScope}
+        , mCurrentSpan{other.mCurrentSpan}
+        , mAttributes{other.mAttributes}
+        , mDeferredSpan{std::exchange(other.mDeferredSpan, nullptr)}
+    {
+    }
+    auto operator=(log_context &&other) noexcept -> log_context &
+    {
+        mThresholdState.store(
+                other.mThresholdState.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+        mThresholdOverride = other.mThresholdOverride;
+        mTargetPort = other.mTargetPort;
+        mInstrumentationScope = other.mInstrumentationScope;
+        mCurrentSpan = other.mCurrentSpan;
+        mAttributes = other.mAttributes;
+        mDeferredSpan = std::exchange(other.mDeferredSpan, nullptr);
+        return *this;
     }
 
     DPLX_ATTR_FORCE_INLINE constexpr auto port() const noexcept
@@ -83,14 +170,36 @@ public:
     {
         return mTargetPort;
     }
-    DPLX_ATTR_FORCE_INLINE constexpr auto threshold() const noexcept -> severity
+    DPLX_ATTR_FORCE_INLINE auto threshold() const noexcept -> severity
     {
-        return mThresholdCache;
+        auto const resolved = resolved_threshold();
+        return resolved < mThresholdOverride ? mThresholdOverride : resolved;
     }
+    // the threshold configured for the instrumentation scope, i.e. without
+    // the override
+    DPLX_ATTR_FORCE_INLINE auto resolved_threshold() const noexcept
+            -> severity
+    {
+        auto const state = mThresholdState.load(std::memory_order_relaxed);
+        if (static_cast<std::uint32_t>(state >> 32)
+            != detail::threshold_generation.load(std::memory_order_relaxed))
+                [[unlikely]]
+        {
+            return refresh_threshold();
+        }
+        return static_cast<severity>(static_cast<std::uint32_t>(state));
+    }
+    DPLX_ATTR_FORCE_INLINE constexpr auto threshold_override() const noexcept
+            -> severity
+    {
+        return mThresholdOverride;
+    }
+    // the effective threshold is the maximum of the resolved threshold and
+    // the override, severity::none removes the override
     DPLX_ATTR_FORCE_INLINE constexpr void
-    override_threshold(severity nextThreshold) noexcept
+    override_threshold(severity nextOverride) noexcept
     {
-        mThresholdCache = nextThreshold;
+        mThresholdOverride = nextOverride;
     }
     DPLX_ATTR_FORCE_INLINE constexpr auto span() const noexcept -> span_context
     {
@@ -105,6 +214,54 @@ public:
     {
         return mInstrumentationScope;
     }
+    // the attributes are not owned by the context, see attribute_scope
+    DPLX_ATTR_FORCE_INLINE constexpr auto attributes() const noexcept
+            -> context_attributes const *
+    {
+        return mAttributes;
+    }
+    DPLX_ATTR_FORCE_INLINE constexpr void
+    attributes(context_attributes const *next) noexcept
+    {
+        mAttributes = next;
+    }
+
+    DPLX_ATTR_FORCE_INLINE constexpr auto deferred_span() const noexcept
+            -> span_scope *
+    {
+        return mDeferredSpan;
+    }
+    DPLX_ATTR_FORCE_INLINE constexpr void
+    deferred_span(span_scope *next) noexcept
+    {
+        mDeferredSpan = next;
+    }
+    // emits the start message of a deferred span before anything else is
+    // written within its scope
+    DPLX_ATTR_FORCE_INLINE void flush_deferred_span() const noexcept
+    {
+        if (mDeferredSpan != nullptr) [[unlikely]]
+        {
+            // the scope may refer to a context the state of which has been
+            // moved here (see context_carrier), i.e. only the port is used
+            detail::flush_deferred_span(*std::exchange(mDeferredSpan, nullptr),
+                                        *mTargetPort);
+        }
+    }
+
+private:
+    static auto current_threshold_generation() noexcept -> std::uint32_t
+    {
+        return detail::threshold_generation.load(std::memory_order_acquire);
+    }
+    static constexpr auto pack_threshold(std::uint32_t generation,
+                                         severity threshold) noexcept
+            -> std::uint64_t
+    {
+        return static_cast<std::uint64_t>(generation) << 32
+               | static_cast<std::uint32_t>(threshold);
+    }
+    auto refresh_threshold() const noexcept -> severity;
 };
 
 } // namespace dplx::dlog
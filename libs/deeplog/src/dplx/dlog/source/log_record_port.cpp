@@ -35,6 +35,9 @@ xxHash64_round(std::uint64_t accN, std::uint64_t const laneN) noexcept
 namespace detail
 {
 
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+constinit std::atomic<std::uint32_t> threshold_generation{0U};
+
 auto derive_span_id(std::uint64_t traceIdP0,
                     std::uint64_t traceIdP1,
                     std::uint64_t ctr) noexcept -> span_id
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <string_view>
@@ -16,9 +17,27 @@
 #include <dplx/dlog/core/strong_types.hpp>
 #include <dplx/dlog/fwd.hpp>
 
+namespace dplx::dlog::detail
+{
+
+// the threshold caches of the log_contexts are tagged with this generation
+// counter; incrementing it causes every log_context to re-resolve its
+// threshold on its next use.
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern constinit std::atomic<std::uint32_t> threshold_generation;
+
+} // namespace dplx::dlog::detail
+
 namespace dplx::dlog
 {
 
+// needs to be called after the threshold configuration of a log_record_port
+// has been changed in order for the change to affect existing log_contexts.
+inline void invalidate_threshold_caches() noexcept
+{
+    detail::threshold_generation.fetch_add(1U, std::memory_order_release);
+}
+
 class log_record_port
 {
 protected:
@@ -0,0 +1,26 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/source/rate_limiter.hpp"
+
+namespace dplx::dlog::detail
+{
+
+auto log_suppressed(log_context const &ctx,
+                    severity const sev,
+#if DPLX_DLOG_USE_SOURCE_LOCATION
+                    std::source_location const &location,
+#else
+                    log_location const &location,
+#endif
+                    std::uint64_t const numSuppressed) noexcept -> result<void>
+{
+    return dlog::log(ctx, sev, "suppressed {} similar records", location,
+                     numSuppressed);
+}
+
+} // namespace dplx::dlog::detail
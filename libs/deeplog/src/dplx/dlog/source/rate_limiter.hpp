@@ -0,0 +1,185 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+
+#if __cpp_lib_source_location >= 201'907L
+#include <source_location>
+#endif
+
+#include <dplx/cncr/utils.hpp>
+
+#include <dplx/dlog/config.hpp>
+#include <dplx/dlog/core/log_clock.hpp>
+#include <dplx/dlog/core/strong_types.hpp>
+#include <dplx/dlog/disappointment.hpp>
+#include <dplx/dlog/source/log.hpp>
+#include <dplx/dlog/source/log_context.hpp>
+
+namespace dplx::dlog
+{
+
+struct rate_limit_admission
+{
+    bool allowed;
+    // the number of records which have been rejected since the last admission
+    std::uint64_t suppressed;
+};
+
+template <typename T>
+concept rate_limiter = requires(T &limiter) {
+    {
+        limiter.try_acquire()
+    } noexcept -> std::same_as<rate_limit_admission>;
+};
+
+// admits a burst of up to `maxBurst` records and refills the bucket at a rate
+// of `maxBurst` records per `refillPeriod`. It is implemented as a generic
+// cell rate algorithm in order to get by with a single timestamp instead of a
+// (timestamp, token count) pair.
+class token_bucket_limiter
+{
+    std::atomic<std::uint64_t> mTheoreticalArrival;
+    std::atomic<std::uint64_t> mSuppressed;
+    std::uint64_t mEmissionInterval;
+    std::uint64_t mBurstTolerance;
+
+public:
+    // the emission interval is rounded up to at least one clock tick, i.e.
+    // configurations with a refill period shorter than `maxBurst` ticks would
+    // be silently throttled to one record per tick; the macros reject them.
+    template <typename Rep, typename Period>
+    constexpr token_bucket_limiter(
+            std::uint32_t const maxBurst,
+            std::chrono::duration<Rep, Period> const refillPeriod) noexcept
+        : mTheoreticalArrival(0U)
+        , mSuppressed(0U)
+        , mEmissionInterval(emission_interval(maxBurst, refillPeriod))
+        , mBurstTolerance(mEmissionInterval
+                          * (maxBurst > 0U ? maxBurst - 1U : 0U))
+    {
+    }
+
+    template <typename Rep, typename Period>
+    [[nodiscard]] static constexpr auto
+    valid_configuration(std::uint32_t const maxBurst,
+                        std::chrono::duration<Rep, Period> const
+                                refillPeriod) noexcept -> bool
+    {
+        return maxBurst > 0U && refillPeriod > refillPeriod.zero()
+            && std::chrono::duration_cast<log_clock::duration>(refillPeriod)
+                               .count()
+                       >= maxBurst;
+    }
+
+    token_bucket_limiter(token_bucket_limiter const &) = delete;
+    auto operator=(token_bucket_limiter const &)
+            -> token_bucket_limiter & = delete;
+
+    [[nodiscard]] auto try_acquire() noexcept -> rate_limit_admission
+    {
+        return try_acquire(log_clock::now());
+    }
+    [[nodiscard]] auto try_acquire(log_clock::time_point const at) noexcept
+            -> rate_limit_admission
+    {
+        auto const now = at.time_since_epoch().count();
+        auto arrival = mTheoreticalArrival.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto const base = arrival > now ? arrival : now;
+            if (base - now > mBurstTolerance)
+            {
+                mSuppressed.fetch_add(1U, std::memory_order_relaxed);
+                return {false, 0U};
+            }
+            if (mTheoreticalArrival.compare_exchange_weak(
+                        arrival, base + mEmissionInterval,
+                        std::memory_order_relaxed, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        return {true, take_suppressed()};
+    }
+
+private:
+    template <typename Rep, typename Period>
+    static constexpr auto
+    emission_interval(std::uint32_t const maxBurst,
+                      std::chrono::duration<Rep, Period> const
+                              refillPeriod) noexcept -> std::uint64_t
+    {
+        if (refillPeriod <= refillPeriod.zero())
+        {
+            return 1U;
+        }
+        std::uint64_t const period
+                = std::chrono::duration_cast<log_clock::duration>(refillPeriod)
+                          .count();
+        std::uint64_t const burst = maxBurst > 0U ? maxBurst : 1U;
+        auto const interval = period / burst + (period % burst != 0U ? 1U : 0U);
+        return interval > 0U ? interval : 1U;
+    }
+
+    auto take_suppressed() noexcept -> std::uint64_t
+    {
+        // avoid the RMW in the common case
+        if (mSuppressed.load(std::memory_order_relaxed) == 0U) [[likely]]
+        {
+            return 0U;
+        }
+        return mSuppressed.exchange(0U, std::memory_order_relaxed);
+    }
+};
+
+// admits every n-th record. Sampling is deliberate, therefore no suppression
+// summaries are reported.
+class sampling_limiter
+{
+    std::atomic<std::uint64_t> mCounter;
+    std::uint64_t mRate;
+
+public:
+    explicit constexpr sampling_limiter(std::uint64_t const oneIn) noexcept
+        : mCounter(0U)
+        , mRate(oneIn > 0U ? oneIn : 1U)
+    {
+    }
+
+    sampling_limiter(sampling_limiter const &) = delete;
+    auto operator=(sampling_limiter const &) -> sampling_limiter & = delete;
+
+    [[nodiscard]] auto try_acquire() noexcept -> rate_limit_admission
+    {
+        auto const seqNo = mCounter.fetch_add(1U, std::memory_order_relaxed);
+        return {seqNo % mRate == 0U, 0U};
+    }
+};
+
+} // namespace dplx::dlog
+
+namespace dplx::dlog::detail
+{
+
+// emits the "suppressed N similar records" summary on behalf of a rate
+// limited call site; out of line in order to keep it off the hot path.
+auto log_suppressed(log_context const &ctx,
+                    severity sev,
+#if DPLX_DLOG_USE_SOURCE_LOCATION
+                    std::source_location const &location,
+#else
+                    log_location const &location,
+#endif
+                    std::uint64_t numSuppressed) noexcept -> result<void>;
+
+} // namespace dplx::dlog::detail
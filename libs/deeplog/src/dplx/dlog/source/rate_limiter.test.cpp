@@ -0,0 +1,174 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/source/rate_limiter.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <dplx/dp/api.hpp>
+#include <dplx/dp/codecs/std-string.hpp>
+#include <dplx/dp/items/parse_core.hpp>
+#include <dplx/dp/items/skip_item.hpp>
+#include <dplx/dp/streams/memory_input_stream.hpp>
+
+#include <dplx/dlog/bus/buffer_bus.hpp>
+#include <dplx/dlog/log_fabric.hpp>
+#include <dplx/dlog/macros.hpp>
+
+#include "test_dir.hpp"
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+static_assert(dlog::rate_limiter<dlog::token_bucket_limiter>);
+static_assert(dlog::rate_limiter<dlog::sampling_limiter>);
+
+TEST_CASE("token_bucket_limiter admits a burst and reports suppressions")
+{
+    using namespace std::chrono_literals;
+    dlog::token_bucket_limiter limiter(2U, 1s);
+
+    dlog::log_clock::time_point const t0{1s};
+    CHECK(limiter.try_acquire(t0).allowed);
+    CHECK(limiter.try_acquire(t0).allowed);
+    CHECK(!limiter.try_acquire(t0).allowed);
+    CHECK(!limiter.try_acquire(t0 + 100ms).allowed);
+
+    auto const admission = limiter.try_acquire(t0 + 500ms);
+    CHECK(admission.allowed);
+    CHECK(admission.suppressed == 2U);
+    CHECK(!limiter.try_acquire(t0 + 500ms).allowed);
+
+    auto const refilled = limiter.try_acquire(t0 + 2s);
+    CHECK(refilled.allowed);
+    CHECK(refilled.suppressed == 1U);
+    CHECK(limiter.try_acquire(t0 + 2s).allowed);
+}
+
+TEST_CASE("sampling_limiter admits every n-th record")
+{
+    dlog::sampling_limiter limiter(3U);
+
+    CHECK(limiter.try_acquire().allowed);
+    CHECK(!limiter.try_acquire().allowed);
+    CHECK(!limiter.try_acquire().allowed);
+    CHECK(limiter.try_acquire().allowed);
+}
+
+TEST_CASE("token_bucket_limiter rounds the emission interval up")
+{
+    using namespace std::chrono_literals;
+    static_assert(!dlog::token_bucket_limiter::valid_configuration(4U, 3ns));
+    static_assert(!dlog::token_bucket_limiter::valid_configuration(0U, 1s));
+    static_assert(!dlog::token_bucket_limiter::valid_configuration(1U, -1s));
+    static_assert(dlog::token_bucket_limiter::valid_configuration(4U, 4ns));
+
+    // 3ns / 4 would truncate to a zero interval and admit everything
+    dlog::token_bucket_limiter limiter(4U, 3ns);
+    dlog::log_clock::time_point const t0{1s};
+    for (int i = 0; i < 4; ++i)
+    {
+        CHECK(limiter.try_acquire(t0).allowed);
+    }
+    CHECK(!limiter.try_acquire(t0).allowed);
+}
+
+namespace
+{
+
+// admits every record and reports a preset number of suppressed records once
+class scripted_limiter
+{
+    std::uint64_t mSuppressed;
+
+public:
+    explicit scripted_limiter(std::uint64_t suppressed) noexcept
+        : mSuppressed(suppressed)
+    {
+    }
+
+    [[nodiscard]] auto try_acquire() noexcept -> dlog::rate_limit_admission
+    {
+        return {true, std::exchange(mSuppressed, 0U)};
+    }
+};
+static_assert(dlog::rate_limiter<scripted_limiter>);
+
+auto decode_message(std::vector<std::byte> const &record) -> std::string
+{
+    auto &&buffer = dp::get_input_buffer(record);
+    dp::parse_context parseCtx{buffer};
+    REQUIRE(dp::expect_item_head(parseCtx, dp::type_code::array, 6U));
+    for (int i = 0; i < 3; ++i)
+    {
+        REQUIRE(dp::skip_item(parseCtx));
+    }
+    auto messageRx = dp::decode(dp::as_value<std::string>, parseCtx);
+    REQUIRE(messageRx);
+    return std::move(messageRx).assume_value();
+}
+
+} // namespace
+
+TEST_CASE("rate limited log macros drop excess records")
+{
+    using namespace std::chrono_literals;
+    dlog::log_fabric core{
+            dlog::bufferbus(test_dir, TEST_FILE_BB, small_buffer_bus_size)
+                    .value(),
+            dlog::severity::trace};
+    dlog::log_context ctx{core};
+
+    for (int i = 0; i < 16; ++i)
+    {
+        DLOG_RATE_LIMITED_TO(ctx, 4U, 1min, dlog::severity::warn,
+                             "storm {}", i);
+        DLOG_SAMPLED_TO(ctx, 8U, dlog::severity::warn, "sampled {}", i);
+    }
+    // the summary is emitted with the next admitted record
+    scripted_limiter limiter(12U);
+    DLOG_LIMITED_TO(ctx, limiter, dlog::severity::warn, "calm");
+
+    std::vector<std::vector<std::byte>> messages;
+    REQUIRE(core.message_bus().consume_messages(
+            [&messages](std::span<dlog::bytes const> msgs) {
+                for (auto const msg : msgs)
+                {
+                    messages.emplace_back(msg.begin(), msg.end());
+                }
+            }));
+
+    int numStorm = 0;
+    int numSampled = 0;
+    int numSummaries = 0;
+    int numCalm = 0;
+    for (auto const &record : messages)
+    {
+        auto const message = decode_message(record);
+        numStorm += static_cast<int>(message == "storm {}");
+        numSampled += static_cast<int>(message == "sampled {}");
+        numSummaries
+                += static_cast<int>(message == "suppressed {} similar records");
+        numCalm += static_cast<int>(message == "calm");
+    }
+    CHECK(messages.size() == 8U);
+    CHECK(numStorm == 4);
+    CHECK(numSampled == 2);
+    CHECK(numSummaries == 1);
+    CHECK(numCalm == 1);
+}
+
+} // namespace dlog_tests
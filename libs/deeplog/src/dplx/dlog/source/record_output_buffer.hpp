@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <concepts>
 #include <cstddef>
 
 #include <dplx/cncr/utils.hpp>
@@ -49,22 +50,30 @@ struct record_output_buffer_storage
     alignas(record_output_buffer) std::byte _state[static_size];
 };
 
+// commits and destroys a record output buffer. Guarding the final output
+// buffer type of a bus allows the compiler to devirtualize the commit.
+template <typename OutputBuffer = record_output_buffer>
+    requires std::derived_from<OutputBuffer, record_output_buffer>
 class record_output_guard
 {
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
-    record_output_buffer &mOutput;
+    OutputBuffer &mOutput;
 
 public:
     DPLX_ATTR_FORCE_INLINE ~record_output_guard() noexcept
     {
         (void)mOutput.sync_output();
-        mOutput.~record_output_buffer();
+        mOutput.~OutputBuffer();
     }
     DPLX_ATTR_FORCE_INLINE explicit record_output_guard(
-            record_output_buffer &which) noexcept
+            OutputBuffer &which) noexcept
         : mOutput(which)
     {
     }
+
+    record_output_guard(record_output_guard const &) = delete;
+    auto operator=(record_output_guard const &)
+            -> record_output_guard & = delete;
 };
 
 inline constexpr struct enqueue_message_fn
@@ -0,0 +1,345 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/source/span_histogram.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include <dplx/dp/api.hpp>
+#include <dplx/dp/codecs/core.hpp>
+#include <dplx/dp/codecs/std-string.hpp>
+#include <dplx/dp/items/emit_core.hpp>
+#include <dplx/dp/items/encoded_item_head_size.hpp>
+#include <dplx/dp/items/item_size_of_core.hpp>
+#include <dplx/dp/items/parse_core.hpp>
+#include <dplx/dp/items/parse_ranges.hpp>
+
+#include <dplx/dlog/source/log_record_port.hpp>
+#include <dplx/dlog/source/record_output_buffer.hpp>
+
+namespace dplx::dlog
+{
+
+namespace
+{
+
+// the shard index is an implementation detail of this translation unit, i.e.
+// the thread_local doesn't cross a DLL boundary.
+auto current_shard() noexcept -> std::size_t
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+    constinit static std::atomic<std::size_t> nextShard{0U};
+    thread_local std::size_t const shard
+            = nextShard.fetch_add(1U, std::memory_order_relaxed)
+              % span_histogram::num_shards;
+    return shard;
+}
+
+} // namespace
+
+span_histogram::span_histogram(std::string_view name)
+    : mName(name)
+    , mShards(std::make_unique<shard[]>(num_shards))
+{
+}
+
+void span_histogram::record(log_clock::duration const duration) noexcept
+{
+    auto &target = mShards[current_shard()];
+    auto const value = duration.count();
+    auto const which = static_cast<std::size_t>(
+            target.started.fetch_add(1U, std::memory_order_acquire) >> 63);
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-constant-array-index)
+    auto &active = target.halves[which];
+    active.sum.fetch_add(value, std::memory_order_relaxed);
+    active.counts[bucket_of(value)].fetch_add(1U, std::memory_order_relaxed);
+    target.completed[which].fetch_add(1U, std::memory_order_release);
+    // NOLINTEND(cppcoreguidelines-pro-bounds-constant-array-index)
+}
+
+auto span_histogram::take(std::span<std::uint64_t, num_buckets> counts) noexcept
+        -> std::uint64_t
+{
+    std::ranges::fill(counts, std::uint64_t{});
+    std::uint64_t sum = 0U;
+    for (std::size_t i = 0U; i < num_shards; ++i)
+    {
+        auto &source = mShards[i];
+        // flip the active half and reset the started counter in one go
+        auto const previous = source.started.load(std::memory_order_relaxed);
+        auto const flipped = (previous & active_half_bit) ^ active_half_bit;
+        auto const started
+                = source.started.exchange(flipped, std::memory_order_acq_rel);
+        auto const which = static_cast<std::size_t>(started >> 63);
+        auto const numStarted = started & ~active_half_bit;
+
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-constant-array-index)
+        auto &completed = source.completed[which];
+        while (completed.load(std::memory_order_acquire) != numStarted)
+        {
+            // the recorders only hold on to the half for a few instructions
+            std::this_thread::yield();
+        }
+        completed.store(0U, std::memory_order_relaxed);
+
+        auto &retired = source.halves[which];
+        sum += retired.sum.exchange(0U, std::memory_order_relaxed);
+        for (std::size_t j = 0U; j < num_buckets; ++j)
+        {
+            auto &counter = retired.counts[j];
+            // avoid dirtying untouched cache lines
+            if (auto const count = counter.load(std::memory_order_relaxed);
+                count != 0U)
+            {
+                counts[j] += count;
+                counter.store(0U, std::memory_order_relaxed);
+            }
+        }
+        // NOLINTEND(cppcoreguidelines-pro-bounds-constant-array-index)
+    }
+    return sum;
+}
+
+void span_histogram::restore(
+        std::span<std::uint64_t const, num_buckets> const counts,
+        std::uint64_t const sum) noexcept
+{
+    // behaves like a (large) recording in order to stay consistent with a
+    // concurrent take()
+    auto &target = mShards[current_shard()];
+    auto const which = static_cast<std::size_t>(
+            target.started.fetch_add(1U, std::memory_order_acquire) >> 63);
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-constant-array-index)
+    auto &active = target.halves[which];
+    active.sum.fetch_add(sum, std::memory_order_relaxed);
+    for (std::size_t i = 0U; i < num_buckets; ++i)
+    {
+        if (counts[i] != 0U)
+        {
+            active.counts[i].fetch_add(counts[i], std::memory_order_relaxed);
+        }
+    }
+    target.completed[which].fetch_add(1U, std::memory_order_release);
+    // NOLINTEND(cppcoreguidelines-pro-bounds-constant-array-index)
+}
+
+auto span_histogram_registry::get(std::string_view name) -> span_histogram &
+{
+    std::lock_guard lock(mMutex);
+    if (auto it = std::ranges::find(
+                mHistograms, name,
+                [](entry const &e) { return e.histogram->name(); });
+        it != mHistograms.end())
+    {
+        return *it->histogram;
+    }
+    return *mHistograms
+                    .emplace_back(entry{std::make_unique<span_histogram>(name),
+                                        mIntervalStart})
+                    .histogram;
+}
+
+auto span_histogram_registry::emit_due_summaries(log_record_port &port) noexcept
+        -> result<void>
+{
+    auto const now = log_clock::now();
+    if (now - mIntervalStart < mInterval)
+    {
+        return outcome::success();
+    }
+    return emit_summaries(port, now);
+}
+
+auto span_histogram_registry::emit_summaries(
+        log_record_port &port, log_clock::time_point const now) noexcept
+        -> result<void>
+try
+{
+    std::lock_guard lock(mMutex);
+    std::array<std::uint64_t, span_histogram::num_buckets> counts{};
+    span_histogram_summary summary{
+            .name = {},
+            .start = {},
+            .end = now,
+            .sum = 0U,
+            .buckets = {},
+    };
+    // allocate upfront, the counts are lost if this throws after take()
+    summary.buckets.reserve(span_histogram::num_buckets);
+    mIntervalStart = now;
+
+    result<void> emitRx = outcome::success();
+    for (auto &[histogram, summaryStart] : mHistograms)
+    {
+        // may allocate, therefore it precedes take()
+        summary.name = histogram->name();
+        summary.start = std::exchange(summaryStart, now);
+        summary.sum = histogram->take(counts);
+        summary.buckets.clear();
+        for (std::size_t i = 0U; i < counts.size(); ++i)
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+            if (counts[i] != 0U)
+            {
+                summary.buckets.push_back(
+                        {static_cast<std::uint32_t>(i), counts[i]});
+            }
+        }
+        if (summary.buckets.empty())
+        {
+            continue;
+        }
+        if (auto enqueueRx = enqueue_message(port, span_id::invalid(), summary);
+            enqueueRx.has_failure())
+        {
+            // the next summary covers both intervals instead of losing the
+            // counts, report the first failure, but don't let it affect the
+            // remaining histograms
+            histogram->restore(counts, summary.sum);
+            summaryStart = summary.start;
+            if (emitRx.has_value())
+            {
+                emitRx = std::move(enqueueRx);
+            }
+        }
+    }
+    return emitRx;
+}
+catch (std::bad_alloc const &)
+{
+    return errc::not_enough_memory;
+}
+
+auto span_histogram_summary::count() const noexcept -> std::uint64_t
+{
+    std::uint64_t total = 0U;
+    for (auto const &b : buckets)
+    {
+        total += b.count;
+    }
+    return total;
+}
+
+auto span_histogram_summary::quantile(double const q) const noexcept
+        -> log_clock::duration
+{
+    auto const total = count();
+    if (total == 0U)
+    {
+        return {};
+    }
+    auto const rank = static_cast<std::uint64_t>(
+            std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(total)));
+    std::uint64_t seen = 0U;
+    for (auto const &b : buckets)
+    {
+        seen += b.count;
+        if (seen >= rank)
+        {
+            return log_clock::duration{span_histogram::lower_bound_of(b.index)};
+        }
+    }
+    return log_clock::duration{
+            span_histogram::lower_bound_of(buckets.back().index)};
+}
+
+} // namespace dplx::dlog
+
+// layout:
+// array 5
+// +  str   span name
+// +  ui64  interval start
+// +  ui64  interval end
+// +  ui64  sum of durations in nanoseconds
+// +  array alternating bucket indices and counts
+auto dplx::dp::codec<dplx::dlog::span_histogram_summary>::size_of(
+        emit_context &ctx,
+        dlog::span_histogram_summary const &value) noexcept -> std::uint64_t
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    std::uint64_t size = dp::encoded_item_head_size<type_code::array>(5U)
+                         + dp::item_size_of_u8string(ctx, value.name.size())
+                         + dp::encoded_size_of(ctx, value.start)
+                         + dp::encoded_size_of(ctx, value.end)
+                         + dp::item_size_of_integer(ctx, value.sum)
+                         + dp::encoded_item_head_size<type_code::array>(
+                                 2U * value.buckets.size());
+    for (auto const &b : value.buckets)
+    {
+        size += dp::item_size_of_integer(ctx, b.index)
+                + dp::item_size_of_integer(ctx, b.count);
+    }
+    return size;
+}
+
+auto dplx::dp::codec<dplx::dlog::span_histogram_summary>::encode(
+        emit_context &ctx,
+        dlog::span_histogram_summary const &value) noexcept -> result<void>
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    DPLX_TRY(dp::emit_array(ctx, 5U));
+    DPLX_TRY(dp::emit_u8string(ctx, value.name.data(), value.name.size()));
+    DPLX_TRY(dp::encode(ctx, value.start));
+    DPLX_TRY(dp::encode(ctx, value.end));
+    DPLX_TRY(dp::emit_integer(ctx, value.sum));
+    DPLX_TRY(dp::emit_array(ctx, 2U * value.buckets.size()));
+    for (auto const &b : value.buckets)
+    {
+        DPLX_TRY(dp::emit_integer(ctx, b.index));
+        DPLX_TRY(dp::emit_integer(ctx, b.count));
+    }
+    return outcome::success();
+}
+
+auto dplx::dp::codec<dplx::dlog::span_histogram_summary>::decode(
+        parse_context &ctx, dlog::span_histogram_summary &outValue) noexcept
+        -> result<void>
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    DPLX_TRY(dp::expect_item_head(ctx, type_code::array, 5U));
+    return dlog::detail::decode_span_histogram_properties(ctx, outValue);
+}
+
+auto dplx::dlog::detail::decode_span_histogram_properties(
+        dp::parse_context &ctx, span_histogram_summary &value) noexcept
+        -> result<void>
+try
+{
+    DPLX_TRY(dp::parse_text(ctx, value.name));
+    DPLX_TRY(dp::decode(ctx, value.start));
+    DPLX_TRY(dp::decode(ctx, value.end));
+    DPLX_TRY(dp::parse_integer(ctx, value.sum));
+
+    DPLX_TRY(auto const bucketsHead, dp::parse_item_head(ctx));
+    if (bucketsHead.type != dp::type_code::array || bucketsHead.indefinite()
+        || bucketsHead.value % 2U != 0U
+        || bucketsHead.value / 2U > span_histogram::num_buckets)
+    {
+        return dp::errc::item_type_mismatch;
+    }
+    value.buckets.clear();
+    value.buckets.reserve(bucketsHead.value / 2U);
+    for (std::uint64_t i = 0U; i < bucketsHead.value / 2U; ++i)
+    {
+        span_histogram_summary::bucket b{};
+        DPLX_TRY(dp::parse_integer(
+                ctx, b.index,
+                static_cast<std::uint32_t>(span_histogram::num_buckets - 1U)));
+        DPLX_TRY(dp::parse_integer(ctx, b.count));
+        value.buckets.push_back(b);
+    }
+    return outcome::success();
+}
+catch (std::bad_alloc const &)
+{
+    return errc::not_enough_memory;
+}
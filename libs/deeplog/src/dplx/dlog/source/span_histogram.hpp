@@ -0,0 +1,246 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <dplx/dp/fwd.hpp>
+#include <dplx/dp/macros.hpp>
+
+#include <dplx/dlog/core/log_clock.hpp>
+#include <dplx/dlog/disappointment.hpp>
+#include <dplx/dlog/fwd.hpp>
+
+namespace dplx::dlog
+{
+
+// A duration histogram with log-linear buckets, i.e. each power of two range
+// is split into `num_sub_buckets` buckets which bounds the relative error of
+// a quantile to 1/num_sub_buckets. The counters are sharded by thread in
+// order to keep recording free of locks and (mostly) free of contention.
+//
+// Each shard is double buffered: take() flips the recorders over to the other
+// half and waits for the recordings still in flight on the old half, i.e. the
+// sum and the counts of a recording always end up in the same interval.
+class span_histogram
+{
+public:
+    static constexpr unsigned sub_bucket_bits = 3U;
+    static constexpr std::size_t num_sub_buckets = std::size_t{1}
+                                                   << sub_bucket_bits;
+    static constexpr std::size_t num_buckets
+            = (64U - sub_bucket_bits + 1U) * num_sub_buckets;
+    static constexpr std::size_t num_shards = 8U;
+
+private:
+    struct half
+    {
+        std::atomic<std::uint64_t> sum;
+        std::atomic<std::uint64_t> counts[num_buckets];
+    };
+    struct alignas(64) shard // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+    {
+        // the top bit selects the active half, the remaining bits count the
+        // recordings started on it
+        std::atomic<std::uint64_t> started;
+        std::atomic<std::uint64_t> completed[2];
+        half halves[2];
+    };
+    static constexpr std::uint64_t active_half_bit = std::uint64_t{1} << 63;
+
+    std::string mName;
+    std::unique_ptr<shard[]> mShards;
+
+public:
+    // throws std::bad_alloc
+    explicit span_histogram(std::string_view name);
+
+    [[nodiscard]] auto name() const noexcept -> std::string_view
+    {
+        return mName;
+    }
+
+    void record(log_clock::duration duration) noexcept;
+    // moves the counts of every shard into `counts` and returns the sum of
+    // the recorded durations in nanoseconds. Must not be called concurrently
+    // (the registry serializes it).
+    auto take(std::span<std::uint64_t, num_buckets> counts) noexcept
+            -> std::uint64_t;
+    // adds counts and a sum obtained by take() back to the histogram, e.g.
+    // after their summary couldn't be written.
+    void restore(std::span<std::uint64_t const, num_buckets> counts,
+                 std::uint64_t sum) noexcept;
+
+    static constexpr auto bucket_of(std::uint64_t value) noexcept
+            -> std::size_t
+    {
+        if (value < num_sub_buckets)
+        {
+            return static_cast<std::size_t>(value);
+        }
+        auto const shift = static_cast<unsigned>(std::bit_width(value))
+                           - 1U - sub_bucket_bits;
+        auto const sub = static_cast<std::size_t>(value >> shift)
+                         & (num_sub_buckets - 1U);
+        return (shift + 1U) * num_sub_buckets + sub;
+    }
+    static constexpr auto lower_bound_of(std::size_t bucket) noexcept
+            -> std::uint64_t
+    {
+        if (bucket < num_sub_buckets)
+        {
+            return bucket;
+        }
+        auto const shift = bucket / num_sub_buckets - 1U;
+        auto const sub = bucket % num_sub_buckets;
+        return static_cast<std::uint64_t>(num_sub_buckets + sub) << shift;
+    }
+};
+
+// measures the duration of a scope and records it into a span_histogram
+// instead of writing a span to the bus. No span context is created, i.e.
+// records written within the scope are attached to the enclosing span.
+class [[nodiscard]] span_duration_scope
+{
+    span_histogram *mHistogram;
+    log_clock::time_point mStart;
+
+public:
+    ~span_duration_scope() noexcept
+    {
+        if (mHistogram != nullptr)
+        {
+            mHistogram->record(log_clock::now() - mStart);
+        }
+    }
+    explicit span_duration_scope(span_histogram &histogram) noexcept
+        : mHistogram(&histogram)
+        , mStart(log_clock::now())
+    {
+    }
+
+    span_duration_scope(span_duration_scope const &) = delete;
+    auto operator=(span_duration_scope const &)
+            -> span_duration_scope & = delete;
+
+    span_duration_scope(span_duration_scope &&) = delete;
+    auto operator=(span_duration_scope &&) -> span_duration_scope & = delete;
+};
+
+// owns the span histograms of a log_fabric and periodically writes their
+// merged counts to the bus as span histogram summary messages.
+class span_histogram_registry
+{
+    struct entry
+    {
+        std::unique_ptr<span_histogram> histogram;
+        // the start of the interval covered by the next summary, it lags
+        // behind mIntervalStart after a summary couldn't be written
+        log_clock::time_point summary_start;
+    };
+
+    std::mutex mMutex;
+    std::vector<entry> mHistograms;
+    log_clock::duration mInterval;
+    log_clock::time_point mIntervalStart;
+
+public:
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    static constexpr log_clock::duration default_interval{10'000'000'000U};
+
+    ~span_histogram_registry() noexcept = default;
+    span_histogram_registry() noexcept
+        : mMutex()
+        , mHistograms()
+        , mInterval(default_interval)
+        , mIntervalStart(log_clock::now())
+    {
+    }
+
+    span_histogram_registry(span_histogram_registry const &) = delete;
+    auto operator=(span_histogram_registry const &)
+            -> span_histogram_registry & = delete;
+
+    span_histogram_registry(span_histogram_registry &&other) noexcept
+        : mMutex()
+        , mHistograms(std::move(other.mHistograms))
+        , mInterval(other.mInterval)
+        , mIntervalStart(other.mIntervalStart)
+    {
+    }
+    auto operator=(span_histogram_registry &&other) noexcept
+            -> span_histogram_registry &
+    {
+        mHistograms = std::move(other.mHistograms);
+        mInterval = other.mInterval;
+        mIntervalStart = other.mIntervalStart;
+        return *this;
+    }
+
+    // returns the histogram with the given name, the reference stays valid
+    // until the registry is destroyed.
+    // throws std::bad_alloc
+    auto get(std::string_view name) -> span_histogram &;
+
+    void interval(log_clock::duration next) noexcept
+    {
+        mInterval = next;
+    }
+
+    // writes a summary for each non-empty histogram if the interval has
+    // elapsed. The counts of a summary which couldn't be enqueued are kept for
+    // the next interval and the first failure is returned.
+    auto emit_due_summaries(log_record_port &port) noexcept -> result<void>;
+    auto emit_summaries(log_record_port &port,
+                        log_clock::time_point now) noexcept -> result<void>;
+};
+
+// the contents of a span histogram summary message
+struct span_histogram_summary
+{
+    struct bucket
+    {
+        std::uint32_t index;
+        std::uint64_t count;
+    };
+
+    std::string name;
+    log_clock::time_point start;
+    log_clock::time_point end;
+    std::uint64_t sum;
+    std::vector<bucket> buckets;
+
+    [[nodiscard]] auto count() const noexcept -> std::uint64_t;
+    // returns the lower bound of the bucket containing the given quantile
+    [[nodiscard]] auto quantile(double q) const noexcept
+            -> log_clock::duration;
+};
+
+} // namespace dplx::dlog
+
+namespace dplx::dlog::detail
+{
+
+// decodes the properties of a span histogram summary message whose tuple head
+// has already been parsed
+auto decode_span_histogram_properties(dp::parse_context &ctx,
+                                      span_histogram_summary &value) noexcept
+        -> result<void>;
+
+} // namespace dplx::dlog::detail
+
+DPLX_DP_DECLARE_CODEC_SIMPLE(dplx::dlog::span_histogram_summary);
@@ -0,0 +1,202 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/source/span_histogram.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <dplx/dp/api.hpp>
+#include <dplx/dp/streams/memory_input_stream.hpp>
+
+#include <dplx/dlog/bus/buffer_bus.hpp>
+#include <dplx/dlog/log_fabric.hpp>
+#include <dplx/dlog/record_container.hpp>
+#include <dplx/dlog/source/record_output_buffer.hpp>
+
+#include "test_dir.hpp"
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+using dlog::span_histogram;
+
+static_assert(span_histogram::bucket_of(0U) == 0U);
+static_assert(span_histogram::bucket_of(7U) == 7U);
+static_assert(span_histogram::bucket_of(8U) == 8U);
+static_assert(span_histogram::bucket_of(16U) == 16U);
+static_assert(span_histogram::bucket_of(UINT64_MAX)
+              == span_histogram::num_buckets - 1U);
+
+TEST_CASE("span_histogram buckets bound the relative error")
+{
+    for (std::size_t i = 0U; i < span_histogram::num_buckets; ++i)
+    {
+        auto const lowerBound = span_histogram::lower_bound_of(i);
+        CHECK(span_histogram::bucket_of(lowerBound) == i);
+        if (i + 1U < span_histogram::num_buckets)
+        {
+            auto const nextBound = span_histogram::lower_bound_of(i + 1U);
+            CHECK(span_histogram::bucket_of(nextBound - 1U) == i);
+            CHECK((nextBound - lowerBound) * span_histogram::num_sub_buckets
+                  <= std::max<std::uint64_t>(lowerBound, 8U));
+        }
+    }
+}
+
+TEST_CASE("span_histogram::take() moves the recorded durations")
+{
+    using namespace std::chrono_literals;
+    span_histogram histogram("test");
+    histogram.record(5ns);
+    histogram.record(1us);
+    histogram.record(1us);
+
+    std::array<std::uint64_t, span_histogram::num_buckets> counts{};
+    CHECK(histogram.take(counts) == 2'005U);
+    CHECK(counts[span_histogram::bucket_of(5U)] == 1U);
+    CHECK(counts[span_histogram::bucket_of(1'000U)] == 2U);
+
+    CHECK(histogram.take(counts) == 0U);
+    CHECK(counts[span_histogram::bucket_of(1'000U)] == 0U);
+}
+
+TEST_CASE("span_histogram_registry returns the same histogram for a name")
+{
+    dlog::span_histogram_registry registry;
+    auto &a = registry.get("a");
+    CHECK(&registry.get("b") != &a);
+    CHECK(&registry.get("a") == &a);
+}
+
+TEST_CASE("span_histogram_summary computes quantiles")
+{
+    dlog::span_histogram_summary summary{
+            .name = "test",
+            .start = {},
+            .end = {},
+            .sum = 0U,
+            .buckets = {{1U, 50U}, {9U, 49U}, {20U, 1U}},
+    };
+    CHECK(summary.count() == 100U);
+    CHECK(summary.quantile(0.5).count() == 1U);
+    CHECK(summary.quantile(0.9).count()
+          == span_histogram::lower_bound_of(9U));
+    CHECK(summary.quantile(1.0).count()
+          == span_histogram::lower_bound_of(20U));
+}
+
+TEST_CASE("span histogram summaries can be decoded as records")
+{
+    using namespace std::chrono_literals;
+    dlog::log_fabric core{
+            dlog::bufferbus(test_dir, TEST_FILE_BB, small_buffer_bus_size)
+                    .value()};
+    auto &histogram = core.span_histograms().get("query");
+    histogram.record(1us);
+    histogram.record(1us);
+    histogram.record(1us);
+    histogram.record(2us);
+    // empty histograms aren't written
+    (void)core.span_histograms().get("idle");
+    REQUIRE(core.span_histograms().emit_summaries(core, dlog::log_clock::now()));
+
+    std::vector<std::vector<std::byte>> messages;
+    REQUIRE(core.message_bus().consume_messages(
+            [&messages](std::span<dlog::bytes const> msgs) {
+                for (auto const msg : msgs)
+                {
+                    messages.emplace_back(msg.begin(), msg.end());
+                }
+            }));
+    REQUIRE(messages.size() == 1U);
+
+    dlog::span_histogram_summary summary{};
+    {
+        auto &&buffer = dp::get_input_buffer(messages.front());
+        dp::parse_context parseCtx{buffer};
+        REQUIRE(dp::decode(parseCtx, summary));
+    }
+    CHECK(summary.name == "query");
+    CHECK(summary.sum == 5'000U);
+    CHECK(summary.count() == 4U);
+    CHECK(summary.quantile(1.0).count()
+          == span_histogram::lower_bound_of(span_histogram::bucket_of(2'000U)));
+
+    dlog::argument_transmorpher argumentTransmorpher;
+    dp::basic_decoder<dlog::record> decodeRecord{argumentTransmorpher};
+    dlog::record record{};
+    auto &&buffer = dp::get_input_buffer(messages.front());
+    dp::parse_context parseCtx{buffer};
+    REQUIRE(decodeRecord(parseCtx, record));
+    CHECK(record.severity == dlog::severity::info);
+    CHECK(record.instrumentationScope == "span_histogram");
+    CHECK(record.timestamp == summary.end.time_since_epoch().count());
+    std::string_view const message = record.message;
+    CHECK(message.starts_with("query: n=4 "));
+    // the highest quantile is the lower bound of the 2us bucket
+    CHECK(message.ends_with(" p100=1.9us"));
+}
+
+TEST_CASE("span histogram summaries which can't be enqueued are retried")
+{
+    using namespace std::chrono_literals;
+    dlog::log_fabric core{
+            dlog::bufferbus(test_dir, TEST_FILE_BB, small_buffer_bus_size)
+                    .value()};
+    auto &histogram = core.span_histograms().get("query");
+    histogram.record(1us);
+    histogram.record(2us);
+
+    {
+        // occupy the whole bus
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
+        dlog::record_output_buffer_storage outStorage;
+        auto *out = core.message_bus()
+                            .allocate_record_buffer_inplace(
+                                    outStorage, small_buffer_bus_size - 4U, {})
+                            .value();
+        dlog::record_output_guard busLock(*out);
+    }
+    auto const failedEnd = dlog::log_clock::now();
+    CHECK(core.span_histograms().emit_summaries(core, failedEnd).has_failure());
+    REQUIRE(core.message_bus().consume_messages(
+            [](std::span<dlog::bytes const>) {}));
+
+    histogram.record(3us);
+    REQUIRE(core.span_histograms().emit_summaries(core, failedEnd + 1s));
+
+    std::vector<std::vector<std::byte>> messages;
+    REQUIRE(core.message_bus().consume_messages(
+            [&messages](std::span<dlog::bytes const> msgs) {
+                for (auto const msg : msgs)
+                {
+                    messages.emplace_back(msg.begin(), msg.end());
+                }
+            }));
+    REQUIRE(messages.size() == 1U);
+
+    dlog::span_histogram_summary summary{};
+    auto &&buffer = dp::get_input_buffer(messages.front());
+    dp::parse_context parseCtx{buffer};
+    REQUIRE(dp::decode(parseCtx, summary));
+    CHECK(summary.count() == 3U);
+    CHECK(summary.sum == 6'000U);
+    CHECK(summary.start < failedEnd);
+    CHECK(summary.end == failedEnd + 1s);
+}
+
+} // namespace dlog_tests
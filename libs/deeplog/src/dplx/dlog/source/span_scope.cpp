@@ -55,6 +55,19 @@ struct span_end_msg
     log_clock::time_point timestamp;
 };
 
+struct span_complete_msg
+{
+    span_context id;
+    span_kind kind;
+    span_context parent;
+    log_clock::time_point start;
+    log_clock::time_point end;
+    std::string_view name;
+    std::span<span_context, 0> links;
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
+    detail::attribute_args const &attributes;
+};
+
 // NOLINTEND(cppcoreguidelines-pro-type-member-init)
 
 } // namespace dplx::dlog
@@ -115,6 +128,43 @@ public:
     }
 };
 
+template <>
+class dplx::dp::codec<dplx::dlog::span_complete_msg>
+{
+    using span_complete_msg = dlog::span_complete_msg;
+    struct attributes_fn
+        : member_accessor_base<span_complete_msg,
+                               dlog::detail::attribute_args const>
+    {
+        DPLX_ATTR_FORCE_INLINE auto operator()(auto &self) const noexcept
+        {
+            return &self.attributes;
+        }
+    };
+
+    static constexpr tuple_def<tuple_member_def<&span_complete_msg::id>{},
+                               tuple_member_def<&span_complete_msg::kind>{},
+                               tuple_member_def<&span_complete_msg::parent>{},
+                               tuple_member_def<&span_complete_msg::start>{},
+                               tuple_member_def<&span_complete_msg::end>{},
+                               tuple_member_def<&span_complete_msg::name>{},
+                               tuple_member_def<&span_complete_msg::links>{},
+                               tuple_member_fun<attributes_fn>{}>
+            layout_descriptor{};
+
+public:
+    static auto size_of(emit_context &ctx,
+                        span_complete_msg const &msg) noexcept -> std::uint64_t
+    {
+        return dp::size_of_tuple<layout_descriptor>(ctx, msg);
+    }
+    static auto encode(emit_context &ctx, span_complete_msg const &msg) noexcept
+            -> result<void>
+    {
+        return dp::encode_tuple<layout_descriptor>(ctx, msg);
+    }
+};
+
 auto dplx::dp::codec<dplx::dlog::span_kind>::decode(
         parse_context &ctx, dlog::span_kind &value) noexcept -> result<void>
 {
@@ -149,13 +199,30 @@ span_scope::span_scope(log_context *const ctx,
                        span_context const id,
                        severity const threshold) noexcept
     : mSpanThreshold{threshold}
-    , mPreviousThreshold{ctx->threshold()}
+    , mPreviousThresholdOverride{ctx->threshold_override()}
     , mContext{ctx}
     , mId{id}
     , mPreviousId{ctx->span()}
 {
     ctx->span(id);
-    ctx->override_threshold(mSpanThreshold);
+    // only a span threshold above the configured one needs to be enforced,
+    // anything else follows threshold reconfigurations
+    ctx->override_threshold(ctx->resolved_threshold() < threshold
+                                    ? threshold
+                                    : severity::none);
+}
+span_scope::span_scope(log_context *const ctx,
+                       span_context const id,
+                       severity const threshold,
+                       deferred_start const &start) noexcept
+    : span_scope(ctx, id, threshold)
+{
+    mDeferredStart = start;
+    mDeferredStart.pending = threshold != detail::disable_threshold;
+    if (mDeferredStart.pending)
+    {
+        ctx->deferred_span(this);
+    }
 }
 
 #if !DPLX_DLOG_DISABLE_IMPLICIT_CONTEXT
@@ -170,7 +237,7 @@ auto span_scope::none(log_context &ctx) noexcept -> span_scope
     auto *const port = ctx.port();
     return span_scope(&ctx, span_context{},
                       nullptr == port ? detail::disable_threshold
-                                      : port->default_threshold());
+                                      : severity::none);
 }
 
 #if !DPLX_DLOG_DISABLE_IMPLICIT_CONTEXT
@@ -208,6 +275,13 @@ auto span_scope::do_open(log_context &ctx,
     }
 
     severity newThreshold = ctx.threshold();
+    if (newThreshold == detail::disable_threshold
+        && parent.traceId != trace_id::invalid()) [[unlikely]]
+    {
+        // the parent belongs to an unsampled trace which we join without
+        // creating a new span
+        return {&ctx, parent, newThreshold};
+    }
     span_start_msg msg{
             .id = ctx.port()->create_span_context(parent.traceId, name,
                                                   newThreshold),
@@ -218,8 +292,15 @@ auto span_scope::do_open(log_context &ctx,
             .links = {},
             .attributes = attrs,
     };
+    if (msg.id.traceId != trace_id::invalid()
+        && newThreshold == detail::disable_threshold)
+    {
+        // the trace hasn't been sampled
+        return {&ctx, msg.id, newThreshold};
+    }
     if (msg.id.traceId != trace_id::invalid())
     {
+        ctx.flush_deferred_span();
         msg.timestamp = log_clock::now();
         if (enqueue_message(*ctx.port(), msg.id.spanId, msg).has_value())
         {
@@ -229,6 +310,105 @@ auto span_scope::do_open(log_context &ctx,
     return {};
 }
 
+#if !DPLX_DLOG_DISABLE_IMPLICIT_CONTEXT
+auto span_scope::do_open_deferred(std::string_view name,
+                                  span_kind kind,
+                                  std::string_view function) noexcept
+        -> span_scope
+{
+    auto &&activeContext = DPLX_DLOG_INTERNAL_ACTIVE_CONTEXT;
+    return do_open_deferred(activeContext, name, activeContext.span(), kind,
+                            function);
+}
+#endif
+
+auto span_scope::do_open_deferred(log_context &ctx,
+                                  std::string_view name,
+                                  span_context parent,
+                                  span_kind kind,
+                                  std::string_view function) noexcept
+        -> span_scope
+{
+    using namespace std::string_view_literals;
+    auto *const port = ctx.port();
+    if (nullptr == port)
+    {
+        return span_scope{};
+    }
+
+    severity newThreshold = ctx.threshold();
+    if (newThreshold == detail::disable_threshold
+        && parent.traceId != trace_id::invalid()) [[unlikely]]
+    {
+        return {&ctx, parent, newThreshold};
+    }
+    auto const id = port->create_span_context(parent.traceId, name,
+                                              newThreshold);
+    if (id.traceId == trace_id::invalid())
+    {
+        return {};
+    }
+    if (newThreshold != detail::disable_threshold)
+    {
+        // the parent span isn't empty anymore
+        ctx.flush_deferred_span();
+    }
+    return {&ctx, id, newThreshold,
+            deferred_start{
+                    .parent = parent,
+                    .timestamp = log_clock::now(),
+                    .name = name.data() == nullptr ? ""sv : name,
+                    .function = function,
+                    .kind = kind,
+                    .pending = true,
+            }};
+}
+
+auto span_scope::send_start_msg(log_record_port &port) noexcept -> result<void>
+{
+    auto const emit = [this, &port](detail::attribute_args const &attrs) {
+        span_start_msg msg{
+                .id = mId,
+                .kind = mDeferredStart.kind,
+                .parent = mDeferredStart.parent,
+                .timestamp = mDeferredStart.timestamp,
+                .name = mDeferredStart.name,
+                .links = {},
+                .attributes = attrs,
+        };
+        return enqueue_message(port, mId.spanId, msg);
+    };
+    if (mDeferredStart.function.data() != nullptr)
+    {
+        return emit(detail::stack_attribute_args<attr::function>{
+                attr::function{mDeferredStart.function}});
+    }
+    return emit(detail::stack_attribute_args<>{});
+}
+
+auto span_scope::send_complete_msg() noexcept -> result<void>
+{
+    auto const emit = [this](detail::attribute_args const &attrs) {
+        span_complete_msg msg{
+                .id = mId,
+                .kind = mDeferredStart.kind,
+                .parent = mDeferredStart.parent,
+                .start = mDeferredStart.timestamp,
+                .end = log_clock::now(),
+                .name = mDeferredStart.name,
+                .links = {},
+                .attributes = attrs,
+        };
+        return enqueue_message(*mContext->port(), mId.spanId, msg);
+    };
+    if (mDeferredStart.function.data() != nullptr)
+    {
+        return emit(detail::stack_attribute_args<attr::function>{
+                attr::function{mDeferredStart.function}});
+    }
+    return emit(detail::stack_attribute_args<>{});
+}
+
 auto span_scope::send_close_msg() noexcept -> result<void>
 {
     span_end_msg msg{
@@ -240,3 +420,15 @@ auto span_scope::send_close_msg() noexcept -> result<void>
 }
 
 } // namespace dplx::dlog
+
+void dplx::dlog::detail::flush_deferred_span(span_scope &scope,
+                                             log_record_port &port) noexcept
+{
+    // the start message is written at most once, even if it can't be written
+    // at all; the end message will be written regardless.
+    if (scope.mDeferredStart.pending)
+    {
+        scope.mDeferredStart.pending = false;
+        (void)scope.send_start_msg(port);
+    }
+}
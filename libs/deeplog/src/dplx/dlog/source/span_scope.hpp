@@ -8,11 +8,13 @@
 #pragma once
 
 #include <source_location>
+#include <string_view>
 
 #include <dplx/dp/macros.hpp>
 
 #include <dplx/dlog/attributes.hpp>
 #include <dplx/dlog/config.hpp>
+#include <dplx/dlog/core/log_clock.hpp>
 #include <dplx/dlog/core/strong_types.hpp>
 #include <dplx/dlog/fwd.hpp>
 #include <dplx/dlog/source/log_context.hpp>
@@ -40,18 +42,42 @@ enum class span_kind : unsigned
                     std::char_traits<char>::length(loc.function_name())        \
         }                                                                      \
     }
+#define DPLX_DLOG_DETAIL_FUNCTION_NAME_DEF                                     \
+    , std::source_location const loc = std::source_location::current()
+#define DPLX_DLOG_DETAIL_FUNCTION_NAME_USE                                     \
+    , std::string_view(loc.function_name())
 #else
 #define DPLX_DLOG_DETAIL_ATTR_FUNCTION_DEF
 #define DPLX_DLOG_DETAIL_ATTR_FUNCTION_USE
+#define DPLX_DLOG_DETAIL_FUNCTION_NAME_DEF
+#define DPLX_DLOG_DETAIL_FUNCTION_NAME_USE , std::string_view()
 #endif
 
 class [[nodiscard]] span_scope
 {
+    friend void detail::flush_deferred_span(span_scope &scope,
+                                           log_record_port &port) noexcept;
+    friend class async_span_scope;
+
+    // the span start message of a deferred span, it is written combined with
+    // the span end message if nothing else has been written within the span.
+    struct deferred_start
+    {
+        span_context parent;
+        log_clock::time_point timestamp;
+        std::string_view name;
+        std::string_view function;
+        span_kind kind;
+        // whether the start message still needs to be written
+        bool pending;
+    };
+
     severity mSpanThreshold;
-    severity mPreviousThreshold;
+    severity mPreviousThresholdOverride;
     log_context *mContext;
     span_context mId;
     span_context mPreviousId;
+    deferred_start mDeferredStart;
 
 public:
     constexpr ~span_scope() noexcept
@@ -59,16 +85,28 @@ public:
         if (nullptr != mContext)
         {
             mContext->span(mPreviousId);
-            mContext->override_threshold(mPreviousThreshold);
-            (void)send_close_msg();
+            mContext->override_threshold(mPreviousThresholdOverride);
+            if (mDeferredStart.pending)
+            {
+                if (mContext->deferred_span() == this)
+                {
+                    mContext->deferred_span(nullptr);
+                }
+                (void)send_complete_msg();
+            }
+            else if (mSpanThreshold != detail::disable_threshold)
+            {
+                (void)send_close_msg();
+            }
         }
     }
     constexpr span_scope() noexcept
         : mSpanThreshold{}
-        , mPreviousThreshold{}
+        , mPreviousThresholdOverride{}
         , mContext{}
         , mId{}
         , mPreviousId{}
+        , mDeferredStart{}
     {
     }
 
@@ -80,6 +118,10 @@ public:
 
 private:
     span_scope(log_context *ctx, span_context id, severity threshold) noexcept;
+    span_scope(log_context *ctx,
+               span_context id,
+               severity threshold,
+               deferred_start const &start) noexcept;
 
 public:
 #if !DPLX_DLOG_DISABLE_IMPLICIT_CONTEXT
@@ -144,6 +186,41 @@ public:
                 make_attributes(attrs... DPLX_DLOG_DETAIL_ATTR_FUNCTION_USE));
     }
 
+    // Opens a span whose start message is held back until a record or a
+    // child span is written within it. A span which is closed before that
+    // happens is written as a single complete span message which halves the
+    // bus traffic of short leaf spans. The name must outlive the scope and
+    // only the code.function attribute is supported.
+#if !DPLX_DLOG_DISABLE_IMPLICIT_CONTEXT
+    static auto open_deferred(std::string_view name,
+                              span_kind kind = span_kind::internal
+                                      DPLX_DLOG_DETAIL_FUNCTION_NAME_DEF) noexcept
+            -> span_scope
+    {
+        return do_open_deferred(name,
+                                kind DPLX_DLOG_DETAIL_FUNCTION_NAME_USE);
+    }
+#endif
+    static auto open_deferred(log_context &ctx,
+                              std::string_view name,
+                              span_kind kind = span_kind::internal
+                                      DPLX_DLOG_DETAIL_FUNCTION_NAME_DEF) noexcept
+            -> span_scope
+    {
+        return do_open_deferred(ctx, name, ctx.span(),
+                                kind DPLX_DLOG_DETAIL_FUNCTION_NAME_USE);
+    }
+    static auto open_deferred(log_context &ctx,
+                              std::string_view name,
+                              span_context parent,
+                              span_kind kind = span_kind::internal
+                                      DPLX_DLOG_DETAIL_FUNCTION_NAME_DEF) noexcept
+            -> span_scope
+    {
+        return do_open_deferred(ctx, name, parent,
+                                kind DPLX_DLOG_DETAIL_FUNCTION_NAME_USE);
+    }
+
     [[nodiscard]] auto context() const noexcept -> span_context
     {
         return mId;
@@ -168,7 +245,32 @@ private:
                         detail::attribute_args const &attrs) noexcept
             -> span_scope;
 
+#if !DPLX_DLOG_DISABLE_IMPLICIT_CONTEXT
+    static auto do_open_deferred(std::string_view name,
+                                 span_kind kind,
+                                 std::string_view function) noexcept
+            -> span_scope;
+#endif
+    static auto do_open_deferred(log_context &ctx,
+                                 std::string_view name,
+                                 span_context parent,
+                                 span_kind kind,
+                                 std::string_view function) noexcept
+            -> span_scope;
+
+    // moves the scope to the given context which must hold the state of the
+    // context the scope has been opened on, see context_carrier
+    constexpr void rebind(log_context &ctx) noexcept
+    {
+        if (mContext != nullptr)
+        {
+            mContext = &ctx;
+        }
+    }
+
+    auto send_start_msg(log_record_port &port) noexcept -> result<void>;
     auto send_close_msg() noexcept -> result<void>;
+    auto send_complete_msg() noexcept -> result<void>;
 };
 
 #undef DPLX_DLOG_DETAIL_ATTR_FUNCTION
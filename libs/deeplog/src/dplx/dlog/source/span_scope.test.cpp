@@ -7,6 +7,10 @@
 
 #include "dplx/dlog/source/span_scope.hpp"
 
+#include <memory>
+#include <utility>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 #include <dplx/dlog/bus/buffer_bus.hpp>
@@ -15,6 +19,7 @@
 #include <dplx/dlog/macros.hpp>
 #include <dplx/dlog/source/log_record_port.hpp>
 
+#include "counting_sink.hpp"
 #include "test_dir.hpp"
 #include "test_utils.hpp"
 
@@ -127,4 +132,80 @@ TEST_CASE("the correct implicit span scope is attached to log records")
 }
 #endif
 
+TEST_CASE("deferred spans are coalesced if nothing is written within them")
+{
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "span_scope.dmsb", 4U, regionSize)
+                    .value(),
+            dlog::severity::trace};
+    auto sinkPtr = std::make_unique<message_counting_sink>();
+    auto *const sink = sinkPtr.get();
+    core.attach_sink(std::move(sinkPtr));
+    dlog::log_context ctx(core);
+
+    SECTION("an empty span is written as a single message")
+    {
+        {
+            auto span = dlog::span_scope::open_deferred(ctx, "empty");
+            CHECK(ctx.span() == span.context());
+        }
+        REQUIRE(core.retire_log_records());
+        CHECK(sink->numSpanCompletes == 1);
+        CHECK(sink->numSpanStarts == 0);
+        CHECK(sink->numSpanEnds == 0);
+    }
+    SECTION("a record flushes the start message")
+    {
+        {
+            auto span = dlog::span_scope::open_deferred(ctx, "non-empty");
+            DLOG_TO(ctx, dlog::severity::warn, "within a deferred span");
+        }
+        REQUIRE(core.retire_log_records());
+        CHECK(sink->numSpanCompletes == 0);
+        CHECK(sink->numSpanStarts == 1);
+        CHECK(sink->numSpanEnds == 1);
+        CHECK(sink->numRecords == 1);
+    }
+    SECTION("a child span flushes the start message of its parent")
+    {
+        {
+            auto parent = dlog::span_scope::open_deferred(ctx, "parent");
+            auto child = dlog::span_scope::open_deferred(ctx, "child");
+        }
+        REQUIRE(core.retire_log_records());
+        CHECK(sink->numSpanCompletes == 1);
+        CHECK(sink->numSpanStarts == 1);
+        CHECK(sink->numSpanEnds == 1);
+    }
+}
+
+TEST_CASE("span_scope open/close throughput", "[.][benchmark]")
+{
+    constexpr auto regionSize = 1 << 24;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "span_scope.bench.dmsb", 4U, regionSize)
+                    .value()};
+    dlog::log_context ctx(core);
+
+    BENCHMARK_ADVANCED("root span")(Catch::Benchmark::Chronometer meter)
+    {
+        REQUIRE(core.retire_log_records());
+        meter.measure([&ctx] {
+            auto span = dlog::span_scope::open(ctx, "root",
+                                               dlog::span_context{});
+            return span.context().spanId;
+        });
+    };
+    BENCHMARK_ADVANCED("child span")(Catch::Benchmark::Chronometer meter)
+    {
+        REQUIRE(core.retire_log_records());
+        auto root = dlog::span_scope::open(ctx, "root");
+        meter.measure([&ctx] {
+            auto span = dlog::span_scope::open(ctx, "child");
+            return span.context().spanId;
+        });
+    };
+}
+
 } // namespace dlog_tests
@@ -0,0 +1,62 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/source/trace_sampler.hpp"
+
+#include <array>
+#include <bit>
+#include <limits>
+#include <utility>
+
+namespace dplx::dlog
+{
+
+ratio_sampler::ratio_sampler(double const ratio) noexcept
+    : mBound(0U)
+    , mAll(ratio >= 1.0)
+{
+    if (ratio > 0.0 && !mAll)
+    {
+        // 2^64
+        constexpr double scale = 18'446'744'073'709'551'616.0;
+        mBound = static_cast<std::uint64_t>(ratio * scale);
+    }
+}
+
+auto ratio_sampler::should_sample(trace_id const id, std::string_view) noexcept
+        -> bool
+{
+    auto const rawTraceId = std::bit_cast<std::array<std::uint64_t, 2>>(id);
+    return mAll || rawTraceId[1] < mBound;
+}
+
+per_name_sampler::per_name_sampler(
+        std::unique_ptr<trace_sampler> fallback) noexcept
+    : mSamplers()
+    , mFallback(std::move(fallback))
+{
+}
+
+void per_name_sampler::add(std::string_view const rootSpanName,
+                           std::unique_ptr<trace_sampler> sampler)
+{
+    mSamplers.insert_or_assign(std::string(rootSpanName), std::move(sampler));
+}
+
+auto per_name_sampler::should_sample(
+        trace_id const id, std::string_view const rootSpanName) noexcept
+        -> bool
+{
+    if (auto const it = mSamplers.find(rootSpanName);
+        it != mSamplers.end() && it->second != nullptr)
+    {
+        return it->second->should_sample(id, rootSpanName);
+    }
+    return mFallback == nullptr || mFallback->should_sample(id, rootSpanName);
+}
+
+} // namespace dplx::dlog
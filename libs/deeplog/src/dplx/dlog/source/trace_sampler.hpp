@@ -0,0 +1,103 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <dplx/dlog/core/strong_types.hpp>
+#include <dplx/dlog/source/rate_limiter.hpp>
+
+namespace dplx::dlog
+{
+
+// decides whether a trace is recorded (head based sampling). The decision is
+// made once per trace when its root span is created; the spans and records of
+// unsampled traces are suppressed by the span threshold.
+class trace_sampler
+{
+public:
+    virtual ~trace_sampler() noexcept = default;
+
+protected:
+    trace_sampler() noexcept = default;
+
+    trace_sampler(trace_sampler const &) noexcept = default;
+    auto operator=(trace_sampler const &) noexcept -> trace_sampler & = default;
+
+    trace_sampler(trace_sampler &&) noexcept = default;
+    auto operator=(trace_sampler &&) noexcept -> trace_sampler & = default;
+
+public:
+    [[nodiscard]] virtual auto
+    should_sample(trace_id id, std::string_view rootSpanName) noexcept -> bool
+            = 0;
+};
+
+// samples the given ratio of traces. The decision is derived from the trace
+// id, i.e. it is consistent across processes participating in a trace.
+class ratio_sampler final : public trace_sampler
+{
+    std::uint64_t mBound;
+    bool mAll;
+
+public:
+    explicit ratio_sampler(double ratio) noexcept;
+
+    [[nodiscard]] auto should_sample(trace_id id, std::string_view) noexcept
+            -> bool override;
+};
+
+// samples up to `maxBurst` traces per `refillPeriod`
+class rate_limited_sampler final : public trace_sampler
+{
+    token_bucket_limiter mLimiter;
+
+public:
+    template <typename Rep, typename Period>
+    rate_limited_sampler(
+            std::uint32_t const maxBurst,
+            std::chrono::duration<Rep, Period> const refillPeriod) noexcept
+        : mLimiter(maxBurst, refillPeriod)
+    {
+    }
+
+    [[nodiscard]] auto should_sample(trace_id, std::string_view) noexcept
+            -> bool override
+    {
+        return mLimiter.try_acquire().allowed;
+    }
+};
+
+// delegates the decision to the sampler registered for the root span name
+class per_name_sampler final : public trace_sampler
+{
+    std::map<std::string, std::unique_ptr<trace_sampler>, std::less<>>
+            mSamplers;
+    std::unique_ptr<trace_sampler> mFallback;
+
+public:
+    // an empty fallback samples every trace without a dedicated sampler
+    explicit per_name_sampler(std::unique_ptr<trace_sampler> fallback
+                              = nullptr) noexcept;
+
+    // throws std::bad_alloc
+    void add(std::string_view rootSpanName,
+             std::unique_ptr<trace_sampler> sampler);
+
+    [[nodiscard]] auto should_sample(trace_id id,
+                                     std::string_view rootSpanName) noexcept
+            -> bool override;
+};
+
+} // namespace dplx::dlog
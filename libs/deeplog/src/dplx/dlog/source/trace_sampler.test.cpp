@@ -0,0 +1,99 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/source/trace_sampler.hpp"
+
+#include <chrono>
+#include <memory>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <dplx/dlog/bus/buffer_bus.hpp>
+#include <dplx/dlog/log_fabric.hpp>
+#include <dplx/dlog/source/span_scope.hpp>
+
+#include "test_dir.hpp"
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+TEST_CASE("ratio_sampler samples none or all traces at the extremes")
+{
+    dlog::ratio_sampler never(0.0);
+    dlog::ratio_sampler always(1.0);
+    for (int i = 0; i < 16; ++i) // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+    {
+        auto const id = dlog::trace_id::random();
+        CHECK(!never.should_sample(id, "span"));
+        CHECK(always.should_sample(id, "span"));
+    }
+}
+
+TEST_CASE("rate_limited_sampler samples a burst of traces")
+{
+    using namespace std::chrono_literals;
+    dlog::rate_limited_sampler sampler(2U, 1h);
+    CHECK(sampler.should_sample(dlog::trace_id::random(), "span"));
+    CHECK(sampler.should_sample(dlog::trace_id::random(), "span"));
+    CHECK(!sampler.should_sample(dlog::trace_id::random(), "span"));
+}
+
+TEST_CASE("per_name_sampler dispatches on the root span name")
+{
+    dlog::per_name_sampler sampler(std::make_unique<dlog::ratio_sampler>(1.0));
+    sampler.add("health-check", std::make_unique<dlog::ratio_sampler>(0.0));
+
+    auto const id = dlog::trace_id::random();
+    CHECK(!sampler.should_sample(id, "health-check"));
+    CHECK(sampler.should_sample(id, "request"));
+}
+
+TEST_CASE("spans of unsampled traces disable logging")
+{
+    dlog::log_fabric core{
+            dlog::bufferbus(test_dir, TEST_FILE_BB, small_buffer_bus_size)
+                    .value()};
+    core.attach_trace_sampler(std::make_unique<dlog::ratio_sampler>(0.0));
+    dlog::log_context ctx(core);
+    auto const threshold = ctx.threshold();
+
+    {
+        auto outer = dlog::span_scope::open(ctx, "outer");
+        CHECK(ctx.threshold() == dlog::detail::disable_threshold);
+        {
+            auto inner = dlog::span_scope::open(ctx, "inner");
+            CHECK(ctx.span() == outer.context());
+            CHECK(ctx.threshold() == dlog::detail::disable_threshold);
+        }
+    }
+    CHECK(ctx.threshold() == threshold);
+}
+
+TEST_CASE("unsampled traces stay suppressed across threshold reconfigurations")
+{
+    dlog::log_fabric core{
+            dlog::bufferbus(test_dir, TEST_FILE_BB, small_buffer_bus_size)
+                    .value()};
+    core.attach_trace_sampler(std::make_unique<dlog::ratio_sampler>(0.0));
+    dlog::log_context ctx(core);
+
+    auto outer = dlog::span_scope::open(ctx, "outer");
+    REQUIRE(ctx.threshold() == dlog::detail::disable_threshold);
+
+    REQUIRE(core.reconfigure_default_threshold(dlog::severity::trace));
+    CHECK(ctx.threshold() == dlog::detail::disable_threshold);
+    {
+        // the child joins the unsampled trace instead of becoming an orphan
+        auto inner = dlog::span_scope::open(ctx, "inner");
+        CHECK(ctx.span() == outer.context());
+        CHECK(ctx.threshold() == dlog::detail::disable_threshold);
+    }
+    CHECK(ctx.threshold() == dlog::detail::disable_threshold);
+}
+
+} // namespace dlog_tests
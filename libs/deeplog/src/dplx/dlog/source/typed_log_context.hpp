@@ -0,0 +1,172 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+
+#if __cpp_lib_source_location >= 201'907L
+#include <source_location>
+#endif
+
+#include <fmt/core.h>
+
+#include <dplx/dlog/attributes.hpp>
+#include <dplx/dlog/concepts.hpp>
+#include <dplx/dlog/config.hpp>
+#include <dplx/dlog/core/strong_types.hpp>
+#include <dplx/dlog/log_fabric.hpp>
+#include <dplx/dlog/loggable.hpp>
+#include <dplx/dlog/source/log.hpp>
+#include <dplx/dlog/source/log_context.hpp>
+#include <dplx/dlog/source/record_output_buffer.hpp>
+
+namespace dplx::dlog::detail
+{
+
+// the type of the output buffers handed out by a bus, buses which don't name
+// their (final) output buffer type are committed through the vtable.
+template <typename Bus>
+struct bus_output_buffer
+{
+    using type = record_output_buffer;
+};
+template <typename Bus>
+    requires std::derived_from<typename Bus::output_buffer,
+                               record_output_buffer>
+struct bus_output_buffer<Bus>
+{
+    using type = typename Bus::output_buffer;
+};
+template <typename Bus>
+using bus_output_buffer_t = typename bus_output_buffer<Bus>::type;
+
+} // namespace dplx::dlog::detail
+
+namespace dplx::dlog
+{
+
+// A log_context which knows the bus type of its log_fabric. Records logged
+// through it are allocated from and committed to the bus directly instead of
+// going through the log_record_port vtable, i.e. the whole DLOG_TO path can
+// be inlined. It is a log_context, so spans can be opened on it as usual.
+//
+// The log_fabric must outlive the context. Records are always encoded by the
+// statically typed encoder regardless of DPLX_DLOG_USE_TYPE_ERASED_LOG.
+template <bus Bus>
+class typed_log_context : public log_context
+{
+    Bus *mBus;
+
+public:
+    explicit typed_log_context(log_fabric<Bus> &fabric,
+                               span_context span = span_context{})
+        : log_context(fabric, span)
+        , mBus(&fabric.message_bus())
+    {
+    }
+    explicit typed_log_context(log_fabric<Bus> &fabric,
+                               scope_name name,
+                               span_context span = span_context{})
+        : log_context(fabric, name, span)
+        , mBus(&fabric.message_bus())
+    {
+    }
+
+    [[nodiscard]] DPLX_ATTR_FORCE_INLINE auto message_bus() const noexcept
+            -> Bus &
+    {
+        return *mBus;
+    }
+};
+
+} // namespace dplx::dlog
+
+namespace dplx::dlog::detail
+{
+
+template <bus Bus, attribute... Attrs, typename... Args>
+DPLX_ATTR_FORCE_INLINE auto
+dispatch_log(typed_log_context<Bus> const &ctx,
+             severity sev,
+             fmt::string_view message,
+#if DPLX_DLOG_USE_SOURCE_LOCATION
+             std::source_location const &location,
+#else
+             detail::log_location const &location,
+#endif
+             stack_attribute_args<Attrs...> const &attrs,
+             Args const &...args) noexcept -> result<void>
+{
+    return detail::tlog_to<bus_output_buffer_t<Bus>>(
+            ctx.message_bus(), ctx,
+            log_args{
+                    message,
+                    nullptr,
+                    nullptr,
+#if DPLX_DLOG_USE_SOURCE_LOCATION
+                    detail::from_source_location(location),
+#else
+                    location,
+#endif
+                    static_cast<std::uint_least16_t>(sizeof...(Args)),
+                    sev,
+            },
+            attrs, args...);
+}
+
+} // namespace dplx::dlog::detail
+
+namespace dplx::dlog
+{
+
+template <bus Bus, typename... Args>
+    requires(... && loggable<Args>)
+[[nodiscard]] inline auto
+log(typed_log_context<Bus> const &ctx,
+    severity sev,
+    fmt::format_string<reification_type_of_t<Args>...> message,
+#if DPLX_DLOG_USE_SOURCE_LOCATION
+    std::source_location const &location,
+#else
+    detail::log_location const &location,
+#endif
+    Args const &...args) noexcept -> result<void>
+{
+    if (sev < ctx.threshold()) [[unlikely]]
+    {
+        return outcome::success();
+    }
+
+    return detail::dispatch_log(ctx, sev, message, location,
+                                detail::stack_attribute_args<>{}, args...);
+}
+
+template <bus Bus, attribute... Attrs, typename... Args>
+    requires(... && loggable<Args>)
+[[nodiscard]] inline auto
+log(typed_log_context<Bus> const &ctx,
+    severity sev,
+    fmt::format_string<reification_type_of_t<Args>...> message,
+#if DPLX_DLOG_USE_SOURCE_LOCATION
+    std::source_location const &location,
+#else
+    detail::log_location const &location,
+#endif
+    detail::stack_attribute_args<Attrs...> const &attrs,
+    Args const &...args) noexcept -> result<void>
+{
+    if (sev < ctx.threshold()) [[unlikely]]
+    {
+        return outcome::success();
+    }
+
+    return detail::dispatch_log(ctx, sev, message, location, attrs, args...);
+}
+
+} // namespace dplx::dlog
@@ -0,0 +1,74 @@
+
+// Copyright Henrik Steffen Gaßmann 2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+//         (See accompanying file LICENSE or copy at
+//           https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dplx/dlog/source/typed_log_context.hpp"
+
+#include <memory>
+#include <type_traits>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <dplx/dlog/bus/buffer_bus.hpp>
+#include <dplx/dlog/bus/mpsc_bus.hpp>
+#include <dplx/dlog/macros.hpp>
+#include <dplx/dlog/source/span_scope.hpp>
+
+#include "counting_sink.hpp"
+#include "test_dir.hpp"
+#include "test_utils.hpp"
+
+namespace dlog_tests
+{
+
+using dlog::detail::bus_output_buffer_t;
+static_assert(std::is_same_v<bus_output_buffer_t<dlog::mpsc_bus_handle>,
+                             dlog::mpsc_bus_handle::output_buffer>);
+static_assert(std::is_same_v<bus_output_buffer_t<dlog::db_mpsc_bus_handle>,
+                             dlog::mpsc_bus_handle::output_buffer>);
+static_assert(std::is_same_v<bus_output_buffer_t<dlog::bufferbus_handle>,
+                             dlog::bufferbus_handle::output_buffer>);
+
+TEST_CASE("a typed_log_context writes records directly to the bus")
+{
+    constexpr auto regionSize = 1 << 14;
+    dlog::log_fabric core{
+            dlog::mpsc_bus(test_dir, "typed_log_context.dmsb", 4U, regionSize)
+                    .value(),
+            dlog::severity::trace};
+    auto sinkPtr = std::make_unique<message_counting_sink>();
+    auto *const sink = sinkPtr.get();
+    core.attach_sink(std::move(sinkPtr));
+    dlog::typed_log_context ctx(core);
+
+    DLOG_TO(ctx, dlog::severity::warn, "typed msg with arg {} and {}", 1,
+            "it's me Mario");
+    {
+        auto span = dlog::span_scope::open(ctx, "typed");
+        CHECK(ctx.span() == span.context());
+        DLOG_TO(ctx, dlog::severity::warn, "within a span");
+    }
+    CHECK(ctx.span() == dlog::span_context{});
+
+    REQUIRE(core.retire_log_records());
+    CHECK(sink->numRecords == 2);
+}
+
+TEST_CASE("a typed_log_context respects its threshold")
+{
+    dlog::log_fabric core{
+            dlog::bufferbus(test_dir, TEST_FILE_BB, small_buffer_bus_size)
+                    .value(),
+            dlog::severity::warn};
+    dlog::typed_log_context ctx(core);
+
+    CHECK(dlog::log(ctx, dlog::severity::debug, "filtered",
+                    DPLX_DLOG_LOCATION));
+    CHECK(dlog::log(ctx, dlog::severity::error, "written {}",
+                    DPLX_DLOG_LOCATION, 1));
+}
+
+} // namespace dlog_tests